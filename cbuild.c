@@ -13,50 +13,56 @@ static void _usage(FILE* stream, const char* const program)
 	ECHO(stream, "    --help / -h                Print usage to the terminal\n");
 	ECHO(stream, "    --compiler / -c            Path to C compiler executable\n");
 	ECHO(stream, "    --optimize / -o            Optimize value [0-3]\n");
+	ECHO(stream, "    --unity / -u               Unity build with provided batch size\n");
+	ECHO(stream, "    --test / -t                Run the built executable as a test\n");
+	ECHO(stream, "    --dry-run                  Print commands that would run, without running them\n");
+	ECHO(stream, "    --explain                  Print why each command runs\n");
+	ECHO(stream, "    --no-progress              Do not display progress of commands\n");
+	ECHO(stream, "    --jobs / -j                Number of commands to run at once\n");
+	ECHO(stream, "    --keep-going / -k          Stop after the provided number of failed commands, 0 for never\n");
+	ECHO(stream, "    --executor                 Unix socket of executor for hermetic commands\n");
+	ECHO(stream, "    --serve-executor           Run executor on the provided Unix socket\n");
+	ECHO(stream, "    --store                    Directory of artifact store shared between build trees\n");
+	ECHO(stream, "    --server                   Keep serving builds on the provided Unix socket\n");
+	ECHO(stream, "    --connect                  Forward the build to the server on the provided Unix socket\n");
+	ECHO(stream, "    --shard                    Run only the I-th of N shards of tests, as I/N\n");
+	ECHO(stream, "    --cgroup                   Delegated cgroup v2 directory to run commands in\n");
+	ECHO(stream, "    --cpus                     Processors all commands may use together, needs --cgroup\n");
+	ECHO(stream, "    --memory                   Memory all commands may use together, needs --cgroup\n");
+	ECHO(stream, "    --pin                      Pin every job to its own processor\n");
 	ECHO(stream, "\n");
 }
 
-int _main(const char* const program, int argc, char** argv)
+struct _Options
 {
-	const char* compiler = NULL;
-	const char* optimize = NULL;
-	const char* name = "capp";
+	const char* compiler;
+	const char* optimize;
+	const char* unity;
+	const char* name;
+};
 
-	FOREACH_ARG_IN_CMD_ARGS(flag, argc, argv,
-	{
-		if (STREQL(flag, "--help") OR STREQL(flag, "-h"))
-		{
-			_usage(stdout, program);
-			exit(0);
-		}
-		else if (STREQL(flag, "--compiler") OR STREQL(flag, "-c"))
-		{
-			compiler = _shift(&argc, &argv);
-		}
-		else if (STREQL(flag, "--optimize") OR STREQL(flag, "-o"))
-		{
-			optimize = _shift(&argc, &argv);
-		}
-		else
-		{
-			_usage(stderr, program);
-			exit(1);
-		}
-	});
+static void _build(void* context)
+{
+	const struct _Options* options = (const struct _Options*)context;
+	const char* compiler = options->compiler;
+	const char* optimize = options->optimize;
+	const char* unity = options->unity;
+	const char* name = options->name;
 
 	ECHO(stdout, "=============================================================\n");
 	ECHO(stdout, CBUILD_INFO_LABEL" Configuring build options...\n");
-	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Compiler is set to: %s\n", compiler);
+	struct _CBuild_Toolchain* toolchain = TOOLCHAIN(compiler);
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Compiler is set to: %s\n", toolchain->path);
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Compiler version is: %s\n", toolchain->version);
 	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Optimization flag is set to: %s\n", optimize);
 	ECHO(stdout, "=============================================================\n");
 
 	ECHO(stdout, CBUILD_INFO_LABEL" Building name hierarchy tree...\n", name);
-	if (NOT ISDIR(PATH("examples"))) MKDIR("examples");
-	if (NOT ISDIR(PATH("examples", name))) MKDIR("examples", name);
-	if (NOT ISDIR(PATH("examples", name, "include"))) MKDIR("examples", name, "include");
-	if (NOT ISDIR(PATH("examples", name, "source"))) MKDIR("examples", name, "source");
-	if (NOT ISDIR(PATH("examples", name, "build"))) MKDIR("examples", name, "build");
-	if (NOT ISDIR(PATH("examples", name, "tests"))) MKDIR("examples", name, "tests");
+	ENSURE_DIRS(
+		PATH("examples", name, "include"),
+		PATH("examples", name, "source"),
+		PATH("examples", name, "build"),
+		PATH("examples", name, "tests"));
 	ECHO(stdout, "=============================================================\n");
 
 
@@ -68,27 +74,103 @@ int _main(const char* const program, int argc, char** argv)
 	ECHO(stdout, "=============================================================\n");
 
 	ECHO(stdout, CBUILD_INFO_LABEL" Setting up source files...\n");
-	const char* sources = NULL;
+	struct _CBuild_Strings sources = { 0 };
 	FOREACH_FILE_IN_DIRECTORY(file, PATH("examples", name, "source"),
 	{
 		IGNORE_DIRECTORY_IF_DOTS(file);
 		if (ISFILE(PATH("examples", name, "source", file)))
 		{
 			ECHO(stdout, " -- "CBUILD_INFO_LABEL" Adding `%s` to sources.\n", PATH("examples", name, "source", file));
-			sources = JOIN(" ", PATH("examples", name, "source", file));
+			_stringsAppend(&sources, PATH("examples", name, "source", file));
 		}
 	});
+
+	if (unity != NULL)
+	{
+		const char** units = UNITY(PATH("examples", name, "build", "unity"), strtoull(unity, NULL, 10), sources.items, sources.count);
+		_stringsClear(&sources);
+		for (; *units != NULL; ++units) _stringsAppend(&sources, *units);
+	}
 	ECHO(stdout, "=============================================================\n");
 
 #ifdef _WIN32
 #	error "Windows are not supported yet!"
 #else
-	const char* const OUTPUT_FLAG = "-o";
+	ECHO(stdout, CBUILD_INFO_LABEL" Compiling source files...\n");
+	const char* const OPTIMIZE_FLAG = CONCAT("-O", optimize);
 	const char* const OUTPUT_PATH = PATH("examples", name, "build", "capp.out");
-	CMD(compiler, OUTPUT_FLAG, OUTPUT_PATH, sources);
-	ECHO(stdout, CBUILD_INFO_LABEL" "CBUILD_BOLD("Running the built executable:")"\n");
-	CMD(OUTPUT_PATH);
+	struct _CBuild_Strings objects = { 0 };
+	for (unsigned long long index = 0; index < sources.count; ++index)
+	{
+		const char* object = PATH("examples", name, "build", CONCAT(strrchr(sources.items[index], PATH_SEPARATOR[0]) + 1, ".o"));
+		_stringsAppend(&objects, COMPILE(compiler, sources.items[index], object, OPTIMIZE_FLAG, "-I", PATH("examples", name, "include")));
+	}
+	WRITE_COMPILE_COMMANDS(PATH("examples", name, "build", "compile_commands.json"));
+
+	LINK(compiler, OUTPUT_PATH, objects.items);
 #endif
+}
+
+int _main(const char* const program, int argc, char** argv)
+{
+	const char* compiler = "cc";
+	const char* optimize = "0";
+	const char* unity = NULL;
+	const char* name = "capp";
+	int test = 0;
+
+	FOREACH_ARG_IN_CMD_ARGS(flag, argc, argv,
+	{
+		if (STREQL(flag, "--help") OR STREQL(flag, "-h"))
+		{
+			_usage(stdout, program);
+			exit(0);
+		}
+		else if (STREQL(flag, "--compiler") OR STREQL(flag, "-c"))
+		{
+			compiler = _shift(&argc, &argv);
+		}
+		else if (STREQL(flag, "--optimize") OR STREQL(flag, "-o"))
+		{
+			optimize = _shift(&argc, &argv);
+		}
+		else if (STREQL(flag, "--unity") OR STREQL(flag, "-u"))
+		{
+			unity = _shift(&argc, &argv);
+		}
+		else if (STREQL(flag, "--test") OR STREQL(flag, "-t"))
+		{
+			test = 1;
+		}
+		else if (STREQL(flag, "--serve-executor"))
+		{
+			SERVE_EXECUTOR(_shift(&argc, &argv));
+		}
+		else
+		{
+			_usage(stderr, program);
+			exit(1);
+		}
+	});
+
+	const char* const OUTPUT_PATH = PATH("examples", name, "build", "capp.out");
+	struct _Options options = { compiler, optimize, unity, name };
+	CONFIGURE(program, _build, &options);
+
+	if (test)
+	{
+		ADD_TEST(name, OUTPUT_PATH);
+
+		if (RUN_TESTS() > 0)
+		{
+			exit(1);
+		}
+	}
+	else if (NOT _cbuildDryRun)
+	{
+		ECHO(stdout, CBUILD_INFO_LABEL" "CBUILD_BOLD("Running the built executable:")"\n");
+		CMD(OUTPUT_PATH);
+	}
 
 	ECHO(stdout, "=============================================================\n");
 	return 0;
@@ -97,7 +179,9 @@ int _main(const char* const program, int argc, char** argv)
 int main(int argc, char** argv)
 {
 	const char* program = _shift(&argc, &argv);
+	OPTIONS(argc, argv);
 	REBUILD_MYSELF(program);
+	SERVER(program, _main);
 	int result = _main(program, argc, argv);
 	return result;
 }
@@ -1,12 +1,17 @@
 #ifndef BUILD_H
 #define BUILD_H
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#	define _GNU_SOURCE
+#endif
+
 #include <stdlib.h>
 #include <stdarg.h>
 #include <assert.h>
 #include <string.h>
 #include <errno.h>
 #include <stdio.h>
+#include <stdint.h>
 
 #ifdef _WIN32
 #	define WIN32_MEAN_AND_LEAN
@@ -22,6 +27,32 @@
 #	include <unistd.h>
 #	include <dirent.h>
 #	include <fcntl.h>
+#	include <sys/ioctl.h>
+#	include <sys/uio.h>
+#	include <limits.h>
+#	include <signal.h>
+#	include <sys/socket.h>
+#	include <sys/un.h>
+#	include <sys/file.h>
+#	include <time.h>
+#	include <poll.h>
+#	include <pthread.h>
+
+#	ifdef __linux__
+#		include <sys/sendfile.h>
+#		include <sys/inotify.h>
+#		include <sched.h>
+#		include <sys/syscall.h>
+#		include <sys/mman.h>
+
+#		if (!defined(CBUILD_IO_URING) || CBUILD_IO_URING) && __has_include(<linux/io_uring.h>)
+#			include <linux/io_uring.h>
+#		endif
+#	endif
+
+#	ifndef FICLONE
+#		define FICLONE _IOW(0x94, 9, int)
+#	endif
 
 #endif
 
@@ -67,8 +98,14 @@
 #	define CBUILD_ECHO_LEVEL 1
 #endif
 
+/**
+ * Whether the progress status line is displayed at the bottom of the
+ * terminal, so @ref ECHO erases it before printing.
+ */
+int _cbuildProgressShown = 0;
+
 #ifndef ECHO
-#	define ECHO(...) fprintf(__VA_ARGS__);
+#	define ECHO(...) { if (_cbuildProgressShown) { fputs("\r\033[K", stdout); fflush(stdout); _cbuildProgressShown = 0; } fprintf(__VA_ARGS__); }
 #endif
 
 #ifndef AND
@@ -163,11 +200,18 @@ const char* _shift(int* argc, char*** argv)
 		struct dirent* dp = NULL; \
 		DIR* dir = opendir(directory); \
 		 \
-		while ((dp = readdir(dir))) \
+		while (dir != NULL AND (dp = readdir(dir))) \
 		{ \
 			const char* file = dp->d_name; \
 			body; \
 		} \
+		 \
+		_probe(CBUILD_PROBE_TIME, directory); \
+		 \
+		if (dir != NULL) \
+		{ \
+			closedir(dir); \
+		} \
 	}
 #endif
 
@@ -221,6 +265,14 @@ const char* _join(const char* const separator, ...)
 	return buffer;
 }
 
+/**
+ * Compares two strings through pointers to them, for use with `qsort`.
+ */
+int _compareStrings(const void* a, const void* b)
+{
+	return strcmp(*(const char* const*)a, *(const char* const*)b);
+}
+
 /**
  * Wraps @ref _join function.
  * 
@@ -261,135 +313,269 @@ const char* _join(const char* const separator, ...)
 
 
 /**
- * @addtogroup ISFILE
+ * @addtogroup HASH
  * 
  * @{
  */
 
+#ifndef CBUILD_HASH_SEED
+#	define CBUILD_HASH_SEED 14695981039346656037ULL
+#endif
+
 /**
- * Checks if path is a file or not. Path must be correctly formatted,
- * and can be provided with @ref PATH macro.
+ * Hashes provided bytes with 64-bit FNV-1a algorithm. The seed can be
+ * a result of previous call to chain multiple buffers into one hash.
  * 
  * @code{.c}
- * 		bool is = _isfile(PATH("folder1", "folder2"));
+ * 		unsigned long long hash = _hash("abc", 3, CBUILD_HASH_SEED);
  * @endcode
  */
-int _isfile(const char* const path)
+unsigned long long _hash(const void* const data, const unsigned long long length, const unsigned long long seed)
 {
-#if CBUILD_ECHO_LEVEL >= 2
-	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _isfile()\n");
-#endif
+	const unsigned char* bytes = (const unsigned char*)data;
+	unsigned long long hash = seed;
 
-#ifdef _WIN32
-	assert(!"TODO: implement _isfile with Windows WIN32 API!");
-#else
-	struct stat info;
-	const int result = (stat(path, &info) == 0) && (info.st_mode & S_IFREG);
-	return result;
-#endif
+	for (unsigned long long index = 0; index < length; ++index)
+	{
+		hash ^= bytes[index];
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
 }
 
 /**
- * Wraps @ref _isfile function.
+ * Wraps @ref _hash function for NULL terminated strings.
  * 
  * @code{.c}
- * 		bool is = ISFILE(PATH("folder1", "folder2"));
+ * 		unsigned long long hash = HASH("some string");
  * @endcode
  */
-#ifndef ISFILE
-#	define ISFILE(path) _isfile(path)
+#ifndef HASH
+#	define HASH(string) _hash(string, strlen(string), CBUILD_HASH_SEED)
 #endif
 
 /**
- * @}
- */
-
-
-
-/**
- * @addtogroup ISDIR
- * 
- * @{
+ * Running SHA-256 digest, for content shared beyond a single build tree
+ * (see @ref _storeFetch), where 64-bit @ref _hash is too weak against
+ * collisions. Started with @ref _sha256Init, fed with
+ * @ref _sha256Update, and read with @ref _sha256Hex.
  */
+struct _CBuild_Sha256
+{
+	uint32_t state[8];
+	uint64_t length;
+	unsigned char block[64];
+};
 
 /**
- * Checks if path is a directory or not. Path must be correctly formatted,
- * and can be provided with @ref PATH macro.
- * 
- * @code{.c}
- * 		bool is = _isdir(PATH("folder1", "folder2"));
- * @endcode
+ * Starts a digest.
  */
-int _isdir(const char* const path)
+void _sha256Init(struct _CBuild_Sha256* const digest)
 {
-#if CBUILD_ECHO_LEVEL >= 2
-	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _isdir()\n");
-#endif
+	static const uint32_t initial[8] =
+	{
+		0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+	};
 
-#ifdef _WIN32
-	assert(!"TODO: implement _isdir with Windows WIN32 API!");
-#else
-	struct stat info;
-	const int result = (stat(path, &info) == 0) && (info.st_mode & S_IFDIR);
-	return result;
-#endif
+	memcpy(digest->state, initial, sizeof(initial));
+	digest->length = 0;
 }
 
 /**
- * Wraps @ref _isdir function.
- * 
- * @code{.c}
- * 		bool is = ISDIR(PATH("folder1", "folder2"));
- * @endcode
+ * Rotates 32-bit value right by bits.
  */
-#ifndef ISDIR
-#	define ISDIR(path) _isdir(path)
-#endif
+uint32_t _sha256Rotate(const uint32_t value, const unsigned int bits)
+{
+	return (value >> bits) | (value << (32 - bits));
+}
 
 /**
- * @}
+ * Processes one full block of the digest.
  */
+void _sha256Block(struct _CBuild_Sha256* const digest, const unsigned char* const block)
+{
+	static const uint32_t rounds[64] =
+	{
+		0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+		0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+		0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+		0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+		0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+		0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+		0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+		0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+	};
+
+	uint32_t words[64];
+	uint32_t state[8];
+
+	for (unsigned int index = 0; index < 16; ++index)
+	{
+		words[index] = (uint32_t)block[4 * index] << 24 | (uint32_t)block[4 * index + 1] << 16 | (uint32_t)block[4 * index + 2] << 8 | (uint32_t)block[4 * index + 3];
+	}
+
+	for (unsigned int index = 16; index < 64; ++index)
+	{
+		const uint32_t first = _sha256Rotate(words[index - 15], 7) ^ _sha256Rotate(words[index - 15], 18) ^ (words[index - 15] >> 3);
+		const uint32_t second = _sha256Rotate(words[index - 2], 17) ^ _sha256Rotate(words[index - 2], 19) ^ (words[index - 2] >> 10);
+		words[index] = words[index - 16] + first + words[index - 7] + second;
+	}
 
+	memcpy(state, digest->state, sizeof(state));
 
+	for (unsigned int index = 0; index < 64; ++index)
+	{
+		const uint32_t sum1 = _sha256Rotate(state[4], 6) ^ _sha256Rotate(state[4], 11) ^ _sha256Rotate(state[4], 25);
+		const uint32_t choice = (state[4] & state[5]) ^ (~state[4] & state[6]);
+		const uint32_t first = state[7] + sum1 + choice + rounds[index] + words[index];
+		const uint32_t sum0 = _sha256Rotate(state[0], 2) ^ _sha256Rotate(state[0], 13) ^ _sha256Rotate(state[0], 22);
+		const uint32_t majority = (state[0] & state[1]) ^ (state[0] & state[2]) ^ (state[1] & state[2]);
+		memmove(state + 1, state, 7 * sizeof(uint32_t));
+		state[4] += first;
+		state[0] = first + sum0 + majority;
+	}
+
+	for (unsigned int index = 0; index < 8; ++index)
+	{
+		digest->state[index] += state[index];
+	}
+}
 
 /**
- * @addtogroup EXISTS
- * 
- * @{
+ * Feeds bytes into the digest.
  */
+void _sha256Update(struct _CBuild_Sha256* const digest, const void* const data, const unsigned long long length)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	unsigned long long used = digest->length % 64;
+	digest->length += length;
+
+	for (unsigned long long index = 0; index < length;)
+	{
+		if (used == 0 AND length - index >= 64)
+		{
+			_sha256Block(digest, bytes + index);
+			index += 64;
+			continue;
+		}
+
+		const unsigned long long chunk = length - index < 64 - used ? length - index : 64 - used;
+		memcpy(digest->block + used, bytes + index, chunk);
+		used += chunk;
+		index += chunk;
+
+		if (used == 64)
+		{
+			_sha256Block(digest, digest->block);
+			used = 0;
+		}
+	}
+}
 
 /**
- * Chesks if provided path exists ir not. Path must be correctly
- * formatted, and can be provided using @ref PATH macro.
+ * Writes the digest of everything fed so far as 64 lowercase hex digits
+ * and a NUL into hex. The digest itself is left as it is, so it can be
+ * fed further.
  * 
  * @code{.c}
- * 		int result = _exists(PATH("folder1", "file.txt"));
+ * 		struct _CBuild_Sha256 digest;
+ * 		char hex[65];
+ * 		_sha256Init(&digest);
+ * 		_sha256Update(&digest, "abc", 3);
+ * 		_sha256Hex(&digest, hex);
  * @endcode
  */
-int _exists(const char* const path)
+void _sha256Hex(const struct _CBuild_Sha256* const digest, char* const hex)
 {
-#if CBUILD_ECHO_LEVEL >= 2
-	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _exists()\n");
-#endif
+	struct _CBuild_Sha256 final = *digest;
+	const uint64_t bits = digest->length * 8;
+	unsigned char padding[72] = { 0x80 };
+	const unsigned long long used = digest->length % 64;
+	const unsigned long long count = (used < 56 ? 56 : 120) - used;
+
+	for (unsigned int index = 0; index < 8; ++index)
+	{
+		padding[count + index] = (unsigned char)(bits >> (56 - 8 * index));
+	}
+
+	_sha256Update(&final, padding, count + 8);
+
+	for (unsigned int index = 0; index < 8; ++index)
+	{
+		sprintf(hex + 8 * index, "%08x", (unsigned int)final.state[index]);
+	}
+}
 
+/**
+ * Feeds content of the file into the digest. Returns 0 on success, and
+ * -1 with errno set otherwise.
+ */
+int _sha256File(struct _CBuild_Sha256* const digest, const char* const path)
+{
 #ifdef _WIN32
-	assert(!"TODO: implement _exists with Windows WIN32 API!");
+	assert(!"TODO: implement _sha256File with Windows WIN32 API!");
 #else
-	const int result = _isfile(path) || _isdir(path);
-	return result;
+	const int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+	if (fd < 0)
+	{
+		return -1;
+	}
+
+	char buffer[64 * 1024];
+	ssize_t count = 0;
+
+	while ((count = read(fd, buffer, sizeof(buffer))) != 0)
+	{
+		if (count < 0 AND errno == EINTR)
+		{
+			continue;
+		}
+
+		if (count < 0)
+		{
+			const int error = errno;
+			close(fd);
+			errno = error;
+			return -1;
+		}
+
+		_sha256Update(digest, buffer, (unsigned long long)count);
+	}
+
+	close(fd);
+	return 0;
 #endif
 }
 
 /**
- * Wraps @ref _exists function.
- * 
- * @code{.c}
- * 		int result = EXISTS(PATH("folder1", "file.txt"));
- * @endcode
+ * Writes the digest of the data as 64 lowercase hex digits and a NUL
+ * into hex.
  */
-#ifndef EXISTS
-#	define EXISTS(path) _exists(path)
-#endif
+void _sha256Data(const void* const data, const unsigned long long length, char* const hex)
+{
+	struct _CBuild_Sha256 digest;
+	_sha256Init(&digest);
+	_sha256Update(&digest, data, length);
+	_sha256Hex(&digest, hex);
+}
+
+/**
+ * Checks whether a string is a digest written by @ref _sha256Hex, so
+ * it can be used as a file name.
+ */
+int _sha256Valid(const char* const hex)
+{
+	unsigned long long length = 0;
+
+	while (length < 64 AND ((hex[length] >= '0' AND hex[length] <= '9') OR (hex[length] >= 'a' AND hex[length] <= 'f')))
+	{
+		++length;
+	}
+
+	return length == 64 AND hex[64] == '\0';
+}
 
 /**
  * @}
@@ -398,93 +584,104 @@ int _exists(const char* const path)
 
 
 /**
- * @addtogroup MKDIR
+ * @addtogroup BUFFER
  * 
  * @{
  */
 
 /**
- * Creates a directory and all subdirectories in the provided path.
- * The path must be a NULL terminated variadic list of strings, not
- * a regular path format!
- * 
- * @code{.c}
- * 		_mkdir(0, "first", "second", "third", NULL);
- * 		// Creates directories: 'first/', 'first/second/', and 'first/second/third/'
- * @endcode
+ * Growable byte buffer. It keeps its capacity when cleared, so it can be
+ * reused for building many outputs without reallocation.
  */
-void _mkdir(int ignore, ...)
+struct _CBuild_Buffer
 {
-#if CBUILD_ECHO_LEVEL >= 2
-	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _mkdir()\n");
-#endif
+	char* data;
+	unsigned long long length;
+	unsigned long long capacity;
+};
 
-#ifdef _WIN32
-	assert(!"TODO: implement _mkdir with Windows WIN32 API!");
-#else
-	signed long long separatorsCount = -1;
-	unsigned long long length = 0;
-	va_list args;
-
-	FOREACH_ARG_IN_VA_ARGS(ignore, const char*, arg, args,
+/**
+ * Makes sure the buffer can hold additional amount of bytes.
+ */
+void _bufferReserve(struct _CBuild_Buffer* const buffer, const unsigned long long additional)
+{
+	if (buffer->length + additional + 1 <= buffer->capacity)
 	{
-		length += strlen(arg);
-		++separatorsCount;
-	});
+		return;
+	}
 
-	char* buffer = (char*)malloc((length + separatorsCount * PATH_SEPARATOR_LENGTH + 1) * sizeof(char));
-	length = 0;
+	unsigned long long capacity = buffer->capacity > 0 ? buffer->capacity : 256;
 
-	FOREACH_ARG_IN_VA_ARGS(ignore, const char*, arg, args,
+	while (buffer->length + additional + 1 > capacity)
 	{
-		const unsigned long long argLength = strlen(arg);
-		memcpy(buffer + length, arg, argLength);
-		length += argLength;
-		buffer[length] = '\0';
-
-		if (mkdir(buffer, 0777) < 0)
-		{
-			if (errno == EEXIST)
-			{
-#if CBUILD_ECHO_LEVEL >= 1
-				ECHO(stderr, " -- "CBUILD_WARNING_LABEL" Directory `%s` already exists: "CBUILD_WARNING("%s")"\n", buffer, strerror(errno));
-#endif
-			}
-			else
-			{
-#if CBUILD_ECHO_LEVEL >= 1
-				ECHO(stderr, " -- "CBUILD_ERROR_LABEL" Failed to create directory at path `%s`: "CBUILD_ERROR("%s")"\n", buffer, strerror(errno));
-#endif
-
-				free(buffer);
-				exit(1);
-			}
-		}
+		capacity *= 2;
+	}
 
-		if (separatorsCount > 0)
-		{
-			memcpy(buffer + length, PATH_SEPARATOR, PATH_SEPARATOR_LENGTH);
-			length += PATH_SEPARATOR_LENGTH;
-			--separatorsCount;
-		}
+	buffer->data = (char*)realloc(buffer->data, capacity * sizeof(char));
+	buffer->capacity = capacity;
+}
 
-		buffer[length] = '\0';
-	});
+/**
+ * Appends bytes to the buffer. The buffer content is always kept NULL
+ * terminated.
+ * 
+ * @code{.c}
+ * 		struct _CBuild_Buffer buffer = { 0 };
+ * 		_bufferAppend(&buffer, "abc", 3);
+ * @endcode
+ */
+void _bufferAppend(struct _CBuild_Buffer* const buffer, const void* const data, const unsigned long long length)
+{
+	_bufferReserve(buffer, length);
+	memcpy(buffer->data + buffer->length, data, length);
+	buffer->length += length;
+	buffer->data[buffer->length] = '\0';
+}
 
-	free(buffer);
-#endif
+/**
+ * Appends formatted string to the buffer.
+ * 
+ * @code{.c}
+ * 		_bufferAppendf(&buffer, "%s: %d\n", "value", 10);
+ * @endcode
+ */
+void _bufferAppendf(struct _CBuild_Buffer* const buffer, const char* const format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	const int length = vsnprintf(NULL, 0, format, args);
+	va_end(args);
+
+	_bufferReserve(buffer, length);
+	va_start(args, format);
+	vsnprintf(buffer->data + buffer->length, length + 1, format, args);
+	va_end(args);
+	buffer->length += length;
 }
 
 /**
- * Wraps @ref _mkdir function and handles first and last arguments.
+ * Wraps @ref _bufferAppend function for NULL terminated strings.
  * 
  * @code{.c}
- * 		MKDIR("first", "second", "third");
- * 		// Creates directories: 'first/', 'first/second/', and 'first/second/third/'
+ * 		BUFFER_APPEND(&buffer, "some string");
  * @endcode
  */
-#ifndef MKDIR
-#	define MKDIR(...) _mkdir(0, __VA_ARGS__, NULL)
+#ifndef BUFFER_APPEND
+#	define BUFFER_APPEND(buffer, string) _bufferAppend(buffer, string, strlen(string))
+#endif
+
+/**
+ * Empties the buffer, keeping its memory for reuse.
+ */
+#ifndef BUFFER_CLEAR
+#	define BUFFER_CLEAR(buffer) { (buffer)->length = 0; }
+#endif
+
+/**
+ * Releases memory of the buffer.
+ */
+#ifndef BUFFER_FREE
+#	define BUFFER_FREE(buffer) { free((buffer)->data); (buffer)->data = NULL; (buffer)->length = 0; (buffer)->capacity = 0; }
 #endif
 
 /**
@@ -494,251 +691,10335 @@ void _mkdir(int ignore, ...)
 
 
 /**
- * @addtogroup MKFILE
+ * @addtogroup ARENA
  * 
  * @{
  */
 
+#ifndef CBUILD_ARENA_BLOCK_SIZE
+#	define CBUILD_ARENA_BLOCK_SIZE (64 * 1024)
+#endif
+
+struct _CBuild_ArenaBlock
+{
+	struct _CBuild_ArenaBlock* next;
+	unsigned long long used;
+	unsigned long long capacity;
+	char data[];
+};
+
 /**
- * Creates a file and all subdirectories in the provided path.
- * The path must be a NULL terminated variadic list of strings, not
- * a regular path format!
- * 
- * @code{.c}
- * 		_mkfile(0, "first", "second", "third.txt", NULL);
+ * Pool allocator handing out memory from large blocks. Allocations are
+ * never freed one by one, the whole arena is reset or freed at once.
+ */
+struct _CBuild_Arena
+{
+	struct _CBuild_ArenaBlock* head;
+};
+
+/**
+ * Allocates memory from the arena, aligned to 16 bytes.
+ * 
+ * @code{.c}
+ * 		struct _CBuild_Arena arena = { 0 };
+ * 		char* memory = (char*)_arenaAlloc(&arena, 128);
+ * @endcode
+ */
+void* _arenaAlloc(struct _CBuild_Arena* const arena, const unsigned long long size)
+{
+	const unsigned long long aligned = (size + 15) & ~15ULL;
+	struct _CBuild_ArenaBlock* block = arena->head;
+
+	if (block == NULL OR block->used + aligned > block->capacity)
+	{
+		const unsigned long long capacity = aligned > CBUILD_ARENA_BLOCK_SIZE ? aligned : CBUILD_ARENA_BLOCK_SIZE;
+		block = (struct _CBuild_ArenaBlock*)malloc(sizeof(struct _CBuild_ArenaBlock) + capacity);
+		block->next = arena->head;
+		block->used = 0;
+		block->capacity = capacity;
+		arena->head = block;
+	}
+
+	void* memory = block->data + block->used;
+	block->used += aligned;
+	return memory;
+}
+
+/**
+ * Copies NULL terminated string into the arena.
+ */
+char* _arenaStrdup(struct _CBuild_Arena* const arena, const char* const string)
+{
+	const unsigned long long length = strlen(string);
+	char* copy = (char*)_arenaAlloc(arena, length + 1);
+	memcpy(copy, string, length + 1);
+	return copy;
+}
+
+/**
+ * Releases all blocks of the arena.
+ */
+void _arenaFree(struct _CBuild_Arena* const arena)
+{
+	while (arena->head != NULL)
+	{
+		struct _CBuild_ArenaBlock* next = arena->head->next;
+		free(arena->head);
+		arena->head = next;
+	}
+}
+
+/**
+ * Makes all memory of the arena available again. If the arena grew to
+ * several blocks, they are merged into one, so the next round of the
+ * same allocations does not touch the system allocator at all.
+ */
+void _arenaReset(struct _CBuild_Arena* const arena)
+{
+	if (arena->head == NULL)
+	{
+		return;
+	}
+
+	if (arena->head->next == NULL)
+	{
+		arena->head->used = 0;
+		return;
+	}
+
+	unsigned long long capacity = 0;
+
+	for (struct _CBuild_ArenaBlock* block = arena->head; block != NULL; block = block->next)
+	{
+		capacity += block->capacity;
+	}
+
+	_arenaFree(arena);
+	arena->head = (struct _CBuild_ArenaBlock*)malloc(sizeof(struct _CBuild_ArenaBlock) + capacity);
+	arena->head->next = NULL;
+	arena->head->used = 0;
+	arena->head->capacity = capacity;
+}
+
+/**
+ * @}
+ */
+
+
+
+/**
+ * @addtogroup STRINGS
+ * 
+ * @{
+ */
+
+/**
+ * Growable vector of strings. Items are always NULL terminated, so they
+ * can be passed directly as an argument vector (see @ref _exec). Copies
+ * of appended strings, if requested, live in the vector's arena. When
+ * cleared, the vector keeps its memory, so it can be reused for building
+ * many commands without allocations.
+ */
+struct _CBuild_Strings
+{
+	const char** items;
+	unsigned long long count;
+	unsigned long long capacity;
+	struct _CBuild_Arena arena;
+};
+
+/**
+ * Makes sure the vector can hold additional amount of items.
+ */
+void _stringsReserve(struct _CBuild_Strings* const strings, const unsigned long long additional)
+{
+	if (strings->count + additional + 1 <= strings->capacity)
+	{
+		return;
+	}
+
+	unsigned long long capacity = strings->capacity > 0 ? strings->capacity : 16;
+
+	while (strings->count + additional + 1 > capacity)
+	{
+		capacity *= 2;
+	}
+
+	strings->items = (const char**)realloc(strings->items, capacity * sizeof(const char*));
+	strings->items[strings->count] = NULL;
+	strings->capacity = capacity;
+}
+
+/**
+ * Appends a string to the vector. The string is not copied.
+ * 
+ * @code{.c}
+ * 		struct _CBuild_Strings strings = { 0 };
+ * 		_stringsAppend(&strings, "cc");
+ * @endcode
+ */
+void _stringsAppend(struct _CBuild_Strings* const strings, const char* const item)
+{
+	_stringsReserve(strings, 1);
+	strings->items[strings->count++] = item;
+	strings->items[strings->count] = NULL;
+}
+
+/**
+ * Appends a copy of the string, allocated in the vector's arena.
+ */
+void _stringsAppendCopy(struct _CBuild_Strings* const strings, const char* const item)
+{
+	_stringsAppend(strings, _arenaStrdup(&strings->arena, item));
+}
+
+/**
+ * Appends NULL terminated variadic list of strings to the vector.
+ * 
+ * @code{.c}
+ * 		_stringsAppendMany(&strings, "-o", "main", NULL);
+ * @endcode
+ */
+void _stringsAppendMany(struct _CBuild_Strings* const strings, ...)
+{
+	va_list args;
+
+	FOREACH_ARG_IN_VA_ARGS(strings, const char*, arg, args,
+	{
+		_stringsAppend(strings, arg);
+	});
+}
+
+/**
+ * Wraps @ref _stringsAppendMany function.
+ * 
+ * @code{.c}
+ * 		STRINGS_APPEND(&strings, "cc", "-o", "main", "main.c");
+ * @endcode
+ */
+#ifndef STRINGS_APPEND
+#	define STRINGS_APPEND(strings, ...) _stringsAppendMany(strings, __VA_ARGS__, NULL)
+#endif
+
+/**
+ * Replaces removed amount of items starting at index with provided
+ * items. Either of amounts can be zero, so it can insert, remove, or
+ * replace items in the middle of the vector. Items may point into the
+ * vector itself, as in `STRINGS_EXTEND(&strings, &strings)`.
+ * 
+ * @code{.c}
+ * 		const char* flags[] = { "-O2", "-g" };
+ * 		_stringsSplice(&strings, 1, 0, flags, 2);
+ * @endcode
+ */
+void _stringsSplice(struct _CBuild_Strings* const strings, const unsigned long long index, const unsigned long long removed, const char* const* items, const unsigned long long count)
+{
+	assert(index + removed <= strings->count);
+	const char** copy = (const char**)malloc((count + 1) * sizeof(const char*));
+
+	if (count > 0)
+	{
+		memcpy(copy, items, count * sizeof(const char*));
+	}
+
+	if (count > removed)
+	{
+		_stringsReserve(strings, count - removed);
+	}
+
+	memmove(strings->items + index + count, strings->items + index + removed, (strings->count - index - removed) * sizeof(const char*));
+
+	if (count > 0)
+	{
+		memcpy(strings->items + index, copy, count * sizeof(const char*));
+	}
+
+	strings->count = strings->count + count - removed;
+	strings->items[strings->count] = NULL;
+	free(copy);
+}
+
+/**
+ * Appends all items of other vector.
+ */
+#ifndef STRINGS_EXTEND
+#	define STRINGS_EXTEND(strings, other) _stringsSplice(strings, (strings)->count, 0, (other)->items, (other)->count)
+#endif
+
+/**
+ * Empties the vector and its arena, keeping memory for reuse.
+ */
+void _stringsClear(struct _CBuild_Strings* const strings)
+{
+	strings->count = 0;
+
+	if (strings->items != NULL)
+	{
+		strings->items[0] = NULL;
+	}
+
+	_arenaReset(&strings->arena);
+}
+
+/**
+ * Releases memory of the vector and its arena.
+ */
+void _stringsFree(struct _CBuild_Strings* const strings)
+{
+	free(strings->items);
+	_arenaFree(&strings->arena);
+	strings->items = NULL;
+	strings->count = 0;
+	strings->capacity = 0;
+}
+
+/**
+ * @}
+ */
+
+
+
+/**
+ * @addtogroup MAP
+ * 
+ * @{
+ */
+
+/**
+ * Hash map from strings to 64-bit values with open addressing. Keys are
+ * copied into the map's arena.
+ */
+struct _CBuild_Map
+{
+	const char** keys;
+	unsigned long long* hashes;
+	unsigned long long* values;
+	unsigned long long count;
+	unsigned long long capacity;
+	struct _CBuild_Arena arena;
+};
+
+/**
+ * Finds the slot of the key, or the empty slot where it should go.
+ */
+unsigned long long _mapSlot(const struct _CBuild_Map* const map, const char* const key, const unsigned long long hash)
+{
+	unsigned long long slot = hash & (map->capacity - 1);
+
+	while (map->keys[slot] != NULL AND (map->hashes[slot] != hash OR NOT STREQL(map->keys[slot], key)))
+	{
+		slot = (slot + 1) & (map->capacity - 1);
+	}
+
+	return slot;
+}
+
+/**
+ * Looks up the key. Returns 1 and stores its value (if value is not
+ * NULL) when the key is present, and 0 otherwise.
+ */
+int _mapGet(const struct _CBuild_Map* const map, const char* const key, unsigned long long* const value)
+{
+	if (map->count == 0)
+	{
+		return 0;
+	}
+
+	const unsigned long long slot = _mapSlot(map, key, HASH(key));
+
+	if (map->keys[slot] == NULL)
+	{
+		return 0;
+	}
+
+	if (value != NULL)
+	{
+		*value = map->values[slot];
+	}
+
+	return 1;
+}
+
+/**
+ * Inserts the key or updates its value.
+ * 
+ * @code{.c}
+ * 		struct _CBuild_Map map = { 0 };
+ * 		_mapSet(&map, "key", 10);
+ * @endcode
+ */
+void _mapSet(struct _CBuild_Map* const map, const char* const key, const unsigned long long value)
+{
+	if (2 * (map->count + 1) > map->capacity)
+	{
+		struct _CBuild_Map grown = { 0 };
+		grown.capacity = map->capacity > 0 ? 2 * map->capacity : 64;
+		grown.keys = (const char**)calloc(grown.capacity, sizeof(const char*));
+		grown.hashes = (unsigned long long*)malloc(grown.capacity * sizeof(unsigned long long));
+		grown.values = (unsigned long long*)malloc(grown.capacity * sizeof(unsigned long long));
+
+		for (unsigned long long index = 0; index < map->capacity; ++index)
+		{
+			if (map->keys[index] != NULL)
+			{
+				const unsigned long long slot = _mapSlot(&grown, map->keys[index], map->hashes[index]);
+				grown.keys[slot] = map->keys[index];
+				grown.hashes[slot] = map->hashes[index];
+				grown.values[slot] = map->values[index];
+			}
+		}
+
+		free(map->keys);
+		free(map->hashes);
+		free(map->values);
+		map->keys = grown.keys;
+		map->hashes = grown.hashes;
+		map->values = grown.values;
+		map->capacity = grown.capacity;
+	}
+
+	const unsigned long long hash = HASH(key);
+	const unsigned long long slot = _mapSlot(map, key, hash);
+
+	if (map->keys[slot] == NULL)
+	{
+		map->keys[slot] = _arenaStrdup(&map->arena, key);
+		map->hashes[slot] = hash;
+		++map->count;
+	}
+
+	map->values[slot] = value;
+}
+
+/**
+ * Removes all keys, keeping memory for reuse.
+ */
+void _mapClear(struct _CBuild_Map* const map)
+{
+	if (map->count > 0)
+	{
+		memset(map->keys, 0, map->capacity * sizeof(const char*));
+		map->count = 0;
+		_arenaReset(&map->arena);
+	}
+}
+
+/**
+ * Releases memory of the map and its keys.
+ */
+void _mapFree(struct _CBuild_Map* const map)
+{
+	free(map->keys);
+	free(map->hashes);
+	free(map->values);
+	_arenaFree(&map->arena);
+	memset(map, 0, sizeof(struct _CBuild_Map));
+}
+
+/**
+ * @}
+ */
+
+
+
+/**
+ * @addtogroup PROBE
+ * 
+ * @{
+ */
+
+#define CBUILD_PROBE_KIND 'k'
+#define CBUILD_PROBE_TIME 't'
+
+/**
+ * Whether paths looked at are recorded in @ref _cbuildProbes, which is
+ * the case while @ref _configure runs the configuration.
+ */
+int _cbuildProbing = 0;
+
+/**
+ * Paths the configuration looked at, keyed by the probe type followed by
+ * the path: CBUILD_PROBE_KIND for checks of what the path is, and
+ * CBUILD_PROBE_TIME for directories listed and files written, whose
+ * modification time matters.
+ */
+struct _CBuild_Map _cbuildProbes = { 0 };
+
+/**
+ * Set when an action was run with logic of its own around it, such as
+ * hermetic actions and shared libraries, or when the configuration
+ * changed the tree itself (see @ref _probeEffect), so the graph can not
+ * be replayed by @ref _configure.
+ */
+int _cbuildGraphOpaque = 0;
+
+/**
+ * Records that the configuration looked at the path, if it is being
+ * recorded.
+ */
+void _probe(const char type, const char* const path)
+{
+	if (_cbuildProbing)
+	{
+		char prefix[2] = { type, '\0' };
+		const char* key = CONCAT(prefix, path);
+		_mapSet(&_cbuildProbes, key, 0);
+		free((void*)key);
+	}
+}
+
+/**
+ * Records that the configuration changed the tree outside of actions,
+ * by running a command or copying, moving or removing files, if it is
+ * being recorded. Replaying the actions would skip the change, so the
+ * graph is not snapshotted.
+ */
+void _probeEffect(void)
+{
+	if (_cbuildProbing)
+	{
+		_cbuildGraphOpaque = 1;
+	}
+}
+
+/**
+ * Returns the current state of a probed path: -1 if it is missing, and
+ * otherwise 0, 1 or 2 for other, file or directory (CBUILD_PROBE_KIND),
+ * or its modification time (CBUILD_PROBE_TIME).
+ */
+long long _probeState(const char* const key)
+{
+#ifdef _WIN32
+	assert(!"TODO: implement _probeState with Windows WIN32 API!");
+#else
+	struct stat info;
+
+	if (stat(key + 1, &info) < 0)
+	{
+		return -1;
+	}
+
+	if (key[0] == CBUILD_PROBE_TIME)
+	{
+		return (long long)info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec;
+	}
+
+	return S_ISREG(info.st_mode) ? 1 : S_ISDIR(info.st_mode) ? 2 : 0;
+#endif
+}
+
+/**
+ * @}
+ */
+
+
+
+/**
+ * @addtogroup ISFILE
+ * 
+ * @{
+ */
+
+/**
+ * Checks if path is a file or not. Path must be correctly formatted,
+ * and can be provided with @ref PATH macro.
+ * 
+ * @code{.c}
+ * 		bool is = _isfile(PATH("folder1", "folder2"));
+ * @endcode
+ */
+int _isfile(const char* const path)
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _isfile()\n");
+#endif
+
+#ifdef _WIN32
+	assert(!"TODO: implement _isfile with Windows WIN32 API!");
+#else
+	struct stat info;
+	const int result = (stat(path, &info) == 0) && (info.st_mode & S_IFREG);
+	_probe(CBUILD_PROBE_KIND, path);
+	return result;
+#endif
+}
+
+/**
+ * Wraps @ref _isfile function.
+ * 
+ * @code{.c}
+ * 		bool is = ISFILE(PATH("folder1", "folder2"));
+ * @endcode
+ */
+#ifndef ISFILE
+#	define ISFILE(path) _isfile(path)
+#endif
+
+/**
+ * @}
+ */
+
+
+
+/**
+ * @addtogroup ISDIR
+ * 
+ * @{
+ */
+
+/**
+ * Checks if path is a directory or not. Path must be correctly formatted,
+ * and can be provided with @ref PATH macro.
+ * 
+ * @code{.c}
+ * 		bool is = _isdir(PATH("folder1", "folder2"));
+ * @endcode
+ */
+int _isdir(const char* const path)
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _isdir()\n");
+#endif
+
+#ifdef _WIN32
+	assert(!"TODO: implement _isdir with Windows WIN32 API!");
+#else
+	struct stat info;
+	const int result = (stat(path, &info) == 0) && (info.st_mode & S_IFDIR);
+	_probe(CBUILD_PROBE_KIND, path);
+	return result;
+#endif
+}
+
+/**
+ * Wraps @ref _isdir function.
+ * 
+ * @code{.c}
+ * 		bool is = ISDIR(PATH("folder1", "folder2"));
+ * @endcode
+ */
+#ifndef ISDIR
+#	define ISDIR(path) _isdir(path)
+#endif
+
+/**
+ * @}
+ */
+
+
+
+/**
+ * @addtogroup EXISTS
+ * 
+ * @{
+ */
+
+/**
+ * Chesks if provided path exists ir not. Path must be correctly
+ * formatted, and can be provided using @ref PATH macro.
+ * 
+ * @code{.c}
+ * 		int result = _exists(PATH("folder1", "file.txt"));
+ * @endcode
+ */
+int _exists(const char* const path)
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _exists()\n");
+#endif
+
+#ifdef _WIN32
+	assert(!"TODO: implement _exists with Windows WIN32 API!");
+#else
+	const int result = _isfile(path) || _isdir(path);
+	return result;
+#endif
+}
+
+/**
+ * Wraps @ref _exists function.
+ * 
+ * @code{.c}
+ * 		int result = EXISTS(PATH("folder1", "file.txt"));
+ * @endcode
+ */
+#ifndef EXISTS
+#	define EXISTS(path) _exists(path)
+#endif
+
+/**
+ * @}
+ */
+
+
+
+/**
+ * @addtogroup ENSUREDIR
+ * 
+ * @{
+ */
+
+/**
+ * When set (with `--dry-run`), stale actions are only reported, not
+ * executed, and the file system is left untouched (see
+ * @ref _dryRunSkip).
+ */
+int _cbuildDryRun = 0;
+
+/**
+ * Checks whether a change of the file system has to be skipped because
+ * of `--dry-run`, and reports it when change is not NULL. Returns 1 if
+ * it is skipped, and 0 otherwise.
+ */
+int _dryRunSkip(const char* const change, const char* const path)
+{
+	if (NOT _cbuildDryRun)
+	{
+		return 0;
+	}
+
+#if CBUILD_ECHO_LEVEL >= 1
+	if (change != NULL)
+	{
+		ECHO(stdout, " -- "CBUILD_INFO_LABEL" Would %s `%s`.\n", change, path);
+	}
+#endif
+
+	return 1;
+}
+
+/**
+ * Directories known to exist, either found or created by this process.
+ */
+struct _CBuild_Map _cbuildDirectories = { 0 };
+
+/**
+ * Checks that a path which already exists, relative to the directory
+ * descriptor, is a directory or a symbolic link to one. Returns 0 if it
+ * is, and -1 with errno set to ENOTDIR otherwise.
+ */
+int _existingDirAt(const int directory, const char* const path)
+{
+#ifdef _WIN32
+	assert(!"TODO: implement _existingDirAt with Windows WIN32 API!");
+#else
+	struct stat info;
+
+	if (fstatat(directory, path, &info, 0) == 0 AND S_ISDIR(info.st_mode))
+	{
+		return 0;
+	}
+
+	errno = ENOTDIR;
+	return -1;
+#endif
+}
+
+/**
+ * Makes sure the directory and all its parents exist. Directories known
+ * to exist are remembered, so repeated calls for the same directory cost
+ * no system calls. Missing components are created with `mkdirat`
+ * relative to the deepest existing parent, without resolving the path
+ * prefix again for every component. Nothing is created with
+ * `--dry-run`. Returns 0 on success, and -1 with errno set otherwise,
+ * ENOTDIR if a component exists but is not a directory.
+ * 
+ * @code{.c}
+ * 		_ensureDir(PATH("build", "objects", "source"));
+ * @endcode
+ */
+int _ensureDir(const char* const path)
+{
+#ifdef _WIN32
+	assert(!"TODO: implement _ensureDir with Windows WIN32 API!");
+#else
+	if (_mapGet(&_cbuildDirectories, path, NULL) OR _dryRunSkip(NULL, path))
+	{
+		return 0;
+	}
+
+	if (mkdir(path, 0777) == 0 OR (errno == EEXIST AND _existingDirAt(AT_FDCWD, path) == 0))
+	{
+		_mapSet(&_cbuildDirectories, path, 1);
+		return 0;
+	}
+
+	if (errno != ENOENT)
+	{
+		return -1;
+	}
+
+	char* buffer = strdup(path);
+	unsigned long long length = strlen(buffer);
+	unsigned long long existing = length;
+	int directory = -1;
+
+	while (length > 1 AND buffer[length - 1] == PATH_SEPARATOR[0])
+	{
+		buffer[--length] = '\0';
+	}
+
+	while (directory < 0)
+	{
+		while (existing > 0 AND buffer[existing - 1] != PATH_SEPARATOR[0])
+		{
+			--existing;
+		}
+
+		while (existing > 0 AND buffer[existing - 1] == PATH_SEPARATOR[0])
+		{
+			--existing;
+		}
+
+		if (existing == 0)
+		{
+			directory = open(buffer[0] == PATH_SEPARATOR[0] ? PATH_SEPARATOR : ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+			break;
+		}
+
+		buffer[existing] = '\0';
+		directory = open(buffer, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+		const int error = errno;
+		buffer[existing] = PATH_SEPARATOR[0];
+
+		if (directory < 0 AND error != ENOENT)
+		{
+			free(buffer);
+			errno = error;
+			return -1;
+		}
+	}
+
+	for (unsigned long long position = existing; directory >= 0;)
+	{
+		while (position < length AND buffer[position] == PATH_SEPARATOR[0])
+		{
+			++position;
+		}
+
+		if (position >= length)
+		{
+			break;
+		}
+
+		unsigned long long end = position;
+
+		while (end < length AND buffer[end] != PATH_SEPARATOR[0])
+		{
+			++end;
+		}
+
+		buffer[end] = '\0';
+
+		if (mkdirat(directory, buffer + position, 0777) < 0 AND (errno != EEXIST OR _existingDirAt(directory, buffer + position) < 0))
+		{
+			const int error = errno;
+			close(directory);
+			directory = -1;
+			errno = error;
+			break;
+		}
+
+		_mapSet(&_cbuildDirectories, buffer, 1);
+
+		if (end < length)
+		{
+			const int next = openat(directory, buffer + position, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+			const int error = errno;
+			close(directory);
+			directory = next;
+			errno = error;
+			buffer[end] = PATH_SEPARATOR[0];
+		}
+
+		position = end;
+	}
+
+	free(buffer);
+
+	if (directory < 0)
+	{
+		return -1;
+	}
+
+	close(directory);
+	_mapSet(&_cbuildDirectories, path, 1);
+	return 0;
+#endif
+}
+
+/**
+ * Wraps @ref _ensureDir function, and exits on failure.
+ * 
+ * @code{.c}
+ * 		ENSURE_DIR(PATH("build", "objects", "source"));
+ * @endcode
+ */
+#ifndef ENSURE_DIR
+#	define ENSURE_DIR(path) \
+	{ \
+		const char* _cbuildEnsureDir = path; \
+		if (_ensureDir(_cbuildEnsureDir) < 0) \
+		{ \
+			ECHO(stderr, CBUILD_ERROR_LABEL" Failed to create directory at path `%s`: "CBUILD_ERROR("%s")"\n", _cbuildEnsureDir, strerror(errno)); \
+			exit(1); \
+		} \
+	}
+#endif
+
+/**
+ * Creates the parent directory of a file path (see @ref _ensureDir).
+ * Returns 0 on success, and -1 otherwise.
+ */
+int _ensureParent(const char* const path)
+{
+	const char* separator = strrchr(path, PATH_SEPARATOR[0]);
+
+	if (separator == NULL OR separator == path)
+	{
+		return 0;
+	}
+
+	char* parent = strndup(path, separator - path);
+	const int result = _ensureDir(parent);
+	free(parent);
+	return result;
+}
+
+/**
+ * Creates all directories of a NULL terminated array up front. Paths
+ * are sorted first, so parents are created before their children and
+ * each shared prefix is resolved only once. Exits on failure.
+ * 
+ * @code{.c}
+ * 		const char* directories[] = { "build/a", "build/b", "build", NULL };
+ * 		_ensureDirs(directories);
+ * @endcode
+ */
+void _ensureDirs(const char* const* paths)
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _ensureDirs()\n");
+#endif
+
+	unsigned long long count = 0;
+
+	while (paths[count] != NULL)
+	{
+		++count;
+	}
+
+	const char** sorted = (const char**)malloc((count + 1) * sizeof(const char*));
+	memcpy(sorted, paths, count * sizeof(const char*));
+	qsort(sorted, count, sizeof(const char*), _compareStrings);
+
+	for (unsigned long long index = 0; index < count; ++index)
+	{
+		if (index == 0 OR NOT STREQL(sorted[index], sorted[index - 1]))
+		{
+			ENSURE_DIR(sorted[index]);
+		}
+	}
+
+	free(sorted);
+}
+
+/**
+ * Wraps @ref _ensureDirs function with variadic paths.
+ * 
+ * @code{.c}
+ * 		ENSURE_DIRS(PATH("build", "a"), PATH("build", "b"));
+ * @endcode
+ */
+#ifndef ENSURE_DIRS
+#	define ENSURE_DIRS(...) \
+	{ \
+		const char* _cbuildEnsureDirs[] = { __VA_ARGS__, NULL }; \
+		_ensureDirs(_cbuildEnsureDirs); \
+	}
+#endif
+
+/**
+ * Forgets all known directories. Called whenever paths are removed or
+ * moved, since any of them could be affected.
+ */
+#ifndef ENSURE_DIR_FORGET
+#	define ENSURE_DIR_FORGET() _mapClear(&_cbuildDirectories)
+#endif
+
+/**
+ * @}
+ */
+
+
+
+/**
+ * @addtogroup STATCACHE
+ * 
+ * @{
+ */
+
+/**
+ * Modification times known to be current, by path. Filled by the build
+ * server (see @ref _serve), which keeps it fresh with inotify and hands
+ * it to every run it forks, and by batched lookups of @ref _statPrefetch
+ * right before staleness checks. Forgotten whenever a command of the
+ * build script finishes (see @ref _waitChild). Values are the time plus
+ * 2, 1 for a missing path and 0 for a forgotten one.
+ */
+struct _CBuild_Map _cbuildStatCache = { 0 };
+
+/**
+ * Paths whose modification times were looked up by @ref _statPrefetch.
+ * Actions may write files besides their outputs, so these times only
+ * hold until the next action finishes (see @ref _statForgetPrefetched).
+ */
+struct _CBuild_Map _cbuildStatPrefetched = { 0 };
+
+/**
+ * Pipe to the build server receiving modification times this run had to
+ * look up itself, or -1 when not run by the server.
+ */
+int _cbuildStatReport = -1;
+
+/**
+ * Lookups not yet sent to the build server, as `<time> <path>` lines.
+ */
+struct _CBuild_Buffer _cbuildStatReports = { 0 };
+
+/**
+ * Sends pending lookups to the build server. Registered with `atexit`
+ * in every run forked by the server.
+ */
+void _statReportFlush(void)
+{
+	if (_cbuildStatReport >= 0 AND _cbuildStatReports.length > 0)
+	{
+		unsigned long long total = 0;
+
+		while (total < _cbuildStatReports.length)
+		{
+			const ssize_t count = write(_cbuildStatReport, _cbuildStatReports.data + total, _cbuildStatReports.length - total);
+
+			if (count < 0 AND errno == EINTR)
+			{
+				continue;
+			}
+
+			if (count <= 0)
+			{
+				break;
+			}
+
+			total += count;
+		}
+
+		BUFFER_CLEAR(&_cbuildStatReports);
+	}
+}
+
+/**
+ * Queues a lookup done by this run for the build server.
+ */
+void _statReport(const char* const path, const long long mtime)
+{
+	if (_cbuildStatReport >= 0 AND strchr(path, '\n') == NULL)
+	{
+		_bufferAppendf(&_cbuildStatReports, "%lld %s\n", mtime, path);
+
+		if (_cbuildStatReports.length >= 60 * 1024)
+		{
+			_statReportFlush();
+		}
+	}
+}
+
+/**
+ * Content of a file read ahead by @ref _readAhead.
+ */
+struct _CBuild_ReadAhead
+{
+	char* content;
+	unsigned long long length;
+};
+
+/**
+ * Files read ahead in one batch, by path, each handed over to the first
+ * @ref _readFile of the path. Values point to heap allocated
+ * struct _CBuild_ReadAhead, or are 0 once handed over or forgotten.
+ */
+struct _CBuild_Map _cbuildReadAhead = { 0 };
+
+/**
+ * Drops the content of the path read ahead, if any.
+ */
+void _readAheadForget(const char* const path)
+{
+	unsigned long long value = 0;
+
+	if (_mapGet(&_cbuildReadAhead, path, &value) AND value != 0)
+	{
+		free(((struct _CBuild_ReadAhead*)(uintptr_t)value)->content);
+		free((void*)(uintptr_t)value);
+		_mapSet(&_cbuildReadAhead, path, 0);
+	}
+}
+
+/**
+ * Drops contents of all files read ahead.
+ */
+void _readAheadClear(void)
+{
+	for (unsigned long long index = 0; index < _cbuildReadAhead.capacity; ++index)
+	{
+		if (_cbuildReadAhead.keys[index] != NULL)
+		{
+			_readAheadForget(_cbuildReadAhead.keys[index]);
+		}
+	}
+
+	_mapClear(&_cbuildReadAhead);
+}
+
+/**
+ * Forgets the cached modification time of the path, and its content read
+ * ahead. Called whenever the library itself writes a file, since the
+ * build server only learns about it after the run.
+ */
+void _statForget(const char* const path)
+{
+	unsigned long long value = 0;
+
+	if (_mapGet(&_cbuildStatCache, path, &value) AND value != 0)
+	{
+		_mapSet(&_cbuildStatCache, path, 0);
+	}
+
+	_readAheadForget(path);
+}
+
+/**
+ * Forgets all cached modification times and contents read ahead.
+ */
+void _statForgetAll(void)
+{
+	_mapClear(&_cbuildStatCache);
+	_mapClear(&_cbuildStatPrefetched);
+	_readAheadClear();
+}
+
+/**
+ * Forgets modification times looked up by @ref _statPrefetch. Called
+ * whenever an action finishes.
+ */
+void _statForgetPrefetched(void)
+{
+	for (unsigned long long index = 0; index < _cbuildStatPrefetched.capacity; ++index)
+	{
+		if (_cbuildStatPrefetched.keys[index] != NULL)
+		{
+			_statForget(_cbuildStatPrefetched.keys[index]);
+		}
+	}
+
+	_mapClear(&_cbuildStatPrefetched);
+}
+
+/**
+ * Wraps @ref _statForget function.
+ */
+#ifndef STAT_FORGET
+#	define STAT_FORGET(path) _statForget(path)
+#endif
+
+/**
+ * Forgets all cached modification times. Called whenever paths are
+ * removed or moved, since any of them could be affected.
+ */
+#ifndef STAT_FORGET_ALL
+#	define STAT_FORGET_ALL() _statForgetAll()
+#endif
+
+/**
+ * @}
+ */
+
+
+
+/**
+ * @addtogroup WRITEFILE
+ * 
+ * @{
+ */
+
+#ifndef IOV_MAX
+#	define IOV_MAX 1024
+#endif
+
+/**
+ * Checks whether the file at path already holds exactly the content of
+ * provided parts.
+ */
+int _writeFileSame(const char* const path, const struct iovec* const parts, const unsigned long long count, const unsigned long long length)
+{
+	struct stat info;
+	const int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+	if (fd < 0)
+	{
+		return 0;
+	}
+
+	if (fstat(fd, &info) < 0 OR (unsigned long long)info.st_size != length)
+	{
+		close(fd);
+		return 0;
+	}
+
+	char buffer[64 * 1024];
+	int same = 1;
+	off_t offset = 0;
+
+	for (unsigned long long part = 0; part < count AND same; ++part)
+	{
+		for (unsigned long long done = 0; done < parts[part].iov_len AND same;)
+		{
+			const unsigned long long wanted = parts[part].iov_len - done < sizeof(buffer) ? parts[part].iov_len - done : sizeof(buffer);
+			const ssize_t got = pread(fd, buffer, wanted, offset);
+			same = got == (ssize_t)wanted AND memcmp(buffer, (const char*)parts[part].iov_base + done, wanted) == 0;
+			done += wanted;
+			offset += wanted;
+		}
+	}
+
+	close(fd);
+	return same;
+}
+
+/**
+ * Writes content gathered from parts to the file atomically: it goes to
+ * a temporary sibling with `writev` and is renamed over the path, so
+ * readers never see a partial file. If the file already holds the same
+ * content, nothing is written and its modification time is preserved,
+ * so nothing depending on it gets rebuilt. A replaced file keeps its
+ * permissions, and parent directories are created when missing. With
+ * `--dry-run` a changed file is only reported. Returns 1 if the file
+ * was (or would be) written, 0 if it was unchanged, and -1 with errno
+ * set on failure.
+ * 
+ * @code{.c}
+ * 		struct iovec parts[] = { { "#define A ", 10 }, { "1\n", 2 } };
+ * 		_writeFilev(PATH("build", "config.h"), parts, 2);
+ * @endcode
+ */
+int _writeFilev(const char* const path, const struct iovec* const parts, const unsigned long long count)
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _writeFilev()\n");
+#endif
+
+#ifdef _WIN32
+	assert(!"TODO: implement _writeFilev with Windows WIN32 API!");
+#else
+	unsigned long long length = 0;
+
+	for (unsigned long long part = 0; part < count; ++part)
+	{
+		length += parts[part].iov_len;
+	}
+
+	_probe(CBUILD_PROBE_TIME, path);
+
+	if (_writeFileSame(path, parts, count, length))
+	{
+		return 0;
+	}
+
+	if (_dryRunSkip("write", path))
+	{
+		return 1;
+	}
+
+	const char* separator = strrchr(path, PATH_SEPARATOR[0]);
+
+	if (separator != NULL AND separator != path)
+	{
+		char* parent = strndup(path, separator - path);
+		const int result = _ensureDir(parent);
+		free(parent);
+
+		if (result < 0)
+		{
+			return -1;
+		}
+	}
+
+	char suffix[32];
+	sprintf(suffix, ".tmp.%d", (int)getpid());
+	const char* temporary = CONCAT(path, suffix);
+	const int fd = open(temporary, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+
+	if (fd < 0)
+	{
+		free((void*)temporary);
+		return -1;
+	}
+
+	struct stat existing;
+
+	if (stat(path, &existing) == 0)
+	{
+		fchmod(fd, existing.st_mode & 07777);
+	}
+
+	struct iovec* pending = (struct iovec*)malloc((count + 1) * sizeof(struct iovec));
+	memcpy(pending, parts, count * sizeof(struct iovec));
+	unsigned long long first = 0;
+	int result = 0;
+
+	while (first < count AND result == 0)
+	{
+		const int chunk = count - first < IOV_MAX ? (int)(count - first) : IOV_MAX;
+		ssize_t written = writev(fd, pending + first, chunk);
+
+		if (written < 0)
+		{
+			result = errno == EINTR ? 0 : -1;
+			continue;
+		}
+
+		while (first < count AND (unsigned long long)written >= pending[first].iov_len)
+		{
+			written -= pending[first++].iov_len;
+		}
+
+		if (first < count)
+		{
+			pending[first].iov_base = (char*)pending[first].iov_base + written;
+			pending[first].iov_len -= written;
+		}
+	}
+
+	free(pending);
+
+	if (close(fd) < 0 OR result < 0 OR rename(temporary, path) < 0)
+	{
+		const int error = errno;
+		unlink(temporary);
+		free((void*)temporary);
+		errno = error;
+		return -1;
+	}
+
+	free((void*)temporary);
+	STAT_FORGET(path);
+	return 1;
+#endif
+}
+
+/**
+ * Wraps @ref _writeFilev function for a single buffer.
+ * 
+ * @code{.c}
+ * 		_writeFile(PATH("build", "config.h"), buffer.data, buffer.length);
+ * @endcode
+ */
+int _writeFile(const char* const path, const void* const data, const unsigned long long length)
+{
+	struct iovec part = { (void*)data, length };
+	return _writeFilev(path, &part, 1);
+}
+
+/**
+ * Writes NULL terminated variadic list of strings to the file with
+ * @ref _writeFilev, and exits on failure.
+ */
+int _writeFileStrings(const char* const path, ...)
+{
+	static struct iovec* parts = NULL;
+	static unsigned long long capacity = 0;
+	unsigned long long count = 0;
+	va_list args;
+
+	FOREACH_ARG_IN_VA_ARGS(path, const char*, arg, args,
+	{
+		if (count == capacity)
+		{
+			capacity = capacity > 0 ? 2 * capacity : 16;
+			parts = (struct iovec*)realloc(parts, capacity * sizeof(struct iovec));
+		}
+
+		parts[count].iov_base = (void*)arg;
+		parts[count++].iov_len = strlen(arg);
+	});
+
+	const int result = _writeFilev(path, parts, count);
+
+	if (result < 0)
+	{
+#if CBUILD_ECHO_LEVEL >= 1
+		ECHO(stderr, CBUILD_ERROR_LABEL" Failed to write file at path `%s`: "CBUILD_ERROR("%s")"\n", path, strerror(errno));
+#endif
+
+		exit(1);
+	}
+
+	return result;
+}
+
+/**
+ * Wraps @ref _writeFileStrings function.
+ * 
+ * @code{.c}
+ * 		WRITE_FILE(PATH("build", "config.h"), "#define VERSION \"", version, "\"\n");
+ * @endcode
+ */
+#ifndef WRITE_FILE
+#	define WRITE_FILE(path, ...) _writeFileStrings(path, __VA_ARGS__, NULL)
+#endif
+
+/**
+ * @}
+ */
+
+
+
+/**
+ * @addtogroup MKDIR
+ * 
+ * @{
+ */
+
+/**
+ * Creates a directory and all subdirectories in the provided path.
+ * The path must be a NULL terminated variadic list of strings, not
+ * a regular path format! Existing directories are not reported.
+ * 
+ * @code{.c}
+ * 		_mkdir(0, "first", "second", "third", NULL);
+ * 		// Creates directories: 'first/', 'first/second/', and 'first/second/third/'
+ * @endcode
+ */
+void _mkdir(int ignore, ...)
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _mkdir()\n");
+#endif
+
+#ifdef _WIN32
+	assert(!"TODO: implement _mkdir with Windows WIN32 API!");
+#else
+	static struct _CBuild_Buffer buffer = { 0 };
+	BUFFER_CLEAR(&buffer);
+	va_list args;
+
+	FOREACH_ARG_IN_VA_ARGS(ignore, const char*, arg, args,
+	{
+		if (buffer.length > 0)
+		{
+			BUFFER_APPEND(&buffer, PATH_SEPARATOR);
+		}
+
+		BUFFER_APPEND(&buffer, arg);
+	});
+
+	ENSURE_DIR(buffer.data);
+#endif
+}
+
+/**
+ * Wraps @ref _mkdir function and handles first and last arguments.
+ * 
+ * @code{.c}
+ * 		MKDIR("first", "second", "third");
+ * 		// Creates directories: 'first/', 'first/second/', and 'first/second/third/'
+ * @endcode
+ */
+#ifndef MKDIR
+#	define MKDIR(...) _mkdir(0, __VA_ARGS__, NULL)
+#endif
+
+/**
+ * @}
+ */
+
+
+
+/**
+ * @addtogroup MKFILE
+ * 
+ * @{
+ */
+
+/**
+ * Creates a file and all subdirectories in the provided path.
+ * The path must be a NULL terminated variadic list of strings, not
+ * a regular path format!
+ * 
+ * @code{.c}
+ * 		_mkfile(0, "first", "second", "third.txt", NULL);
+ * 		// Creates directories: 'first/', 'first/second/', and 'first/second/third.txt'
+ * @endcode
+ */
+void _mkfile(int ignore, ...)
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _mkfile()\n");
+#endif
+
+#ifdef _WIN32
+	assert(!"TODO: implement _mkfile with Windows WIN32 API!");
+#else
+	static struct _CBuild_Buffer buffer = { 0 };
+	BUFFER_CLEAR(&buffer);
+	va_list args;
+
+	FOREACH_ARG_IN_VA_ARGS(ignore, const char*, arg, args,
+	{
+		if (buffer.length > 0)
+		{
+			BUFFER_APPEND(&buffer, PATH_SEPARATOR);
+		}
+
+		BUFFER_APPEND(&buffer, arg);
+	});
+
+	if (_dryRunSkip(_exists(buffer.data) ? NULL : "create", buffer.data))
+	{
+		return;
+	}
+
+	char* separator = strrchr(buffer.data, PATH_SEPARATOR[0]);
+
+	if (separator != NULL AND separator != buffer.data)
+	{
+		*separator = '\0';
+		ENSURE_DIR(buffer.data);
+		*separator = PATH_SEPARATOR[0];
+	}
+
+	const int fd = open(buffer.data, O_WRONLY | O_CREAT | O_EXCL | O_TRUNC, S_IRWXU);
+
+	if (fd == -1)
+	{
+		if (errno == EEXIST)
+		{
+#if CBUILD_ECHO_LEVEL >= 1
+			ECHO(stderr, " -- "CBUILD_WARNING_LABEL" Path `%s` already exists: "CBUILD_WARNING("%s")"\n", buffer.data, strerror(errno));
+#endif
+		}
+		else
+		{
+#if CBUILD_ECHO_LEVEL >= 1
+			ECHO(stderr, " -- "CBUILD_ERROR_LABEL" Failed to create file at path `%s`: "CBUILD_ERROR("%s")"\n", buffer.data, strerror(errno));
+#endif
+
+			exit(1);
+		}
+	}
+	else
+	{
+		close(fd);
+		STAT_FORGET(buffer.data);
+	}
+#endif
+}
+
+/**
+ * Wraps @ref _mkfile function and handles first and last arguments.
+ * 
+ * @code{.c}
+ * 		MKFILE("first", "second", "third.txt");
  * 		// Creates directories: 'first/', 'first/second/', and 'first/second/third.txt'
  * @endcode
  */
-void _mkfile(int ignore, ...)
+#ifndef MKFILE
+#	define MKFILE(...) _mkfile(0, __VA_ARGS__, NULL)
+#endif
+
+/**
+ * @}
+ */
+
+
+
+/**
+ * @addtogroup RM
+ * 
+ * @{
+ */
+
+/**
+ * Removes an entry relative to the directory file descriptor. Directories
+ * are removed recursively through their own descriptors with `unlinkat`,
+ * so no paths are built, and entry types come from `d_type` without any
+ * stat calls. Returns 0 on success, and -1 with errno set otherwise.
+ */
+int _rmat(const int directory, const char* const name, const int isDirectory)
+{
+#ifdef _WIN32
+	assert(!"TODO: implement _rmat with Windows WIN32 API!");
+#else
+	if (NOT isDirectory)
+	{
+		if (unlinkat(directory, name, 0) == 0)
+		{
+			return 0;
+		}
+
+		if (errno != EISDIR AND errno != EPERM)
+		{
+			return -1;
+		}
+	}
+
+	const int fd = openat(directory, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+
+	if (fd < 0)
+	{
+		return -1;
+	}
+
+	DIR* dir = fdopendir(fd);
+
+	if (dir == NULL)
+	{
+		close(fd);
+		return -1;
+	}
+
+	struct dirent* dp = NULL;
+
+	while ((dp = readdir(dir)))
+	{
+		IGNORE_DIRECTORY_IF_DOTS(dp->d_name);
+
+		if (_rmat(fd, dp->d_name, dp->d_type == DT_DIR) < 0)
+		{
+#if CBUILD_ECHO_LEVEL >= 1
+			ECHO(stderr, CBUILD_ERROR_LABEL" Failed to remove `%s` in `%s`: "CBUILD_ERROR("%s")"\n", dp->d_name, name, strerror(errno));
+#endif
+		}
+	}
+
+	closedir(dir);
+	return unlinkat(directory, name, AT_REMOVEDIR);
+#endif
+}
+
+/**
+ * Reports failure of removing the path, if any.
+ */
+void _rmReport(const char* const path, const int result)
+{
+	if (result == 0)
+	{
+		return;
+	}
+
+	if (errno == ENOENT)
+	{
+#if CBUILD_ECHO_LEVEL >= 1
+		ECHO(stdout, CBUILD_WARNING_LABEL" Path `%s` does not exist: "CBUILD_WARNING("%s")"\n", path, strerror(errno));
+#endif
+
+		errno = 0;
+	}
+	else
+	{
+#if CBUILD_ECHO_LEVEL >= 1
+		ECHO(stderr, CBUILD_ERROR_LABEL" Failed to remove path `%s`: "CBUILD_ERROR("%s")"\n", path, strerror(errno));
+#endif
+	}
+}
+
+/**
+ * Removes a file, or a directory with all its content.
+ * 
+ * @code{.c}
+ * 		_rm(PATH("folder1", "file.txt"));
+ * @endcode
+ */
+void _rm(const char* const path)
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _rm()\n");
+#endif
+
+#ifdef _WIN32
+	assert(!"TODO: implement _rm with Windows WIN32 API!");
+#else
+	_probeEffect();
+
+	if (_dryRunSkip("remove", path))
+	{
+		return;
+	}
+
+	ENSURE_DIR_FORGET();
+	STAT_FORGET_ALL();
+	_rmReport(path, _rmat(AT_FDCWD, path, 0));
+#endif
+}
+
+/**
+ * Wraps @ref _rm function.
+ * 
+ * @code{.c}
+ * 		RM(PATH("folder1", "file.txt"));
+ * @endcode
+ */
+#ifndef RM
+#	define RM(path) _rm(path)
+#endif
+
+/**
+ * Removes a directory like @ref _rm, but deletes its subdirectories in
+ * up to jobs child processes at once.
+ * 
+ * @code{.c}
+ * 		_rmParallel(PATH("build"), 8);
+ * @endcode
+ */
+void _rmParallel(const char* const path, const unsigned long long jobs)
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _rmParallel()\n");
+#endif
+
+#ifdef _WIN32
+	assert(!"TODO: implement _rmParallel with Windows WIN32 API!");
+#else
+	_probeEffect();
+
+	if (_dryRunSkip("remove", path))
+	{
+		return;
+	}
+
+	ENSURE_DIR_FORGET();
+	STAT_FORGET_ALL();
+	const int fd = open(path, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+	DIR* dir = fd >= 0 ? fdopendir(fd) : NULL;
+
+	if (dir == NULL)
+	{
+		_rm(path);
+		return;
+	}
+
+	pid_t* children = (pid_t*)malloc((jobs > 0 ? jobs : 1) * sizeof(pid_t));
+	unsigned long long running = 0;
+	unsigned long long first = 0;
+	struct dirent* dp = NULL;
+	fflush(stdout);
+	fflush(stderr);
+
+	while ((dp = readdir(dir)))
+	{
+		IGNORE_DIRECTORY_IF_DOTS(dp->d_name);
+
+		if (dp->d_type != DT_DIR OR jobs <= 1)
+		{
+			_rmReport(dp->d_name, _rmat(fd, dp->d_name, dp->d_type == DT_DIR));
+			continue;
+		}
+
+		if (running == jobs)
+		{
+			waitpid(children[first], NULL, 0);
+			first = (first + 1) % jobs;
+			--running;
+		}
+
+		const pid_t child = fork();
+
+		if (child == 0)
+		{
+			_rmReport(dp->d_name, _rmat(fd, dp->d_name, 1));
+			_exit(0);
+		}
+
+		if (child < 0)
+		{
+			_rmReport(dp->d_name, _rmat(fd, dp->d_name, 1));
+			continue;
+		}
+
+		children[(first + running++) % jobs] = child;
+	}
+
+	for (; running > 0; --running, first = (first + 1) % jobs)
+	{
+		waitpid(children[first], NULL, 0);
+	}
+
+	free(children);
+	closedir(dir);
+	_rmReport(path, rmdir(path));
+#endif
+}
+
+/**
+ * Wraps @ref _rmParallel function.
+ * 
+ * @code{.c}
+ * 		RM_PARALLEL(PATH("build"), 8);
+ * @endcode
+ */
+#ifndef RM_PARALLEL
+#	define RM_PARALLEL(path, jobs) _rmParallel(path, jobs)
+#endif
+
+/**
+ * Renames the path to a sibling trash name and removes it in a detached
+ * background process, so the caller returns immediately and the path is
+ * free to be recreated.
+ * 
+ * @code{.c}
+ * 		_rmBackground(PATH("build"));
+ * @endcode
+ */
+void _rmBackground(const char* const path)
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _rmBackground()\n");
+#endif
+
+#ifdef _WIN32
+	assert(!"TODO: implement _rmBackground with Windows WIN32 API!");
+#else
+	_probeEffect();
+
+	if (_dryRunSkip("remove", path))
+	{
+		return;
+	}
+
+	ENSURE_DIR_FORGET();
+	STAT_FORGET_ALL();
+	static unsigned long long counter = 0;
+	char suffix[64];
+	sprintf(suffix, ".trash.%d.%llu", (int)getpid(), counter++);
+	const char* trash = CONCAT(path, suffix);
+
+	if (rename(path, trash) < 0)
+	{
+		if (errno == ENOENT)
+		{
+			_rmReport(path, -1);
+		}
+		else
+		{
+			_rm(path);
+		}
+
+		free((void*)trash);
+		return;
+	}
+
+	fflush(stdout);
+	fflush(stderr);
+	const pid_t child = fork();
+
+	if (child == 0)
+	{
+		setsid();
+
+		if (fork() == 0)
+		{
+			_rmat(AT_FDCWD, trash, 0);
+		}
+
+		_exit(0);
+	}
+
+	if (child < 0)
+	{
+		_rm(trash);
+	}
+	else
+	{
+		waitpid(child, NULL, 0);
+	}
+
+	free((void*)trash);
+#endif
+}
+
+/**
+ * Wraps @ref _rmBackground function.
+ * 
+ * @code{.c}
+ * 		RM_BACKGROUND(PATH("build"));
+ * @endcode
+ */
+#ifndef RM_BACKGROUND
+#	define RM_BACKGROUND(path) _rmBackground(path)
+#endif
+
+/**
+ * @}
+ */
+
+
+
+/**
+ * @addtogroup COPY
+ * 
+ * @{
+ */
+
+/**
+ * Checks whether two opened files have the same content.
+ */
+int _sameContent(const int first, const int second)
+{
+	char a[64 * 1024];
+	char b[64 * 1024];
+
+	for (off_t offset = 0;;)
+	{
+		const ssize_t count = pread(first, a, sizeof(a), offset);
+
+		if (count < 0 OR pread(second, b, sizeof(b), offset) != count)
+		{
+			return 0;
+		}
+
+		if (count == 0)
+		{
+			return 1;
+		}
+
+		if (memcmp(a, b, count) != 0)
+		{
+			return 0;
+		}
+
+		offset += count;
+	}
+}
+
+/**
+ * Copies content between opened files using the cheapest mechanism
+ * available: a reflink (`FICLONE`) on copy-on-write filesystems, then
+ * in-kernel `copy_file_range` and `sendfile`, and plain read and write
+ * as the last resort. Returns 0 on success, and -1 otherwise.
+ */
+int _copyContent(const int input, const int output, const unsigned long long size)
+{
+#ifdef __linux__
+	if (ioctl(output, FICLONE, input) == 0)
+	{
+		return 0;
+	}
+
+	unsigned long long copied = 0;
+
+	while (copied < size)
+	{
+		const ssize_t count = copy_file_range(input, NULL, output, NULL, size - copied, 0);
+
+		if (count <= 0)
+		{
+			break;
+		}
+
+		copied += count;
+	}
+
+	while (copied < size)
+	{
+		off_t offset = copied;
+		const ssize_t count = sendfile(output, input, &offset, size - copied);
+
+		if (count <= 0)
+		{
+			break;
+		}
+
+		copied += count;
+	}
+
+	if (copied == size)
+	{
+		return 0;
+	}
+
+	if (lseek(input, copied, SEEK_SET) < 0 OR lseek(output, copied, SEEK_SET) < 0)
+	{
+		return -1;
+	}
+#endif
+
+	char buffer[64 * 1024];
+
+	for (;;)
+	{
+		const ssize_t count = read(input, buffer, sizeof(buffer));
+
+		if (count < 0 AND errno == EINTR)
+		{
+			continue;
+		}
+
+		if (count <= 0)
+		{
+			return count < 0 ? -1 : 0;
+		}
+
+		for (ssize_t written = 0; written < count;)
+		{
+			const ssize_t result = write(output, buffer + written, count - written);
+
+			if (result < 0 AND errno != EINTR)
+			{
+				return -1;
+			}
+
+			written += result > 0 ? result : 0;
+		}
+	}
+}
+
+/**
+ * Copies a file, symbolic link, or a whole directory. Permissions,
+ * ownership (when permitted) and timestamps are preserved. A destination
+ * file with the same size and modification time, or the same content, is
+ * left untouched. Files are written to a temporary sibling and renamed
+ * over the destination, so readers never see a partial file. Returns 0
+ * on success, and -1 otherwise.
+ * 
+ * @code{.c}
+ * 		_copy(PATH("build", "app"), PATH("install", "bin", "app"));
+ * @endcode
+ */
+int _copy(const char* const source, const char* const destination)
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _copy()\n");
+#endif
+
+#ifdef _WIN32
+	assert(!"TODO: implement _copy with Windows WIN32 API!");
+#else
+	_probeEffect();
+
+	if (_dryRunSkip("copy to", destination))
+	{
+		return 0;
+	}
+
+	struct stat info;
+
+	if (lstat(source, &info) < 0)
+	{
+		return -1;
+	}
+
+	if (S_ISLNK(info.st_mode))
+	{
+		char target[4096];
+		const ssize_t length = readlink(source, target, sizeof(target) - 1);
+
+		if (length < 0)
+		{
+			return -1;
+		}
+
+		target[length] = '\0';
+		unlink(destination);
+		return symlink(target, destination);
+	}
+
+	if (S_ISDIR(info.st_mode))
+	{
+		if (mkdir(destination, info.st_mode & 07777) < 0 AND errno != EEXIST)
+		{
+			return -1;
+		}
+
+		int result = 0;
+
+		FOREACH_FILE_IN_DIRECTORY(file, source,
+		{
+			IGNORE_DIRECTORY_IF_DOTS(file);
+			const char* from = PATH(source, file);
+			const char* to = PATH(destination, file);
+			result |= _copy(from, to);
+			free((void*)from);
+			free((void*)to);
+		});
+
+		return result;
+	}
+
+	const int input = open(source, O_RDONLY | O_CLOEXEC);
+
+	if (input < 0)
+	{
+		return -1;
+	}
+
+	struct stat existing;
+	const int current = open(destination, O_RDONLY | O_CLOEXEC);
+
+	if (current >= 0)
+	{
+		const int unchanged = fstat(current, &existing) == 0 AND S_ISREG(existing.st_mode) AND existing.st_size == info.st_size
+			AND ((existing.st_mtim.tv_sec == info.st_mtim.tv_sec AND existing.st_mtim.tv_nsec == info.st_mtim.tv_nsec) OR _sameContent(input, current));
+		close(current);
+
+		if (unchanged)
+		{
+#if CBUILD_ECHO_LEVEL >= 3
+			ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Skipping copy of unchanged `%s`\n", source);
+#endif
+
+			close(input);
+			return 0;
+		}
+	}
+
+	char suffix[32];
+	sprintf(suffix, ".tmp.%d", (int)getpid());
+	const char* temporary = CONCAT(destination, suffix);
+	const int output = open(temporary, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, info.st_mode & 07777);
+	int result = output < 0 ? -1 : _copyContent(input, output, info.st_size);
+
+	if (result == 0)
+	{
+		const struct timespec times[2] = { info.st_atim, info.st_mtim };
+
+		if (fchown(output, info.st_uid, info.st_gid) < 0)
+		{
+			errno = 0;
+		}
+
+		result = fchmod(output, info.st_mode & 07777) | futimens(output, times);
+	}
+
+	close(input);
+
+	if (output >= 0 AND (close(output) < 0 OR result < 0 OR rename(temporary, destination) < 0))
+	{
+		const int error = errno;
+		unlink(temporary);
+		errno = error;
+		result = -1;
+	}
+
+	free((void*)temporary);
+	STAT_FORGET(destination);
+	return result;
+#endif
+}
+
+/**
+ * Wraps @ref _copy function, and exits on failure.
+ * 
+ * @code{.c}
+ * 		COPY(PATH("build", "app"), PATH("install", "bin", "app"));
+ * @endcode
+ */
+#ifndef COPY
+#	define COPY(source, destination) \
+	{ \
+		const char* _cbuildCopySource = source; \
+		const char* _cbuildCopyDestination = destination; \
+		if (_copy(_cbuildCopySource, _cbuildCopyDestination) < 0) \
+		{ \
+			ECHO(stderr, CBUILD_ERROR_LABEL" Failed to copy path from `%s` to `%s`: "CBUILD_ERROR("%s")"\n", _cbuildCopySource, _cbuildCopyDestination, strerror(errno)); \
+			exit(1); \
+		} \
+	}
+#endif
+
+/**
+ * Installs a file or directory to destination with @ref _copy, creating
+ * missing parent directories first, and sets provided permissions on it
+ * (when mode is not 0).
+ * 
+ * @code{.c}
+ * 		_install(PATH("build", "app"), PATH("install", "bin", "app"), 0755);
+ * @endcode
+ */
+void _install(const char* const source, const char* const destination, const mode_t mode)
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _install()\n");
+#endif
+
+#ifdef _WIN32
+	assert(!"TODO: implement _install with Windows WIN32 API!");
+#else
+	if (_dryRunSkip("install to", destination))
+	{
+		return;
+	}
+
+	char* parent = strdup(destination);
+	char* separator = strrchr(parent, PATH_SEPARATOR[0]);
+
+	if (separator != NULL AND separator != parent)
+	{
+		*separator = '\0';
+		ENSURE_DIR(parent);
+	}
+
+	free(parent);
+
+	if (_copy(source, destination) < 0 OR (mode != 0 AND chmod(destination, mode) < 0))
+	{
+#if CBUILD_ECHO_LEVEL >= 1
+		ECHO(stderr, CBUILD_ERROR_LABEL" Failed to install `%s` to `%s`: "CBUILD_ERROR("%s")"\n", source, destination, strerror(errno));
+#endif
+
+		exit(1);
+	}
+
+#if CBUILD_ECHO_LEVEL >= 1
+	ECHO(stdout, " -- "CBUILD_INFO_LABEL" Installed `%s`.\n", destination);
+#endif
+#endif
+}
+
+/**
+ * Wraps @ref _install function.
+ * 
+ * @code{.c}
+ * 		INSTALL(PATH("build", "app"), PATH("install", "bin", "app"), 0755);
+ * @endcode
+ */
+#ifndef INSTALL
+#	define INSTALL(source, destination, mode) _install(source, destination, mode)
+#endif
+
+/**
+ * @}
+ */
+
+
+
+/**
+ * @addtogroup MV
+ * 
+ * @{
+ */
+
+/**
+ * Moves a file to other location. It can effectively rename a file.
+ * Source and destination are paths that can be formatted with @ref PATH
+ * macro. Moving across filesystems falls back to @ref _copy followed by
+ * removal of the source.
+ * 
+ * @code{.c}
+ * 		_mv(PATH("folder1", "file.txt"), PATH("folder2", "file.txt"));
+ * @endcode
+ */
+void _mv(const char* const source, const char* const destination)
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _mv()\n");
+#endif
+
+#ifdef _WIN32
+	assert(!"TODO: implement _mv with Windows WIN32 API!");
+#else
+	_probeEffect();
+
+	if (_dryRunSkip("move", source))
+	{
+		return;
+	}
+
+	ENSURE_DIR_FORGET();
+	STAT_FORGET_ALL();
+
+	if (rename(source, destination) == 0)
+	{
+		return;
+	}
+
+	if (errno == EXDEV AND _copy(source, destination) == 0)
+	{
+		_rm(source);
+	}
+	else
+	{
+#if CBUILD_ECHO_LEVEL >= 1
+		ECHO(stderr, CBUILD_ERROR_LABEL" Failed to move path from `%s` to `%s`: "CBUILD_ERROR("%s")"\n", source, destination, strerror(errno));
+#endif
+
+		exit(1);
+	}
+#endif
+}
+
+/**
+ * Wraps @ref _mv function.
+ * 
+ * @code{.c}
+ * 		MV(PATH("folder1", "file.txt"), PATH("folder2", "file.txt"));
+ * @endcode
+ */
+#ifndef MV
+#	define MV(source, destination) _mv(source, destination)
+#endif
+
+/**
+ * @}
+ */
+
+
+
+/**
+ * @addtogroup PLACEMENT
+ * 
+ * @{
+ */
+
+/**
+ * Cgroup v2 directory under which actions are placed (see
+ * @ref _placementPrepare), set by `--cgroup DIR`, or NULL. It has to be
+ * delegated to the user running the build.
+ */
+const char* _cbuildCgroup = NULL;
+
+/**
+ * CPU limit of all actions together, in processors, set by `--cpus N`,
+ * or 0 for no limit. Requires @ref _cbuildCgroup.
+ */
+double _cbuildCgroupCpus = 0;
+
+/**
+ * Memory limit of all actions together, in bytes, set by
+ * `--memory SIZE`, or 0 for no limit. Requires @ref _cbuildCgroup.
+ */
+unsigned long long _cbuildCgroupMemory = 0;
+
+/**
+ * Whether every worker slot is pinned to its own processor, set by
+ * `--pin`.
+ */
+int _cbuildPin = 0;
+
+/**
+ * Worker slot of the action being spawned by @ref _spawn, or -1 when
+ * the command is not an action.
+ */
+long long _cbuildSlot = -1;
+
+/**
+ * File the action being spawned by @ref _spawn writes its standard
+ * output and error to (see @ref _progressCapture), or -1 when it writes
+ * to those of the build.
+ */
+int _cbuildSlotOutput = -1;
+
+/**
+ * Cgroup created for this build under @ref _cbuildCgroup, holding one
+ * leaf per worker slot, or NULL until first used or when placement
+ * failed.
+ */
+const char* _cbuildCgroupBuild = NULL;
+int _cbuildCgroupFailed = 0;
+
+/**
+ * Processors this process may run on, ordered so that consecutive slots
+ * alternate between NUMA nodes, spreading jobs over memory controllers.
+ */
+int* _cbuildCpus = NULL;
+unsigned long long _cbuildCpusCount = 0;
+
+/**
+ * Parses a size with an optional K, M, G or T suffix. Returns 0 if it is
+ * not a valid size.
+ */
+unsigned long long _parseSize(const char* const text)
+{
+	char* end = NULL;
+	const unsigned long long size = strtoull(text, &end, 10);
+	const char suffix = end != NULL ? *end : '\0';
+	const unsigned long long scale = suffix == 'K' OR suffix == 'k' ? 1ULL << 10 : suffix == 'M' OR suffix == 'm' ? 1ULL << 20
+		: suffix == 'G' OR suffix == 'g' ? 1ULL << 30 : suffix == 'T' OR suffix == 't' ? 1ULL << 40 : 1;
+
+	if (end == text OR (suffix != '\0' AND (scale == 1 OR end[1] != '\0')))
+	{
+		return 0;
+	}
+
+	return size * scale;
+}
+
+/**
+ * Writes a short value into a cgroup control file. Returns 0 on
+ * success, and -1 otherwise.
+ */
+int _cgroupWrite(const char* const directory, const char* const file, const char* const value)
+{
+	const char* path = PATH(directory, file);
+	const int fd = open(path, O_WRONLY | O_CLOEXEC);
+	free((void*)path);
+
+	if (fd < 0)
+	{
+		return -1;
+	}
+
+	const int result = write(fd, value, strlen(value)) == (ssize_t)strlen(value) ? 0 : -1;
+	close(fd);
+	return result;
+}
+
+/**
+ * Removes the cgroup of this build once all actions are done. Called by
+ * @ref _actionsAbandon after it terminated running actions, since a
+ * cgroup can not be removed while processes are in it.
+ */
+void _cgroupCleanup(void)
+{
+	if (_cbuildCgroupBuild != NULL)
+	{
+		FOREACH_FILE_IN_DIRECTORY(leaf, _cbuildCgroupBuild,
+		{
+			if (strncmp(leaf, "slot", 4) == 0)
+			{
+				const char* path = PATH(_cbuildCgroupBuild, leaf);
+				rmdir(path);
+				free((void*)path);
+			}
+		});
+
+		rmdir(_cbuildCgroupBuild);
+		free((void*)_cbuildCgroupBuild);
+		_cbuildCgroupBuild = NULL;
+	}
+}
+
+/**
+ * Creates the cgroup of this build under @ref _cbuildCgroup and applies
+ * the limits to it. Returns 0 on success, and -1 otherwise.
+ */
+int _cgroupSetup(void)
+{
+	char name[32];
+	sprintf(name, "cbuild.%d", (int)getpid());
+	const char* build = PATH(_cbuildCgroup, name);
+
+	if (mkdir(build, 0755) < 0 AND errno != EEXIST)
+	{
+		free((void*)build);
+		return -1;
+	}
+
+	_cbuildCgroupBuild = build;
+	char value[64];
+
+	if (_cbuildCgroupCpus > 0)
+	{
+		_cgroupWrite(_cbuildCgroup, "cgroup.subtree_control", "+cpu");
+		sprintf(value, "%llu 100000", (unsigned long long)(_cbuildCgroupCpus * 100000));
+
+		if (_cgroupWrite(build, "cpu.max", value) < 0)
+		{
+			return -1;
+		}
+	}
+
+	if (_cbuildCgroupMemory > 0)
+	{
+		_cgroupWrite(_cbuildCgroup, "cgroup.subtree_control", "+memory");
+		sprintf(value, "%llu", _cbuildCgroupMemory);
+
+		if (_cgroupWrite(build, "memory.max", value) < 0)
+		{
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Collects processors this process may run on into @ref _cbuildCpus,
+ * taking them from each NUMA node in turn.
+ */
+void _cpusSetup(void)
+{
+#ifdef __linux__
+	cpu_set_t allowed;
+	CPU_ZERO(&allowed);
+
+	if (sched_getaffinity(0, sizeof(allowed), &allowed) < 0)
+	{
+		return;
+	}
+
+	_cbuildCpus = (int*)malloc(CPU_SETSIZE * sizeof(int));
+	int* nodes = (int*)malloc(CPU_SETSIZE * sizeof(int));
+	int nodesCount = 0;
+
+	for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+	{
+		nodes[cpu] = 0;
+
+		if (CPU_ISSET(cpu, &allowed))
+		{
+			char path[128];
+			sprintf(path, "/sys/devices/system/cpu/cpu%d", cpu);
+
+			FOREACH_FILE_IN_DIRECTORY(entry, path,
+			{
+				if (strncmp(entry, "node", 4) == 0 AND entry[4] >= '0' AND entry[4] <= '9')
+				{
+					nodes[cpu] = atoi(entry + 4);
+				}
+			});
+
+			nodesCount = nodes[cpu] + 1 > nodesCount ? nodes[cpu] + 1 : nodesCount;
+		}
+	}
+
+	for (int round = 0; _cbuildCpusCount < (unsigned long long)CPU_COUNT(&allowed); ++round)
+	{
+		for (int node = 0; node < nodesCount; ++node)
+		{
+			int seen = 0;
+
+			for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+			{
+				if (CPU_ISSET(cpu, &allowed) AND nodes[cpu] == node AND seen++ == round)
+				{
+					_cbuildCpus[_cbuildCpusCount++] = cpu;
+					break;
+				}
+			}
+		}
+	}
+
+	free(nodes);
+#endif
+}
+
+/**
+ * Prepares placement of the action about to be spawned into the worker
+ * slot: its leaf cgroup when @ref _cbuildCgroup is set, and its
+ * processor when @ref _cbuildPin is set. Placement problems are reported
+ * once, and the build continues without it.
+ */
+void _placementPrepare(const long long slot)
+{
+	_cbuildSlot = slot;
+
+	if (_cbuildCgroup != NULL AND _cbuildCgroupBuild == NULL AND NOT _cbuildCgroupFailed AND _cgroupSetup() < 0)
+	{
+#if CBUILD_ECHO_LEVEL >= 1
+		ECHO(stderr, " -- "CBUILD_WARNING_LABEL" Failed to set up cgroup under `%s`, actions are not limited: "CBUILD_WARNING("%s")"\n", _cbuildCgroup, strerror(errno));
+#endif
+
+		_cbuildCgroupFailed = 1;
+	}
+
+	if (_cbuildCgroupBuild != NULL AND NOT _cbuildCgroupFailed)
+	{
+		char leaf[32];
+		sprintf(leaf, "slot%lld", slot);
+		const char* path = PATH(_cbuildCgroupBuild, leaf);
+
+		if (mkdir(path, 0755) < 0 AND errno != EEXIST)
+		{
+#if CBUILD_ECHO_LEVEL >= 1
+			ECHO(stderr, " -- "CBUILD_WARNING_LABEL" Failed to create cgroup `%s`, actions are not limited: "CBUILD_WARNING("%s")"\n", path, strerror(errno));
+#endif
+
+			_cbuildCgroupFailed = 1;
+		}
+
+		free((void*)path);
+	}
+
+	if (_cbuildPin AND _cbuildCpus == NULL)
+	{
+		_cpusSetup();
+	}
+}
+
+/**
+ * Places the calling process, a freshly forked action, into the worker
+ * slot prepared by @ref _placementPrepare, and into a process group of
+ * its own, so it can be terminated with everything it started (see
+ * @ref _terminateGroups). Its output goes to @ref _cbuildSlotOutput
+ * when set.
+ */
+void _placeChild(void)
+{
+	if (_cbuildSlot < 0)
+	{
+		return;
+	}
+
+	setpgid(0, 0);
+
+	if (_cbuildSlotOutput >= 0)
+	{
+		dup2(_cbuildSlotOutput, STDOUT_FILENO);
+		dup2(_cbuildSlotOutput, STDERR_FILENO);
+	}
+
+	if (_cbuildCgroupBuild != NULL AND NOT _cbuildCgroupFailed)
+	{
+		char leaf[32];
+		sprintf(leaf, "slot%lld", _cbuildSlot);
+		_cgroupWrite(PATH(_cbuildCgroupBuild, leaf), "cgroup.procs", "0");
+	}
+
+#ifdef __linux__
+	if (_cbuildPin AND _cbuildCpusCount > 0)
+	{
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+		CPU_SET(_cbuildCpus[_cbuildSlot % _cbuildCpusCount], &cpus);
+		sched_setaffinity(0, sizeof(cpus), &cpus);
+	}
+#endif
+}
+
+/**
+ * @}
+ */
+
+
+
+/**
+ * @addtogroup CMD
+ * 
+ * @{
+ */
+
+#ifndef CBUILD_CACHE_DIRECTORY
+#	define CBUILD_CACHE_DIRECTORY ".cbuild"
+#endif
+
+#ifndef CBUILD_RSP_THRESHOLD
+#	define CBUILD_RSP_THRESHOLD (128 * 1024)
+#endif
+
+/**
+ * Writes arguments into a response file named after the hash of its
+ * content, and returns its path. The content is built in a buffer and
+ * written with a single call. A response file with the same name
+ * already has the same content, so it is reused as is.
+ */
+const char* _rsp(const char* const* argv)
+{
+#ifdef _WIN32
+	assert(!"TODO: implement _rsp with Windows WIN32 API!");
+#else
+	static struct _CBuild_Buffer buffer = { 0 };
+	BUFFER_CLEAR(&buffer);
+
+	for (unsigned long long index = 0; argv[index] != NULL; ++index)
+	{
+		const char* arg = argv[index];
+		_bufferReserve(&buffer, 2 * strlen(arg) + 1);
+
+		for (; *arg != '\0'; ++arg)
+		{
+			if (*arg == '\\' OR *arg == '\'' OR *arg == '"' OR *arg == ' ' OR *arg == '\t' OR *arg == '\n')
+			{
+				buffer.data[buffer.length++] = '\\';
+			}
+
+			buffer.data[buffer.length++] = *arg;
+		}
+
+		buffer.data[buffer.length++] = '\n';
+	}
+
+	char name[32];
+	sprintf(name, "%016llx.rsp", _hash(buffer.data, buffer.length, CBUILD_HASH_SEED));
+	const char* path = PATH(CBUILD_CACHE_DIRECTORY, "rsp", name);
+
+	if (_isfile(path))
+	{
+		return path;
+	}
+
+	if (_writeFile(path, buffer.data, buffer.length) < 0)
+	{
+#if CBUILD_ECHO_LEVEL >= 1
+		ECHO(stderr, CBUILD_ERROR_LABEL" Failed to write response file at path `%s`: "CBUILD_ERROR("%s")"\n", path, strerror(errno));
+#endif
+
+		exit(1);
+	}
+
+	return path;
+#endif
+}
+
+/**
+ * Resolves an executable name through `PATH` environment variable, the
+ * way `execvp` does. Names with a path separator are returned as is.
+ * Returns NULL if nothing is found.
+ */
+const char* _which(const char* const name)
+{
+#ifdef _WIN32
+	assert(!"TODO: implement _which with Windows WIN32 API!");
+#else
+	if (strchr(name, PATH_SEPARATOR[0]) != NULL)
+	{
+		return name;
+	}
+
+	const char* directories = getenv("PATH");
+
+	while (directories != NULL AND *directories != '\0')
+	{
+		const char* end = strchr(directories, ':');
+		const unsigned long long length = end != NULL ? (unsigned long long)(end - directories) : strlen(directories);
+		const char* path = length > 0 ? CONCAT(strndup(directories, length), PATH_SEPARATOR, name) : name;
+
+		if (_isfile(path) AND access(path, X_OK) == 0)
+		{
+			return path;
+		}
+
+		directories = end != NULL ? end + 1 : NULL;
+	}
+
+	return NULL;
+#endif
+}
+
+/**
+ * Returns the argument vector to start a tool that reads `@file`
+ * response files with. When the arguments take more than
+ * @ref CBUILD_RSP_THRESHOLD bytes, they are written into a response file
+ * (see @ref _rsp), and the tool followed by it is returned in rspArgv.
+ * Otherwise argv is returned as is.
+ */
+const char* const* _rspArgv(const char* const* argv, const char* rspArgv[3])
+{
+	unsigned long long argvLength = 0;
+
+	for (unsigned long long index = 0; argv[index] != NULL; ++index)
+	{
+		argvLength += strlen(argv[index]) + 1 + sizeof(char*);
+	}
+
+	if (argvLength <= CBUILD_RSP_THRESHOLD)
+	{
+		return argv;
+	}
+
+	rspArgv[0] = argv[0];
+	rspArgv[1] = CONCAT("@", _rsp(argv + 1));
+	rspArgv[2] = NULL;
+
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Passing arguments through response file `%s`\n", rspArgv[1] + 1);
+#endif
+
+	return rspArgv;
+}
+
+/**
+ * Starts a NULL terminated argument vector as a child process, and
+ * returns its process id without waiting for it. Arguments are passed
+ * as they are, since not every program understands response files (see
+ * @ref _rspArgv). Exits if the child process could not be created.
+ * 
+ * @code{.c}
+ * 		const char* argv[] = { "ls", "-la", NULL };
+ * 		pid_t pid = _spawn(argv);
+ * @endcode
+ */
+pid_t _spawn(const char* const* argv)
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _spawn()\n");
+#endif
+
+#ifdef _WIN32
+	assert(!"TODO: implement _spawn with Windows WIN32 API!");
+#else
+	assert(argv[0] != NULL);
+	fflush(stdout);
+	fflush(stderr);
+	pid_t childProcessId = fork();
+
+	if (childProcessId == -1)
+	{
+#if CBUILD_ECHO_LEVEL >= 1
+		ECHO(stderr, CBUILD_ERROR_LABEL" Failed to fork child process: "CBUILD_ERROR("%s")"\n", strerror(errno));
+#endif
+
+		exit(1);
+	}
+
+	if (childProcessId == 0)
+	{
+		_placeChild();
+
+		if (execvp(argv[0], (char* const *)argv) < 0)
+		{
+#if CBUILD_ECHO_LEVEL >= 1
+			ECHO(stderr, CBUILD_ERROR_LABEL" Failed to execute child process: "CBUILD_ERROR("%s")"\n", strerror(errno));
+#endif
+
+			_exit(127);
+		}
+	}
+
+	return childProcessId;
+#endif
+}
+
+/**
+ * Seconds terminated children get to exit after SIGTERM before they are
+ * killed (see @ref _terminateGroups).
+ */
+#ifndef CBUILD_TERMINATE_TIMEOUT
+#	define CBUILD_TERMINATE_TIMEOUT 3
+#endif
+
+/**
+ * Last of SIGINT, SIGTERM or SIGHUP received since @ref _cancelSetup,
+ * or 0, and how many of them were received.
+ */
+volatile sig_atomic_t _cbuildCancelled = 0;
+volatile sig_atomic_t _cbuildCancelCount = 0;
+
+/**
+ * Records the signal, leaving it to the waiting code to stop the build.
+ */
+void _cancelHandler(const int signal)
+{
+	_cbuildCancelled = signal;
+	++_cbuildCancelCount;
+}
+
+/**
+ * Lets SIGINT, SIGTERM and SIGHUP stop the build gracefully instead of
+ * killing it on the spot: they interrupt waiting for children, which
+ * then terminates running actions, cleans up after them and exits (see
+ * @ref _cancelExit). Called before the first action starts.
+ */
+void _cancelSetup(void)
+{
+#ifdef _WIN32
+	assert(!"TODO: implement _cancelSetup with Windows WIN32 API!");
+#else
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = _cancelHandler;
+	sigemptyset(&action.sa_mask);
+	sigaction(SIGINT, &action, NULL);
+	sigaction(SIGTERM, &action, NULL);
+	sigaction(SIGHUP, &action, NULL);
+#endif
+}
+
+/**
+ * Exits with the status of a process killed by the received signal, so
+ * handlers registered with `atexit` clean up on the way.
+ */
+void _cancelExit(void)
+{
+#if CBUILD_ECHO_LEVEL >= 1
+	ECHO(stderr, CBUILD_ERROR_LABEL" Interrupted by signal "CBUILD_ERROR("%d")", stopping.\n", (int)_cbuildCancelled);
+#endif
+
+	exit(128 + _cbuildCancelled);
+}
+
+/**
+ * Terminates children started in their own process groups: sends
+ * SIGTERM to every group, gives them @ref CBUILD_TERMINATE_TIMEOUT
+ * seconds to exit (cut short by another interrupt), kills the remaining
+ * ones, and reaps all of them.
+ */
+void _terminateGroups(const pid_t* const pids, const unsigned long long count)
+{
+#ifdef _WIN32
+	assert(!"TODO: implement _terminateGroups with Windows WIN32 API!");
+#else
+	int* reaped = (int*)calloc(count + 1, sizeof(int));
+	unsigned long long remaining = count;
+	const int interrupts = _cbuildCancelCount;
+	struct timespec deadline;
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	deadline.tv_sec += CBUILD_TERMINATE_TIMEOUT;
+
+	for (unsigned long long index = 0; index < count; ++index)
+	{
+		if (kill(-pids[index], SIGTERM) < 0)
+		{
+			kill(pids[index], SIGTERM);
+		}
+	}
+
+	while (remaining > 0 AND _cbuildCancelCount == interrupts)
+	{
+		for (unsigned long long index = 0; index < count; ++index)
+		{
+			if (NOT reaped[index] AND waitpid(pids[index], NULL, WNOHANG) == pids[index])
+			{
+				reaped[index] = 1;
+				--remaining;
+			}
+		}
+
+		struct timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+
+		if (remaining == 0 OR now.tv_sec > deadline.tv_sec OR (now.tv_sec == deadline.tv_sec AND now.tv_nsec >= deadline.tv_nsec))
+		{
+			break;
+		}
+
+		const struct timespec pause = { 0, 10000000 };
+		nanosleep(&pause, NULL);
+	}
+
+	for (unsigned long long index = 0; index < count; ++index)
+	{
+		if (NOT reaped[index])
+		{
+			if (kill(-pids[index], SIGKILL) < 0)
+			{
+				kill(pids[index], SIGKILL);
+			}
+
+			while (waitpid(pids[index], NULL, 0) < 0 AND errno == EINTR);
+		}
+	}
+
+	free(reaped);
+#endif
+}
+
+/**
+ * Reports how a child process finished, given its wait status. Returns
+ * 0 if it exited successfully, and 1 otherwise.
+ */
+int _childStatus(const int status)
+{
+	if (WIFEXITED(status))
+	{
+		const int exitStatus = WEXITSTATUS(status);
+
+		if (exitStatus != 0)
+		{
+#if CBUILD_ECHO_LEVEL >= 1
+			ECHO(stderr, CBUILD_ERROR_LABEL" Child process exited with code "CBUILD_ERROR("%d")"\n", exitStatus);
+#endif
+
+			return 1;
+		}
+
+		return 0;
+	}
+
+#if CBUILD_ECHO_LEVEL >= 1
+	ECHO(stderr, CBUILD_ERROR_LABEL" Child process was terminated by "CBUILD_ERROR("%d")" signal\n", WTERMSIG(status));
+#endif
+
+	return 1;
+}
+
+/**
+ * Waits for a child process started by @ref _spawn to finish. Returns
+ * 0 if it exited successfully, and 1 otherwise (see @ref _childStatus).
+ * Exits if the build was interrupted meanwhile (see @ref _cancelSetup).
+ * Forgets all cached modification times, since the child process could
+ * have written any file.
+ */
+int _waitChild(const pid_t childProcessId)
+{
+#ifdef _WIN32
+	assert(!"TODO: implement _waitChild with Windows WIN32 API!");
+#else
+	int status = 0;
+
+	while (waitpid(childProcessId, &status, 0) < 0)
+	{
+		if (errno != EINTR)
+		{
+#if CBUILD_ECHO_LEVEL >= 1
+			ECHO(stderr, CBUILD_ERROR_LABEL" Failed to wait for child process: "CBUILD_ERROR("%s")"\n", strerror(errno));
+#endif
+
+			return 1;
+		}
+	}
+
+	STAT_FORGET_ALL();
+
+	if (_cbuildCancelled != 0)
+	{
+		_cancelExit();
+	}
+
+	return _childStatus(status);
+#endif
+}
+
+/**
+ * Executes a NULL terminated argument vector as a child process and
+ * waits for it to finish. Exits on any failure of the child process.
+ * Arguments are passed as they are (see @ref _spawn).
+ * 
+ * @code{.c}
+ * 		const char* argv[] = { "ls", "-la", NULL };
+ * 		_exec(argv);
+ * @endcode
+ */
+void _exec(const char* const* argv)
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _exec()\n");
+#endif
+
+	_probeEffect();
+
+	if (_waitChild(_spawn(argv)) != 0)
+	{
+		exit(1);
+	}
+}
+
+/**
+ * Wraps @ref _exec function.
+ * 
+ * @code{.c}
+ * 		EXEC(argv);
+ * @endcode
+ */
+#ifndef EXEC
+#	define EXEC(argv) _exec(argv)
+#endif
+
+/**
+ * Executes a NULL terminated argument vector as a child process and
+ * appends everything it writes to standard output and standard error
+ * into buffer. Standard input is `/dev/null`. Unlike @ref _exec, a
+ * failing child process is not fatal: returns its exit code, or -1 if
+ * it could not be started or was terminated by a signal. Like
+ * @ref _waitChild, forgets all cached modification times.
+ * 
+ * @code{.c}
+ * 		struct _CBuild_Buffer output = { 0 };
+ * 		const char* argv[] = { "cc", "--version", NULL };
+ * 		int status = _capture(argv, &output);
+ * @endcode
+ */
+int _capture(const char* const* argv, struct _CBuild_Buffer* const output)
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _capture()\n");
+#endif
+
+#ifdef _WIN32
+	assert(!"TODO: implement _capture with Windows WIN32 API!");
+#else
+	assert(argv[0] != NULL);
+	int pipes[2];
+
+	if (pipe(pipes) < 0)
+	{
+#if CBUILD_ECHO_LEVEL >= 1
+		ECHO(stderr, CBUILD_ERROR_LABEL" Failed to create pipe: "CBUILD_ERROR("%s")"\n", strerror(errno));
+#endif
+
+		return -1;
+	}
+
+	fflush(stdout);
+	fflush(stderr);
+	pid_t childProcessId = fork();
+
+	if (childProcessId == -1)
+	{
+#if CBUILD_ECHO_LEVEL >= 1
+		ECHO(stderr, CBUILD_ERROR_LABEL" Failed to fork child process: "CBUILD_ERROR("%s")"\n", strerror(errno));
+#endif
+
+		close(pipes[0]);
+		close(pipes[1]);
+		return -1;
+	}
+
+	if (childProcessId == 0)
+	{
+		const int input = open("/dev/null", O_RDONLY);
+
+		if (input >= 0)
+		{
+			dup2(input, STDIN_FILENO);
+			close(input);
+		}
+
+		dup2(pipes[1], STDOUT_FILENO);
+		dup2(pipes[1], STDERR_FILENO);
+		close(pipes[0]);
+		close(pipes[1]);
+		execvp(argv[0], (char* const *)argv);
+		_exit(127);
+	}
+
+	close(pipes[1]);
+	char chunk[4096];
+
+	for (;;)
+	{
+		const ssize_t length = read(pipes[0], chunk, sizeof(chunk));
+
+		if (length < 0 AND errno == EINTR)
+		{
+			continue;
+		}
+
+		if (length <= 0)
+		{
+			break;
+		}
+
+		_bufferAppend(output, chunk, length);
+	}
+
+	close(pipes[0]);
+	int status = 0;
+
+	while (waitpid(childProcessId, &status, 0) < 0)
+	{
+		if (errno != EINTR)
+		{
+			return -1;
+		}
+	}
+
+	STAT_FORGET_ALL();
+
+	if (NOT WIFEXITED(status) OR WEXITSTATUS(status) == 127)
+	{
+		return -1;
+	}
+
+	return WEXITSTATUS(status);
+#endif
+}
+
+/**
+ * Wraps @ref _capture function.
+ * 
+ * @code{.c}
+ * 		CAPTURE(argv, &output);
+ * @endcode
+ */
+#ifndef CAPTURE
+#	define CAPTURE(argv, output) _capture(argv, output)
+#endif
+
+/**
+ * Calls a command line command as a child process. It requires the whole
+ * command to be provided either separates or not as a variadic arguments.
+ * Last parameter must be NULL!
+ * 
+ * @code{.c}
+ * 		_cmd("ls", "-la");
+ * 		// or
+ * 		_cmd("ls -la");
+ * @endcode
+ */
+void _cmd(int ignore, ...)
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _cmd()\n");
+#endif
+
+#ifdef _WIN32
+	assert(!"TODO: implement _cmd with Windows WIN32 API!");
+#else
+	static struct _CBuild_Strings argv = { 0 };
+	_stringsClear(&argv);
+	va_list args;
+
+	FOREACH_ARG_IN_VA_ARGS(ignore, const char*, arg, args,
+	{
+		_stringsAppend(&argv, arg);
+	});
+
+	assert(argv.count >= 1);
+	_exec(argv.items);
+#endif
+}
+
+/**
+ * Executes a command built in a strings vector (see @ref _CBuild_Strings).
+ * 
+ * @code{.c}
+ * 		CMD_STRINGS(&command);
+ * @endcode
+ */
+#ifndef CMD_STRINGS
+#	define CMD_STRINGS(strings) _exec((strings)->items)
+#endif
+
+/**
+ * Wraps @ref _cmd function.
+ * 
+ * @code{.c}
+ * 		CMD("ls", "-la");
+ * @endcode
+ */
+#ifndef CMD
+#	define CMD(...) _cmd(0, __VA_ARGS__, NULL)
+#endif
+
+/**
+ * @}
+ */
+
+
+
+/**
+ * @addtogroup READFILE
+ * 
+ * @{
+ */
+
+/**
+ * Reads the whole file into a heap allocated and NULL terminated buffer.
+ * Returns NULL if the file could not be read. Length of the content is
+ * stored into the length parameter, if it is not NULL.
+ * 
+ * @code{.c}
+ * 		unsigned long long length = 0;
+ * 		char* content = _readFile(PATH("folder1", "file.txt"), &length);
+ * @endcode
+ */
+char* _readFile(const char* const path, unsigned long long* length)
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _readFile()\n");
+#endif
+
+#ifdef _WIN32
+	assert(!"TODO: implement _readFile with Windows WIN32 API!");
+#else
+	unsigned long long ahead = 0;
+
+	if (_mapGet(&_cbuildReadAhead, path, &ahead) AND ahead != 0)
+	{
+		struct _CBuild_ReadAhead* read = (struct _CBuild_ReadAhead*)(uintptr_t)ahead;
+		char* content = read->content;
+
+		if (length != NULL)
+		{
+			*length = read->length;
+		}
+
+		free(read);
+		_mapSet(&_cbuildReadAhead, path, 0);
+		return content;
+	}
+
+	const int fd = open(path, O_RDONLY);
+
+	if (fd < 0)
+	{
+		return NULL;
+	}
+
+	struct stat info;
+
+	if (fstat(fd, &info) < 0)
+	{
+		close(fd);
+		return NULL;
+	}
+
+	char* buffer = (char*)malloc((info.st_size + 1) * sizeof(char));
+	unsigned long long total = 0;
+
+	while (total < (unsigned long long)info.st_size)
+	{
+		const ssize_t count = read(fd, buffer + total, info.st_size - total);
+
+		if (count < 0 AND errno == EINTR)
+		{
+			continue;
+		}
+
+		if (count <= 0)
+		{
+			break;
+		}
+
+		total += count;
+	}
+
+	close(fd);
+	buffer[total] = '\0';
+
+	if (length != NULL)
+	{
+		*length = total;
+	}
+
+	return buffer;
+#endif
+}
+
+/**
+ * Wraps @ref _readFile function.
+ * 
+ * @code{.c}
+ * 		char* content = READ_FILE(PATH("folder1", "file.txt"));
+ * @endcode
+ */
+#ifndef READ_FILE
+#	define READ_FILE(path) _readFile(path, NULL)
+#endif
+
+/**
+ * Hashes the content of a file. Returns 0 on success, and -1 if the
+ * file could not be read.
+ */
+int _hashFile(const char* const path, unsigned long long* const hash)
+{
+	unsigned long long length = 0;
+	char* content = _readFile(path, &length);
+
+	if (content == NULL)
+	{
+		return -1;
+	}
+
+	*hash = _hash(content, length, CBUILD_HASH_SEED);
+	free(content);
+	return 0;
+}
+
+/**
+ * @}
+ */
+
+
+
+/**
+ * @addtogroup IOBATCH
+ * 
+ * @{
+ */
+
+/**
+ * Whether batches are submitted through io_uring when the kernel allows
+ * it. Otherwise, or when io_uring is unavailable, they are spread over
+ * @ref CBUILD_IO_THREADS threads.
+ */
+#ifndef CBUILD_IO_URING
+#	if defined(__linux__) && defined(__NR_io_uring_setup) && defined(IORING_OFF_SQ_RING)
+#		define CBUILD_IO_URING 1
+#	else
+#		define CBUILD_IO_URING 0
+#	endif
+#endif
+
+/**
+ * Size of the io_uring submission queue, the most requests in flight.
+ */
+#ifndef CBUILD_IO_DEPTH
+#	define CBUILD_IO_DEPTH 256
+#endif
+
+/**
+ * Threads serving batches without io_uring, 0 or 1 to serve them
+ * sequentially.
+ */
+#ifndef CBUILD_IO_THREADS
+#	define CBUILD_IO_THREADS 8
+#endif
+
+/**
+ * Batches smaller than this are served sequentially, since setting up
+ * the batch would cost more than it saves.
+ */
+#ifndef CBUILD_IO_BATCH_MIN
+#	define CBUILD_IO_BATCH_MIN 4
+#endif
+
+/**
+ * State of a path looked up by @ref _statBatch: its modification time in
+ * nanoseconds, its size, and what it is, -1 if it is missing, and
+ * otherwise 0, 1 or 2 for other, file or directory (as in
+ * @ref _probeState).
+ */
+struct _CBuild_Stat
+{
+	long long mtime;
+	unsigned long long size;
+	int kind;
+};
+
+#if CBUILD_IO_URING
+/**
+ * The io_uring instance of this process, set up on first batch, with
+ * pointers into its mapped rings.
+ */
+struct _CBuild_Ring
+{
+	int fd;
+	pid_t owner;
+	unsigned* sqHead;
+	unsigned* sqTail;
+	unsigned* sqMask;
+	unsigned* sqArray;
+	unsigned* cqHead;
+	unsigned* cqTail;
+	unsigned* cqMask;
+	struct io_uring_sqe* sqes;
+	struct io_uring_cqe* cqes;
+};
+
+/**
+ * Shared by every batch of this process. Its owner is the process that
+ * set it up, or 0 until set up.
+ */
+struct _CBuild_Ring _cbuildRing = { 0 };
+
+/**
+ * Whether io_uring turned out to be unavailable.
+ */
+int _cbuildRingFailed = 0;
+
+/**
+ * Sets up @ref _cbuildRing, unless this process already has one, since
+ * children forked by the build server inherit the ring of the server.
+ * Kernels older than 5.6, lacking file operations in io_uring, are
+ * treated as unavailable. Returns 0 on success, and -1 when io_uring is
+ * unavailable.
+ */
+int _ringSetup(void)
+{
+	if (_cbuildRingFailed)
+	{
+		return -1;
+	}
+
+	if (_cbuildRing.owner == getpid())
+	{
+		return 0;
+	}
+
+	struct io_uring_params params;
+	memset(&params, 0, sizeof(params));
+	const int fd = (int)syscall(__NR_io_uring_setup, CBUILD_IO_DEPTH, &params);
+
+	if (fd < 0 OR NOT (params.features & IORING_FEAT_SINGLE_MMAP) OR NOT (params.features & IORING_FEAT_RW_CUR_POS))
+	{
+#if CBUILD_ECHO_LEVEL >= 2
+		ECHO(stdout, " -- "CBUILD_TRACE_LABEL" io_uring is unavailable, batching with threads\n");
+#endif
+
+		if (fd >= 0)
+		{
+			close(fd);
+		}
+
+		_cbuildRingFailed = 1;
+		return -1;
+	}
+
+	const size_t sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	const size_t cqSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	const size_t ringSize = sqSize > cqSize ? sqSize : cqSize;
+	char* ring = (char*)mmap(NULL, ringSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+	void* sqes = mmap(NULL, params.sq_entries * sizeof(struct io_uring_sqe), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+
+	if (ring == MAP_FAILED OR sqes == MAP_FAILED)
+	{
+		close(fd);
+		_cbuildRingFailed = 1;
+		return -1;
+	}
+
+	_cbuildRing.fd = fd;
+	_cbuildRing.owner = getpid();
+	_cbuildRing.sqHead = (unsigned*)(ring + params.sq_off.head);
+	_cbuildRing.sqTail = (unsigned*)(ring + params.sq_off.tail);
+	_cbuildRing.sqMask = (unsigned*)(ring + params.sq_off.ring_mask);
+	_cbuildRing.sqArray = (unsigned*)(ring + params.sq_off.array);
+	_cbuildRing.cqHead = (unsigned*)(ring + params.cq_off.head);
+	_cbuildRing.cqTail = (unsigned*)(ring + params.cq_off.tail);
+	_cbuildRing.cqMask = (unsigned*)(ring + params.cq_off.ring_mask);
+	_cbuildRing.cqes = (struct io_uring_cqe*)(ring + params.cq_off.cqes);
+	_cbuildRing.sqes = (struct io_uring_sqe*)sqes;
+	return 0;
+}
+
+/**
+ * Submits prepared requests through @ref _cbuildRing, up to
+ * @ref CBUILD_IO_DEPTH at once, and waits for all of them. Results are
+ * stored by `user_data` of the request, which must be its index. Returns
+ * 0 on success, and -1 if the ring failed, in which case no result is
+ * reliable.
+ */
+int _ringRun(const struct io_uring_sqe* const requests, const unsigned long long count, int* const results)
+{
+	unsigned long long submitted = 0;
+
+	while (submitted < count)
+	{
+		const unsigned long long chunk = count - submitted < CBUILD_IO_DEPTH ? count - submitted : CBUILD_IO_DEPTH;
+		unsigned tail = *_cbuildRing.sqTail;
+
+		for (unsigned long long index = 0; index < chunk; ++index, ++tail)
+		{
+			const unsigned slot = tail & *_cbuildRing.sqMask;
+			_cbuildRing.sqes[slot] = requests[submitted + index];
+			_cbuildRing.sqArray[slot] = slot;
+		}
+
+		__atomic_store_n(_cbuildRing.sqTail, tail, __ATOMIC_RELEASE);
+		unsigned long long pending = chunk;
+		unsigned long long toSubmit = chunk;
+
+		while (pending > 0)
+		{
+			const int entered = (int)syscall(__NR_io_uring_enter, _cbuildRing.fd, (unsigned)toSubmit, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+
+			if (entered < 0 AND errno != EINTR AND errno != EAGAIN AND errno != EBUSY)
+			{
+				close(_cbuildRing.fd);
+				_cbuildRingFailed = 1;
+				return -1;
+			}
+
+			toSubmit -= entered > 0 ? (unsigned long long)entered : 0;
+			unsigned head = *_cbuildRing.cqHead;
+
+			while (head != __atomic_load_n(_cbuildRing.cqTail, __ATOMIC_ACQUIRE))
+			{
+				const struct io_uring_cqe* cqe = &_cbuildRing.cqes[head & *_cbuildRing.cqMask];
+				results[cqe->user_data] = cqe->res;
+				++head;
+				--pending;
+			}
+
+			__atomic_store_n(_cbuildRing.cqHead, head, __ATOMIC_RELEASE);
+		}
+
+		submitted += chunk;
+	}
+
+	return 0;
+}
+
+/**
+ * Looks up paths through io_uring, see @ref _statBatch. Returns 0 on
+ * success, and -1 when io_uring is unavailable.
+ */
+int _ringStat(const char* const* paths, const unsigned long long count, struct _CBuild_Stat* const stats)
+{
+	if (_ringSetup() < 0)
+	{
+		return -1;
+	}
+
+	struct io_uring_sqe* requests = (struct io_uring_sqe*)calloc(count, sizeof(struct io_uring_sqe));
+	struct statx* buffers = (struct statx*)calloc(count, sizeof(struct statx));
+	int* results = (int*)malloc(count * sizeof(int));
+
+	for (unsigned long long index = 0; index < count; ++index)
+	{
+		requests[index].opcode = IORING_OP_STATX;
+		requests[index].fd = AT_FDCWD;
+		requests[index].addr = (unsigned long long)(uintptr_t)paths[index];
+		requests[index].len = STATX_TYPE | STATX_MTIME | STATX_SIZE;
+		requests[index].off = (unsigned long long)(uintptr_t)&buffers[index];
+		requests[index].user_data = index;
+	}
+
+	const int result = _ringRun(requests, count, results);
+
+	for (unsigned long long index = 0; index < count AND result == 0; ++index)
+	{
+		stats[index].kind = results[index] < 0 ? -1 : S_ISREG(buffers[index].stx_mode) ? 1 : S_ISDIR(buffers[index].stx_mode) ? 2 : 0;
+		stats[index].mtime = results[index] < 0 ? -1 : buffers[index].stx_mtime.tv_sec * 1000000000LL + buffers[index].stx_mtime.tv_nsec;
+		stats[index].size = results[index] < 0 ? 0 : buffers[index].stx_size;
+	}
+
+	free(results);
+	free(buffers);
+	free(requests);
+	return result;
+}
+
+/**
+ * Reads whole files through io_uring, see @ref _readBatch: opens and
+ * sizes all of them in one round, reads them in the next ones, and
+ * closes them in the last. A file that fails to read is left NULL, like
+ * one that fails to open. Returns 0 on success, and -1 when io_uring is
+ * unavailable.
+ */
+int _ringRead(const char* const* paths, const unsigned long long count, char** const contents, unsigned long long* const lengths)
+{
+	if (_ringSetup() < 0)
+	{
+		return -1;
+	}
+
+	struct io_uring_sqe* requests = (struct io_uring_sqe*)calloc(2 * count, sizeof(struct io_uring_sqe));
+	struct statx* buffers = (struct statx*)calloc(count, sizeof(struct statx));
+	int* results = (int*)malloc(2 * count * sizeof(int));
+	int* fds = (int*)malloc(count * sizeof(int));
+	unsigned long long* indices = (unsigned long long*)malloc(count * sizeof(unsigned long long));
+
+	for (unsigned long long index = 0; index < count; ++index)
+	{
+		requests[2 * index].opcode = IORING_OP_OPENAT;
+		requests[2 * index].fd = AT_FDCWD;
+		requests[2 * index].addr = (unsigned long long)(uintptr_t)paths[index];
+		requests[2 * index].open_flags = O_RDONLY | O_CLOEXEC;
+		requests[2 * index].user_data = 2 * index;
+		requests[2 * index + 1].opcode = IORING_OP_STATX;
+		requests[2 * index + 1].fd = AT_FDCWD;
+		requests[2 * index + 1].addr = (unsigned long long)(uintptr_t)paths[index];
+		requests[2 * index + 1].len = STATX_SIZE;
+		requests[2 * index + 1].off = (unsigned long long)(uintptr_t)&buffers[index];
+		requests[2 * index + 1].user_data = 2 * index + 1;
+	}
+
+	int result = _ringRun(requests, 2 * count, results);
+	unsigned long long reading = 0;
+
+	for (unsigned long long index = 0; index < count; ++index)
+	{
+		fds[index] = result == 0 ? results[2 * index] : -1;
+		contents[index] = NULL;
+		lengths[index] = 0;
+
+		if (fds[index] >= 0 AND results[2 * index + 1] == 0)
+		{
+			contents[index] = (char*)malloc((buffers[index].stx_size + 1) * sizeof(char));
+			indices[reading++] = index;
+		}
+	}
+
+	while (result == 0 AND reading > 0)
+	{
+		memset(requests, 0, reading * sizeof(struct io_uring_sqe));
+
+		for (unsigned long long request = 0; request < reading; ++request)
+		{
+			const unsigned long long index = indices[request];
+			const unsigned long long remaining = buffers[index].stx_size - lengths[index];
+			requests[request].opcode = IORING_OP_READ;
+			requests[request].fd = fds[index];
+			requests[request].addr = (unsigned long long)(uintptr_t)(contents[index] + lengths[index]);
+			requests[request].len = remaining < 0x7ffff000ULL ? (unsigned)remaining : 0x7ffff000U;
+			requests[request].off = lengths[index];
+			requests[request].user_data = request;
+		}
+
+		result = _ringRun(requests, reading, results);
+		unsigned long long unfinished = 0;
+
+		for (unsigned long long request = 0; request < reading AND result == 0; ++request)
+		{
+			const unsigned long long index = indices[request];
+
+			if (results[request] == -EINTR OR results[request] == -EAGAIN)
+			{
+				indices[unfinished++] = index;
+				continue;
+			}
+
+			if (results[request] < 0)
+			{
+				free(contents[index]);
+				contents[index] = NULL;
+				lengths[index] = 0;
+				continue;
+			}
+
+			lengths[index] += (unsigned long long)results[request];
+
+			if (results[request] > 0 AND lengths[index] < buffers[index].stx_size)
+			{
+				indices[unfinished++] = index;
+			}
+		}
+
+		reading = unfinished;
+	}
+
+	unsigned long long closing = 0;
+	memset(requests, 0, count * sizeof(struct io_uring_sqe));
+
+	for (unsigned long long index = 0; index < count; ++index)
+	{
+		if (contents[index] != NULL)
+		{
+			contents[index][lengths[index]] = '\0';
+		}
+
+		if (fds[index] >= 0)
+		{
+			requests[closing].opcode = IORING_OP_CLOSE;
+			requests[closing].fd = fds[index];
+			requests[closing].user_data = closing;
+			++closing;
+		}
+	}
+
+	if (_ringRun(requests, closing, results) < 0)
+	{
+		for (unsigned long long index = 0; index < count; ++index)
+		{
+			if (fds[index] >= 0)
+			{
+				close(fds[index]);
+			}
+		}
+	}
+
+	free(indices);
+	free(fds);
+	free(results);
+	free(buffers);
+	free(requests);
+
+	if (result < 0)
+	{
+		for (unsigned long long index = 0; index < count; ++index)
+		{
+			free(contents[index]);
+			contents[index] = NULL;
+		}
+	}
+
+	return result;
+}
+#endif
+
+/**
+ * Batch served by @ref _ioWorker threads: paths are claimed one by one
+ * through the shared counter, and either looked up into stats, or read
+ * into contents and lengths.
+ */
+struct _CBuild_IoJob
+{
+	const char* const* paths;
+	unsigned long long count;
+	unsigned long long next;
+	struct _CBuild_Stat* stats;
+	char** contents;
+	unsigned long long* lengths;
+};
+
+/**
+ * Looks up the path like @ref _probeState, into the state.
+ */
+void _statOne(const char* const path, struct _CBuild_Stat* const state)
+{
+	struct stat info;
+
+	if (stat(path, &info) == 0)
+	{
+		state->kind = S_ISREG(info.st_mode) ? 1 : S_ISDIR(info.st_mode) ? 2 : 0;
+		state->mtime = (long long)info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec;
+		state->size = info.st_size;
+	}
+	else
+	{
+		state->kind = -1;
+		state->mtime = -1;
+		state->size = 0;
+	}
+}
+
+/**
+ * Serves paths of the batch until none is left.
+ */
+void* _ioWorker(void* const argument)
+{
+	struct _CBuild_IoJob* job = (struct _CBuild_IoJob*)argument;
+	unsigned long long index = 0;
+
+	while ((index = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED)) < job->count)
+	{
+		if (job->stats != NULL)
+		{
+			_statOne(job->paths[index], &job->stats[index]);
+		}
+		else
+		{
+			job->contents[index] = _readFile(job->paths[index], &job->lengths[index]);
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * Serves the batch with up to @ref CBUILD_IO_THREADS threads, the
+ * calling one included, or sequentially when it is small.
+ */
+void _ioThreads(struct _CBuild_IoJob* const job)
+{
+	pthread_t threads[CBUILD_IO_THREADS > 1 ? CBUILD_IO_THREADS - 1 : 1];
+	unsigned long long started = 0;
+
+	for (; job->count >= CBUILD_IO_BATCH_MIN AND started + 1 < CBUILD_IO_THREADS AND started + 1 < job->count; ++started)
+	{
+		if (pthread_create(&threads[started], NULL, _ioWorker, job) != 0)
+		{
+			break;
+		}
+	}
+
+	_ioWorker(job);
+
+	for (unsigned long long index = 0; index < started; ++index)
+	{
+		pthread_join(threads[index], NULL);
+	}
+}
+
+/**
+ * Looks up many paths at once, with io_uring when available and with a
+ * pool of threads otherwise, which on cold caches overlaps the disk
+ * latency of all of them. Symbolic links are followed.
+ * 
+ * @code{.c}
+ * 		struct _CBuild_Stat stats[2];
+ * 		const char* paths[] = { "main.c", "main.o" };
+ * 		_statBatch(paths, 2, stats);
+ * @endcode
+ */
+void _statBatch(const char* const* paths, const unsigned long long count, struct _CBuild_Stat* const stats)
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _statBatch()\n");
+#endif
+
+#ifdef _WIN32
+	assert(!"TODO: implement _statBatch with Windows WIN32 API!");
+#else
+#	if CBUILD_IO_URING
+	if (count >= CBUILD_IO_BATCH_MIN AND _ringStat(paths, count, stats) == 0)
+	{
+		return;
+	}
+#	endif
+
+	struct _CBuild_IoJob job = { paths, count, 0, stats, NULL, NULL };
+	_ioThreads(&job);
+#endif
+}
+
+/**
+ * Reads many whole files at once, like @ref _readFile, with io_uring when
+ * available and with a pool of threads otherwise. Contents are heap
+ * allocated and NULL terminated, or NULL for files that could not be
+ * read.
+ */
+void _readBatch(const char* const* paths, const unsigned long long count, char** const contents, unsigned long long* const lengths)
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _readBatch()\n");
+#endif
+
+#ifdef _WIN32
+	assert(!"TODO: implement _readBatch with Windows WIN32 API!");
+#else
+#	if CBUILD_IO_URING
+	if (count >= CBUILD_IO_BATCH_MIN AND _ringRead(paths, count, contents, lengths) == 0)
+	{
+		return;
+	}
+#	endif
+
+	struct _CBuild_IoJob job = { paths, count, 0, NULL, contents, lengths };
+	_ioThreads(&job);
+#endif
+}
+
+/**
+ * Hashes contents of many files at once, like @ref _hashFile. Results
+ * are 0 for hashed files, and -1 for files that could not be read.
+ */
+void _hashFiles(const char* const* paths, const unsigned long long count, unsigned long long* const hashes, int* const results)
+{
+	char** contents = (char**)malloc((count + 1) * sizeof(char*));
+	unsigned long long* lengths = (unsigned long long*)malloc((count + 1) * sizeof(unsigned long long));
+	_readBatch(paths, count, contents, lengths);
+
+	for (unsigned long long index = 0; index < count; ++index)
+	{
+		results[index] = contents[index] != NULL ? 0 : -1;
+		hashes[index] = contents[index] != NULL ? _hash(contents[index], lengths[index], CBUILD_HASH_SEED) : 0;
+		free(contents[index]);
+	}
+
+	free(lengths);
+	free(contents);
+}
+
+/**
+ * Reads the files in one batch, each kept until the first
+ * @ref _readFile of its path, or until the path is forgotten (see
+ * @ref _statForget). Files already read ahead are skipped.
+ */
+void _readAhead(const char* const* paths, const unsigned long long count)
+{
+	const char** missing = (const char**)malloc((count + 1) * sizeof(const char*));
+	unsigned long long missingCount = 0;
+	struct _CBuild_Map seen = { 0 };
+
+	for (unsigned long long index = 0; index < count; ++index)
+	{
+		unsigned long long ahead = 0;
+
+		if (NOT (_mapGet(&_cbuildReadAhead, paths[index], &ahead) AND ahead != 0) AND NOT _mapGet(&seen, paths[index], NULL))
+		{
+			_mapSet(&seen, paths[index], 0);
+			missing[missingCount++] = paths[index];
+		}
+	}
+
+	_mapFree(&seen);
+	char** contents = (char**)malloc((missingCount + 1) * sizeof(char*));
+	unsigned long long* lengths = (unsigned long long*)malloc((missingCount + 1) * sizeof(unsigned long long));
+	_readBatch(missing, missingCount, contents, lengths);
+
+	for (unsigned long long index = 0; index < missingCount; ++index)
+	{
+		struct _CBuild_ReadAhead* read = (struct _CBuild_ReadAhead*)malloc(sizeof(struct _CBuild_ReadAhead));
+		read->content = contents[index];
+		read->length = lengths[index];
+		_mapSet(&_cbuildReadAhead, missing[index], (unsigned long long)(uintptr_t)read);
+	}
+
+	free(lengths);
+	free(contents);
+	free(missing);
+}
+
+/**
+ * Looks up modification times of the paths in one batch into
+ * @ref _cbuildStatCache, so the staleness checks that follow are
+ * answered without a system call each. Paths already cached are
+ * skipped, and looked up ones are reported to the build server. The
+ * times are kept until the next action finishes.
+ */
+void _statPrefetch(const char* const* paths, const unsigned long long count)
+{
+	const char** missing = (const char**)malloc((count + 1) * sizeof(const char*));
+	unsigned long long missingCount = 0;
+	struct _CBuild_Map seen = { 0 };
+
+	for (unsigned long long index = 0; index < count; ++index)
+	{
+		unsigned long long cached = 0;
+
+		if (NOT (_mapGet(&_cbuildStatCache, paths[index], &cached) AND cached != 0) AND NOT _mapGet(&seen, paths[index], NULL))
+		{
+			_mapSet(&seen, paths[index], 0);
+			missing[missingCount++] = paths[index];
+		}
+	}
+
+	_mapFree(&seen);
+
+	if (missingCount >= CBUILD_IO_BATCH_MIN)
+	{
+		struct _CBuild_Stat* stats = (struct _CBuild_Stat*)malloc(missingCount * sizeof(struct _CBuild_Stat));
+		_statBatch(missing, missingCount, stats);
+
+		for (unsigned long long index = 0; index < missingCount; ++index)
+		{
+			_mapSet(&_cbuildStatCache, missing[index], (unsigned long long)(stats[index].mtime + 2));
+			_mapSet(&_cbuildStatPrefetched, missing[index], 0);
+			_statReport(missing[index], stats[index].mtime);
+		}
+
+		free(stats);
+	}
+
+	free(missing);
+}
+
+/**
+ * @}
+ */
+
+
+
+/**
+ * @addtogroup ACTION
+ * 
+ * @{
+ */
+
+#ifndef CBUILD_STAMP_EXTENSION
+#	define CBUILD_STAMP_EXTENSION ".cmd"
+#endif
+
+/**
+ * When set, the reason is reported for every stale action.
+ */
+int _cbuildExplain = 0;
+
+/**
+ * NULL terminated command line arguments of the tool (without the
+ * program itself), as seen by @ref _options.
+ */
+const char** _cbuildArguments = NULL;
+
+/**
+ * NULL terminated arguments left for the build script by @ref _options.
+ */
+const char* const* _cbuildScriptArguments = NULL;
+
+/**
+ * Unix socket of the executor hermetic actions are sent to (see
+ * @ref _hermeticRun), or NULL to run them locally.
+ */
+const char* _cbuildExecutor = NULL;
+
+/**
+ * Root of the artifact store shared by build trees (see
+ * @ref _storeFetch), or NULL when it is disabled. Set by `--store DIR`
+ * or by `CBUILD_STORE` environment variable.
+ */
+const char* _cbuildStore = NULL;
+
+/**
+ * Socket the build server listens on (see @ref _serve), set by
+ * `--server SOCKET`, or NULL.
+ */
+const char* _cbuildServer = NULL;
+
+/**
+ * Socket of the build server runs are forwarded to (see
+ * @ref _serverForward), set by `--connect SOCKET` or by `CBUILD_SERVER`
+ * environment variable, or NULL.
+ */
+const char* _cbuildConnect = NULL;
+
+/**
+ * Shard of the tests to run (see @ref _runTests), counted from 1, and
+ * the number of shards. Set by `--shard I/N`.
+ */
+unsigned long long _cbuildShard = 1;
+unsigned long long _cbuildShards = 1;
+
+/**
+ * Maximum number of actions running at once (see @ref _actionSubmit),
+ * 0 means one per online processor.
+ */
+#ifndef CBUILD_JOBS
+#	define CBUILD_JOBS 0
+#endif
+
+unsigned long long _cbuildJobs = CBUILD_JOBS;
+
+/**
+ * Number of failed actions after which the build stops, terminating the
+ * running ones, set by `--keep-going N`. 0 means the build goes on with
+ * all actions that do not depend on a failed one. Either way, it fails
+ * once the actions are waited for (see @ref _actionsWait).
+ */
+#ifndef CBUILD_KEEP_GOING
+#	define CBUILD_KEEP_GOING 1
+#endif
+
+unsigned long long _cbuildKeepGoing = CBUILD_KEEP_GOING;
+
+/**
+ * Whether progress of actions is displayed (see @ref _progressRender):
+ * 1 to display it as a status line on a terminal and as occasional
+ * plain lines otherwise, and 0 not to. Cleared by `--no-progress`.
+ */
+#ifndef CBUILD_PROGRESS
+#	define CBUILD_PROGRESS 1
+#endif
+
+int _cbuildProgress = CBUILD_PROGRESS;
+
+/**
+ * Outputs of actions that failed, or were skipped because one of their
+ * inputs failed, and how many actions failed.
+ */
+struct _CBuild_Map _cbuildFailed = { 0 };
+unsigned long long _cbuildFailures = 0;
+
+/**
+ * Outputs of actions skipped by dry run. They count as changed inputs
+ * for all later actions.
+ */
+struct _CBuild_Map _cbuildPending = { 0 };
+
+/**
+ * Consumes options handled by the library itself from the command line
+ * arguments, leaving the rest for the build script:
+ * 
+ * - `--dry-run`: print actions that would be executed, without running them.
+ * - `--explain`: print why each action is executed.
+ * - `--jobs N` / `-j N`: run at most N actions at once.
+ * - `--keep-going N` / `-k N`: stop only after N actions failed, 0 for
+ *   never.
+ * - `--no-progress`: do not display progress of actions.
+ * - `--executor SOCKET`: send hermetic actions to the executor.
+ * - `--store DIR`: share action outputs through the store in DIR,
+ *   which defaults to `CBUILD_STORE` environment variable.
+ * - `--server SOCKET`: keep serving builds on the socket.
+ * - `--connect SOCKET`: forward the build to the server on the socket,
+ *   which defaults to `CBUILD_SERVER` environment variable.
+ * - `--shard I/N`: run only the I-th of N shards of the tests.
+ * - `--cgroup DIR`: run actions in a cgroup created under the delegated
+ *   cgroup v2 directory DIR, limited by `--cpus N` processors and
+ *   `--memory SIZE` bytes (with K, M or G suffix).
+ * - `--pin`: pin every worker slot to its own processor.
+ * 
+ * Arguments are expected without the program, as left by @ref _shift.
+ * 
+ * @code{.c}
+ * 		const char* program = _shift(&argc, &argv);
+ * 		_options(&argc, argv);
+ * @endcode
+ */
+void _options(int* const argc, char** const argv)
+{
+	if (_cbuildStore == NULL AND getenv("CBUILD_STORE") != NULL AND getenv("CBUILD_STORE")[0] != '\0')
+	{
+		_cbuildStore = getenv("CBUILD_STORE");
+	}
+
+	if (_cbuildConnect == NULL AND getenv("CBUILD_SERVER") != NULL AND getenv("CBUILD_SERVER")[0] != '\0')
+	{
+		_cbuildConnect = getenv("CBUILD_SERVER");
+	}
+
+	_cbuildArguments = (const char**)malloc((*argc + 1) * sizeof(const char*));
+	int kept = 0;
+
+	for (int index = 0; index < *argc; ++index)
+	{
+		_cbuildArguments[index] = argv[index];
+
+		if (STREQL(argv[index], "--dry-run"))
+		{
+			_cbuildDryRun = 1;
+		}
+		else if (STREQL(argv[index], "--explain"))
+		{
+			_cbuildExplain = 1;
+		}
+		else if (STREQL(argv[index], "--no-progress"))
+		{
+			_cbuildProgress = 0;
+		}
+		else if ((STREQL(argv[index], "--jobs") OR STREQL(argv[index], "-j")) AND index + 1 < *argc)
+		{
+			_cbuildArguments[index + 1] = argv[index + 1];
+			_cbuildJobs = strtoull(argv[++index], NULL, 10);
+		}
+		else if ((STREQL(argv[index], "--keep-going") OR STREQL(argv[index], "-k")) AND index + 1 < *argc)
+		{
+			_cbuildArguments[index + 1] = argv[index + 1];
+			_cbuildKeepGoing = strtoull(argv[++index], NULL, 10);
+		}
+		else if (STREQL(argv[index], "--executor") AND index + 1 < *argc)
+		{
+			_cbuildArguments[index + 1] = argv[index + 1];
+			_cbuildExecutor = argv[++index];
+		}
+		else if (STREQL(argv[index], "--store") AND index + 1 < *argc)
+		{
+			_cbuildArguments[index + 1] = argv[index + 1];
+			_cbuildStore = argv[++index];
+		}
+		else if (STREQL(argv[index], "--server") AND index + 1 < *argc)
+		{
+			_cbuildArguments[index + 1] = argv[index + 1];
+			_cbuildServer = argv[++index];
+		}
+		else if (STREQL(argv[index], "--connect") AND index + 1 < *argc)
+		{
+			_cbuildArguments[index + 1] = argv[index + 1];
+			_cbuildConnect = argv[++index];
+		}
+		else if (STREQL(argv[index], "--shard") AND index + 1 < *argc)
+		{
+			_cbuildArguments[index + 1] = argv[index + 1];
+
+			if (sscanf(argv[++index], "%llu/%llu", &_cbuildShard, &_cbuildShards) != 2 OR _cbuildShards == 0 OR _cbuildShard == 0 OR _cbuildShard > _cbuildShards)
+			{
+#if CBUILD_ECHO_LEVEL >= 1
+				ECHO(stderr, CBUILD_ERROR_LABEL" Invalid shard "CBUILD_ERROR("`%s`")", expected I/N with 1 <= I <= N\n", argv[index]);
+#endif
+
+				exit(1);
+			}
+		}
+		else if (STREQL(argv[index], "--cgroup") AND index + 1 < *argc)
+		{
+			_cbuildArguments[index + 1] = argv[index + 1];
+			_cbuildCgroup = argv[++index];
+		}
+		else if (STREQL(argv[index], "--cpus") AND index + 1 < *argc)
+		{
+			_cbuildArguments[index + 1] = argv[index + 1];
+
+			if ((_cbuildCgroupCpus = strtod(argv[++index], NULL)) <= 0)
+			{
+#if CBUILD_ECHO_LEVEL >= 1
+				ECHO(stderr, CBUILD_ERROR_LABEL" Invalid processor count "CBUILD_ERROR("`%s`")"\n", argv[index]);
+#endif
+
+				exit(1);
+			}
+		}
+		else if (STREQL(argv[index], "--memory") AND index + 1 < *argc)
+		{
+			_cbuildArguments[index + 1] = argv[index + 1];
+
+			if ((_cbuildCgroupMemory = _parseSize(argv[++index])) == 0)
+			{
+#if CBUILD_ECHO_LEVEL >= 1
+				ECHO(stderr, CBUILD_ERROR_LABEL" Invalid memory size "CBUILD_ERROR("`%s`")"\n", argv[index]);
+#endif
+
+				exit(1);
+			}
+		}
+		else if (STREQL(argv[index], "--pin"))
+		{
+			_cbuildPin = 1;
+		}
+		else
+		{
+			argv[kept++] = argv[index];
+		}
+	}
+
+	_cbuildArguments[*argc] = NULL;
+	argv[kept] = NULL;
+	*argc = kept;
+	_cbuildScriptArguments = (const char* const*)argv;
+}
+
+/**
+ * Wraps @ref _options function.
+ * 
+ * @code{.c}
+ * 		OPTIONS(argc, argv);
+ * @endcode
+ */
+#ifndef OPTIONS
+#	define OPTIONS(argc, argv) _options(&(argc), argv)
+#endif
+
+/**
+ * Prints the argument vector as a shell-like command line.
+ */
+void _echoCommand(FILE* const stream, const char* const* argv)
+{
+	for (unsigned long long index = 0; argv[index] != NULL; ++index)
+	{
+		const int quoted = argv[index][0] == '\0' OR strpbrk(argv[index], " \t\"'\\$") != NULL;
+		ECHO(stream, quoted ? "%s'%s'" : "%s%s", index > 0 ? " " : "", argv[index]);
+	}
+
+	ECHO(stream, "\n");
+}
+
+#define CBUILD_ACTION_COMMAND 0
+#define CBUILD_ACTION_COMPILE 1
+#define CBUILD_ACTION_PCH 2
+#define CBUILD_ACTION_ARCHIVE 3
+#define CBUILD_ACTION_LINK 4
+
+/**
+ * Describes a single command producing an output from its inputs. The
+ * inputs and argument vector are NULL terminated. The depfile is a make
+ * style dependency file written by the command (can be NULL), and lists
+ * additional inputs discovered during the previous run. The kind is one
+ * of CBUILD_ACTION_* values; compile actions have their source as the
+ * first input, and archive actions have their output removed before
+ * running, since archivers only add members to an existing archive.
+ */
+struct _CBuild_Action
+{
+	const char* output;
+	const char* depfile;
+	const char** inputs;
+	const char** argv;
+	int kind;
+};
+
+/**
+ * Every action passed to @ref _actionRun in this run, in order, whether
+ * it was executed or found up to date.
+ */
+struct _CBuild_Graph
+{
+	struct _CBuild_Action* actions;
+	unsigned long long count;
+	unsigned long long capacity;
+	struct _CBuild_Arena arena;
+};
+
+struct _CBuild_Graph _cbuildGraph = { 0 };
+
+/**
+ * Copies NULL terminated array of strings into the arena.
+ */
+const char** _arenaStrdupv(struct _CBuild_Arena* const arena, const char* const* strings)
+{
+	unsigned long long count = 0;
+
+	while (strings != NULL AND strings[count] != NULL)
+	{
+		++count;
+	}
+
+	const char** copy = (const char**)_arenaAlloc(arena, (count + 1) * sizeof(const char*));
+
+	for (unsigned long long index = 0; index < count; ++index)
+	{
+		copy[index] = _arenaStrdup(arena, strings[index]);
+	}
+
+	copy[count] = NULL;
+	return copy;
+}
+
+/**
+ * Records a copy of the action in the graph.
+ */
+void _graphAdd(struct _CBuild_Graph* const graph, const struct _CBuild_Action* const action)
+{
+	if (graph->count == graph->capacity)
+	{
+		graph->capacity = graph->capacity > 0 ? 2 * graph->capacity : 64;
+		graph->actions = (struct _CBuild_Action*)realloc(graph->actions, graph->capacity * sizeof(struct _CBuild_Action));
+	}
+
+	struct _CBuild_Action* copy = &graph->actions[graph->count++];
+	copy->output = _arenaStrdup(&graph->arena, action->output);
+	copy->depfile = action->depfile != NULL ? _arenaStrdup(&graph->arena, action->depfile) : NULL;
+	copy->inputs = _arenaStrdupv(&graph->arena, action->inputs);
+	copy->argv = _arenaStrdupv(&graph->arena, action->argv);
+	copy->kind = action->kind;
+}
+
+/**
+ * Returns modification time of the path in nanoseconds, or -1 if the
+ * path does not exist. Answered from @ref _cbuildStatCache when the
+ * build server knows it, otherwise looked up and reported to the server.
+ */
+long long _mtime(const char* const path)
+{
+#ifdef _WIN32
+	assert(!"TODO: implement _mtime with Windows WIN32 API!");
+#else
+	unsigned long long cached = 0;
+
+	if (_mapGet(&_cbuildStatCache, path, &cached) AND cached != 0)
+	{
+		return (long long)cached - 2;
+	}
+
+	struct stat info;
+	const long long mtime = stat(path, &info) < 0 ? -1 : (long long)info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec;
+	_statReport(path, mtime);
+	return mtime;
+#endif
+}
+
+/**
+ * Parses content of a make style dependency file, as written by
+ * `-MMD -MF`, and returns a NULL terminated array of prerequisites of its
+ * first rule.
+ */
+const char** _depfileParse(const char* const content)
+{
+	unsigned long long capacity = 16;
+	unsigned long long count = 0;
+	const char** inputs = (const char**)malloc(capacity * sizeof(const char*));
+	const char* character = content;
+
+	while (*character != '\0' AND NOT (*character == ':' AND (character[1] == ' ' OR character[1] == '\t' OR character[1] == '\n' OR character[1] == '\r' OR character[1] == '\0')))
+	{
+		++character;
+	}
+
+	if (*character == ':')
+	{
+		++character;
+	}
+
+	char* token = (char*)malloc((strlen(content) + 1) * sizeof(char));
+	unsigned long long length = 0;
+
+	for (;; ++character)
+	{
+		const char current = *character;
+		int separator = current == '\0' OR current == ' ' OR current == '\t' OR current == '\n' OR current == '\r';
+
+		if (current == '\\' AND (character[1] == '\n' OR character[1] == '\r'))
+		{
+			separator = 1;
+			character += character[1] == '\r' AND character[2] == '\n' ? 2 : 1;
+		}
+		else if (current == '\\' AND (character[1] == ' ' OR character[1] == '#'))
+		{
+			token[length++] = *++character;
+			continue;
+		}
+		else if (current == '$' AND character[1] == '$')
+		{
+			token[length++] = *++character;
+			continue;
+		}
+
+		if (NOT separator)
+		{
+			token[length++] = current;
+			continue;
+		}
+
+		if (length > 0)
+		{
+			if (count + 1 >= capacity)
+			{
+				capacity *= 2;
+				inputs = (const char**)realloc(inputs, capacity * sizeof(const char*));
+			}
+
+			token[length] = '\0';
+			inputs[count++] = strdup(token);
+			length = 0;
+		}
+
+		if (current == '\0' OR current == '\n')
+		{
+			break;
+		}
+	}
+
+	inputs[count] = NULL;
+	free(token);
+	return inputs;
+}
+
+/**
+ * Reads a make style dependency file and returns a NULL terminated array
+ * of prerequisites of its first rule (see @ref _depfileParse). Returns
+ * NULL if the file could not be read.
+ */
+const char** _depfileInputs(const char* const depfile)
+{
+	char* content = _readFile(depfile, NULL);
+
+	if (content == NULL)
+	{
+		return NULL;
+	}
+
+	const char** inputs = _depfileParse(content);
+	free(content);
+	return inputs;
+}
+
+/**
+ * Hashes NULL terminated argument vector of an action.
+ */
+unsigned long long _argvHash(const char* const* argv)
+{
+	unsigned long long hash = CBUILD_HASH_SEED;
+
+	for (unsigned long long index = 0; argv[index] != NULL; ++index)
+	{
+		hash = _hash(argv[index], strlen(argv[index]) + 1, hash);
+	}
+
+	return hash;
+}
+
+/**
+ * Checks whether inputs of a link action have the content recorded in
+ * its stamp by @ref _actionStamp. Recompiling an object often produces
+ * the very same bytes, which does not need relinking. Only inputs whose
+ * modification time differs from the recorded one are hashed; if all of
+ * them still match, their new times are recorded in the stamp, so they
+ * are not hashed again.
+ */
+int _actionInputsSame(const struct _CBuild_Action* const action, char* const stamp)
+{
+	struct _CBuild_Map recordedHashes = { 0 };
+	struct _CBuild_Map recordedTimes = { 0 };
+	char* line = strchr(stamp, '\n');
+
+	while (line != NULL AND line[1] != '\0')
+	{
+		char* time = NULL;
+		char* path = NULL;
+		const unsigned long long hash = strtoull(line + 1, &time, 16);
+		const long long mtime = strtoll(time, &path, 10);
+		line = strchr(line + 1, '\n');
+
+		if (*time == ' ' AND path != time AND *path == ' ' AND line != NULL)
+		{
+			*line = '\0';
+			_mapSet(&recordedHashes, path + 1, hash);
+			_mapSet(&recordedTimes, path + 1, (unsigned long long)mtime);
+			*line = '\n';
+		}
+	}
+
+	int same = recordedHashes.count > 0;
+	unsigned long long count = 0;
+
+	for (; action->inputs[count] != NULL AND same; ++count)
+	{
+		same = NOT _mapGet(&_cbuildPending, action->inputs[count], NULL) AND _mapGet(&recordedHashes, action->inputs[count], NULL);
+	}
+
+	const char** changed = (const char**)malloc((count + 1) * sizeof(const char*));
+	unsigned long long* hashes = (unsigned long long*)malloc((count + 1) * sizeof(unsigned long long));
+	int* results = (int*)malloc((count + 1) * sizeof(int));
+	unsigned long long changedCount = 0;
+
+	for (unsigned long long index = 0; index < count AND same; ++index)
+	{
+		unsigned long long recorded = 0;
+		_mapGet(&recordedTimes, action->inputs[index], &recorded);
+
+		if (_mtime(action->inputs[index]) != (long long)recorded)
+		{
+			changed[changedCount++] = action->inputs[index];
+		}
+	}
+
+	if (same)
+	{
+		_hashFiles(changed, changedCount, hashes, results);
+	}
+
+	for (unsigned long long index = 0; index < changedCount AND same; ++index)
+	{
+		unsigned long long expected = 0;
+		_mapGet(&recordedHashes, changed[index], &expected);
+		same = results[index] == 0 AND hashes[index] == expected;
+	}
+
+	if (same AND changedCount > 0 AND NOT _cbuildDryRun)
+	{
+		struct _CBuild_Buffer updated = { 0 };
+		_bufferAppend(&updated, stamp, strchr(stamp, '\n') + 1 - stamp);
+
+		for (unsigned long long index = 0; index < count; ++index)
+		{
+			unsigned long long hash = 0;
+			_mapGet(&recordedHashes, action->inputs[index], &hash);
+			_bufferAppendf(&updated, "%016llx %lld %s\n", hash, _mtime(action->inputs[index]), action->inputs[index]);
+		}
+
+		const char* stampPath = CONCAT(action->output, CBUILD_STAMP_EXTENSION);
+		_writeFile(stampPath, updated.data, updated.length);
+		free((void*)stampPath);
+		BUFFER_FREE(&updated);
+	}
+
+	free(results);
+	free(hashes);
+	free(changed);
+	_mapFree(&recordedHashes);
+	_mapFree(&recordedTimes);
+	return same;
+}
+
+/**
+ * Checks whether the action has to be executed. Returns NULL if the
+ * output is up to date, or a heap allocated reason otherwise. An action
+ * is stale when its output is missing, when its command differs from the
+ * one recorded in `<output>.cmd` stamp, or when any of its inputs, or
+ * inputs listed in its depfile, is newer than the output. Link actions
+ * whose newer inputs still have the content recorded in the stamp are
+ * up to date (see @ref _actionInputsSame). Their output keeps its
+ * modification time, so actions depending on it stay up to date too.
+ */
+const char* _actionStale(const struct _CBuild_Action* const action)
+{
+	const char* stampPath = CONCAT(action->output, CBUILD_STAMP_EXTENSION);
+	char* stamp = _readFile(stampPath, NULL);
+	free((void*)stampPath);
+	const char** discovered = action->depfile != NULL ? _depfileInputs(action->depfile) : NULL;
+	const char** lists[2] = { action->inputs, discovered };
+	struct _CBuild_Strings paths = { 0 };
+	_stringsAppend(&paths, action->output);
+
+	for (unsigned long long list = 0; list < 2; ++list)
+	{
+		for (unsigned long long index = 0; lists[list] != NULL AND lists[list][index] != NULL; ++index)
+		{
+			_stringsAppend(&paths, lists[list][index]);
+		}
+	}
+
+	_statPrefetch(paths.items, paths.count);
+	_stringsFree(&paths);
+	const long long outputTime = _mtime(action->output);
+	char expected[32];
+	sprintf(expected, "%016llx", _argvHash(action->argv));
+
+	if (outputTime < 0)
+	{
+		free(stamp);
+		return CONCAT("output `", action->output, "` does not exist");
+	}
+
+	if (stamp == NULL OR strncmp(stamp, expected, 16) != 0)
+	{
+		free(stamp);
+		return CONCAT("command for `", action->output, "` changed");
+	}
+
+	if (action->depfile != NULL AND discovered == NULL)
+	{
+		free(stamp);
+		return CONCAT("depfile `", action->depfile, "` does not exist");
+	}
+
+	const char* reason = NULL;
+	const char* newer = NULL;
+
+	for (unsigned long long list = 0; list < 2 AND reason == NULL; ++list)
+	{
+		for (unsigned long long index = 0; lists[list] != NULL AND lists[list][index] != NULL AND reason == NULL; ++index)
+		{
+			const char* input = lists[list][index];
+
+			if (_mapGet(&_cbuildPending, input, NULL))
+			{
+				reason = CONCAT("input `", input, "` would be rebuilt");
+				continue;
+			}
+
+			const long long inputTime = _mtime(input);
+
+			if (inputTime < 0)
+			{
+				reason = CONCAT("input `", input, "` does not exist");
+			}
+			else if (inputTime > outputTime AND newer == NULL)
+			{
+				newer = input;
+			}
+		}
+	}
+
+	if (reason == NULL AND newer != NULL)
+	{
+		if (action->kind == CBUILD_ACTION_LINK AND _actionInputsSame(action, stamp))
+		{
+#if CBUILD_ECHO_LEVEL >= 2
+			ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Inputs of `%s` are newer, but unchanged\n", action->output);
+#endif
+		}
+		else
+		{
+			reason = CONCAT("input `", newer, "` is newer than `", action->output, "`");
+		}
+	}
+
+	free(stamp);
+	return reason;
+}
+
+/**
+ * Records command stamp of an executed action. Link actions also record
+ * a content hash and modification time of every input, as
+ * `<hash> <time> <input>` lines (see @ref _actionInputsSame).
+ */
+void _actionStamp(const struct _CBuild_Action* const action)
+{
+	struct _CBuild_Buffer stamp = { 0 };
+	_bufferAppendf(&stamp, "%016llx\n", _argvHash(action->argv));
+	unsigned long long count = 0;
+
+	while (action->kind == CBUILD_ACTION_LINK AND action->inputs[count] != NULL)
+	{
+		++count;
+	}
+
+	unsigned long long* hashes = (unsigned long long*)malloc((count + 1) * sizeof(unsigned long long));
+	int* results = (int*)malloc((count + 1) * sizeof(int));
+	_hashFiles(action->inputs, count, hashes, results);
+
+	for (unsigned long long index = 0; index < count; ++index)
+	{
+		if (results[index] == 0 AND strchr(action->inputs[index], '\n') == NULL)
+		{
+			_bufferAppendf(&stamp, "%016llx %lld %s\n", hashes[index], _mtime(action->inputs[index]), action->inputs[index]);
+		}
+	}
+
+	free(results);
+	free(hashes);
+
+	const char* stampPath = CONCAT(action->output, CBUILD_STAMP_EXTENSION);
+	_writeFile(stampPath, stamp.data, stamp.length);
+	free((void*)stampPath);
+	BUFFER_FREE(&stamp);
+}
+
+#ifndef CBUILD_STORE_MAX_SIZE
+#	define CBUILD_STORE_MAX_SIZE (10ULL * 1024 * 1024 * 1024)
+#endif
+
+#ifndef CBUILD_STORE_MAX_AGE
+#	define CBUILD_STORE_MAX_AGE (30LL * 24 * 60 * 60)
+#endif
+
+#ifndef CBUILD_STORE_GC_INTERVAL
+#	define CBUILD_STORE_GC_INTERVAL (60LL * 60)
+#endif
+
+#ifndef CBUILD_STORE_VARIANTS
+#	define CBUILD_STORE_VARIANTS 16
+#endif
+
+/**
+ * Returns path of an entry in the store, named by its SHA-256 digest in
+ * hex: `<store>/<kind>/<first two hex digits>/<rest>`, so no directory
+ * grows too large. The store is shared by build trees and users, so its
+ * names use a cryptographic digest instead of @ref _hash.
+ */
+const char* _storePath(const char* const kind, const char* const digest)
+{
+	char shard[3] = { digest[0], digest[1], '\0' };
+	return PATH(_cbuildStore, kind, shard, digest + 2);
+}
+
+/**
+ * Places a blob at path as a new file: reflinked if the file system
+ * supports it, and copied otherwise (see @ref _copyContent). Blobs are
+ * never hard linked, since a shared inode would share modification time
+ * between build trees and break staleness checks. The file is created
+ * under a unique name next to path and renamed over it, so readers
+ * never see partial content. Content is verified against the digest
+ * the blob is named by before it is renamed over path, so a corrupted
+ * or forged blob is removed and missed. The blob is touched to mark its
+ * last use. Returns 0 on success, and -1 otherwise.
+ */
+int _storeLink(const char* const blob, const char* const digest, const char* const path, const mode_t mode)
+{
+#ifdef _WIN32
+	assert(!"TODO: implement _storeLink with Windows WIN32 API!");
+#else
+	char* temporary = (char*)CONCAT(path, ".tmp.XXXXXX");
+	const int input = open(blob, O_RDONLY | O_CLOEXEC);
+	struct stat info;
+	const int output = input >= 0 AND fstat(input, &info) == 0 AND _ensureParent(path) == 0 ? mkstemp(temporary) : -1;
+
+	if (output < 0)
+	{
+		if (input >= 0)
+		{
+			close(input);
+		}
+
+		free(temporary);
+		return -1;
+	}
+
+	fcntl(output, F_SETFD, FD_CLOEXEC);
+	int result = fchmod(output, mode) == 0 ? _copyContent(input, output, info.st_size) : -1;
+	close(input);
+
+	if (close(output) < 0)
+	{
+		result = -1;
+	}
+
+	if (result == 0)
+	{
+		struct _CBuild_Sha256 content;
+		char hex[65];
+		_sha256Init(&content);
+		result = _sha256File(&content, temporary);
+		_sha256Hex(&content, hex);
+
+		if (result == 0 AND NOT STREQL(hex, digest))
+		{
+#if CBUILD_ECHO_LEVEL >= 1
+			ECHO(stderr, CBUILD_WARNING_LABEL" Store blob `%s` does not match its digest, removing it.\n", blob);
+#endif
+
+			unlink(blob);
+			result = -1;
+		}
+	}
+
+	if (result == 0 AND rename(temporary, path) < 0)
+	{
+		result = -1;
+	}
+
+	if (result < 0)
+	{
+		unlink(temporary);
+	}
+	else
+	{
+		STAT_FORGET(path);
+		utimensat(AT_FDCWD, blob, NULL, 0);
+	}
+
+	free(temporary);
+	return result;
+#endif
+}
+
+/**
+ * Copies a file into the store under the SHA-256 digest of its content,
+ * and writes the digest in hex into digest. Blobs are read only, with
+ * execute permission kept. A blob with the same digest is only
+ * refreshed, since it is the same content. Concurrent writers are safe,
+ * as every writer fills its own uniquely named file and blobs appear
+ * with a single rename. Returns 0 on success, and -1 otherwise.
+ */
+int _storeInsert(const char* const path, char* const digest)
+{
+#ifdef _WIN32
+	assert(!"TODO: implement _storeInsert with Windows WIN32 API!");
+#else
+	struct _CBuild_Sha256 content;
+	struct stat info;
+	_sha256Init(&content);
+
+	if (_sha256File(&content, path) < 0 OR stat(path, &info) < 0)
+	{
+		return -1;
+	}
+
+	_sha256Hex(&content, digest);
+	const char* blob = _storePath("objects", digest);
+
+	if (utimensat(AT_FDCWD, blob, NULL, 0) == 0 OR (errno != ENOENT AND _isfile(blob)))
+	{
+		free((void*)blob);
+		return 0;
+	}
+
+	char* temporary = (char*)CONCAT(blob, ".tmp.XXXXXX");
+	const int input = open(path, O_RDONLY | O_CLOEXEC);
+	const int output = input >= 0 AND _ensureParent(blob) == 0 ? mkstemp(temporary) : -1;
+
+	if (output < 0)
+	{
+		if (input >= 0)
+		{
+			close(input);
+		}
+
+		free(temporary);
+		free((void*)blob);
+		return -1;
+	}
+
+	fcntl(output, F_SETFD, FD_CLOEXEC);
+	int result = fchmod(output, 0444 | (info.st_mode & 0111)) == 0 ? _copyContent(input, output, info.st_size) : -1;
+	close(input);
+
+	if (close(output) < 0)
+	{
+		result = -1;
+	}
+
+	if (result == 0 AND rename(temporary, blob) < 0)
+	{
+		result = -1;
+	}
+
+	if (result < 0)
+	{
+		unlink(temporary);
+	}
+
+	free(temporary);
+	free((void*)blob);
+	return result;
+#endif
+}
+
+/**
+ * Restores outputs recorded under the key digest (see
+ * @ref _storeRecord) into the build tree, and touches the record to mark
+ * its last use. Returns 1 if all of them were restored, and 0 if the
+ * key or any of its blobs is missing or does not match.
+ */
+int _storeRestore(const char* const key, const char* const* outputs)
+{
+	const char* record = _storePath("results", key);
+	char* content = _readFile(record, NULL);
+
+	if (content == NULL)
+	{
+		free((void*)record);
+		return 0;
+	}
+
+	const char* line = content;
+	int restored = 1;
+
+	for (unsigned long long index = 0; outputs[index] != NULL AND restored; ++index)
+	{
+		char digest[65];
+		unsigned int mode = 0;
+		int length = 0;
+
+		if (sscanf(line, "%64[0-9a-f] %o\n%n", digest, &mode, &length) != 2 OR strlen(digest) != 64)
+		{
+			restored = 0;
+			continue;
+		}
+
+		line += length;
+		const char* blob = _storePath("objects", digest);
+		restored = _storeLink(blob, digest, outputs[index], mode) == 0;
+		free((void*)blob);
+	}
+
+	if (restored)
+	{
+		utimensat(AT_FDCWD, record, NULL, 0);
+	}
+
+	free((void*)record);
+	free(content);
+	return restored;
+}
+
+/**
+ * Inserts outputs into the store and records them under the key digest,
+ * as a line with blob digest and mode per output. Returns 0 on success,
+ * and -1 otherwise.
+ */
+int _storeRecord(const char* const key, const char* const* outputs)
+{
+	struct _CBuild_Buffer record = { 0 };
+	int result = 0;
+
+	for (unsigned long long index = 0; outputs[index] != NULL AND result == 0; ++index)
+	{
+		char digest[65];
+		struct stat info;
+
+		if (_storeInsert(outputs[index], digest) < 0 OR stat(outputs[index], &info) < 0)
+		{
+			result = -1;
+			continue;
+		}
+
+		_bufferAppendf(&record, "%s %o\n", digest, (unsigned int)(info.st_mode & 0777));
+	}
+
+	if (result == 0)
+	{
+		const char* path = _storePath("results", key);
+		result = _writeFile(path, record.data, record.length) < 0 ? -1 : 0;
+		free((void*)path);
+	}
+
+	BUFFER_FREE(&record);
+	return result;
+}
+
+/**
+ * Feeds NULL terminated strings into the digest, each with its NUL.
+ */
+void _storeDigestStrings(struct _CBuild_Sha256* const digest, const char* const* strings)
+{
+	for (unsigned long long index = 0; strings != NULL AND strings[index] != NULL; ++index)
+	{
+		_sha256Update(digest, strings[index], strlen(strings[index]) + 1);
+	}
+}
+
+/**
+ * Feeds NULL terminated paths and the SHA-256 digests of the content of
+ * the files into the digest. Returns 0 on success, and -1 if a file
+ * could not be read.
+ */
+int _storeDigestFiles(struct _CBuild_Sha256* const digest, const char* const* paths)
+{
+	for (unsigned long long index = 0; paths != NULL AND paths[index] != NULL; ++index)
+	{
+		struct _CBuild_Sha256 content;
+		char hex[65];
+		_sha256Init(&content);
+
+		if (_sha256File(&content, paths[index]) < 0)
+		{
+			return -1;
+		}
+
+		_sha256Hex(&content, hex);
+		_sha256Update(digest, paths[index], strlen(paths[index]) + 1);
+		_sha256Update(digest, hex, 64);
+	}
+
+	return 0;
+}
+
+/**
+ * Returns NULL terminated outputs of the action: its output and its
+ * depfile, if any.
+ */
+const char** _storeOutputs(const struct _CBuild_Action* const action)
+{
+	const char** outputs = (const char**)calloc(3, sizeof(const char*));
+	outputs[0] = action->output;
+	outputs[1] = action->depfile;
+	return outputs;
+}
+
+/**
+ * Tries to restore outputs of a stale action from the store instead of
+ * running it. Actions are looked up in two steps, as header
+ * dependencies are only known after running: the command and content of
+ * the explicit inputs select a manifest, with a line for every set of
+ * discovered inputs seen before (from depfiles), and the content of
+ * those then selects the result. Both keys are SHA-256 digests. The
+ * manifest is touched on a hit to mark its last use. Returns 1 if
+ * outputs were restored, and 0 otherwise.
+ */
+int _storeFetch(const struct _CBuild_Action* const action)
+{
+	struct _CBuild_Sha256 base;
+	char digest[65];
+	_sha256Init(&base);
+	_storeDigestStrings(&base, action->argv);
+
+	if (_storeDigestFiles(&base, action->inputs) < 0)
+	{
+		return 0;
+	}
+
+	_sha256Hex(&base, digest);
+	const char* manifest = _storePath("manifests", digest);
+	char* content = _readFile(manifest, NULL);
+	int restored = 0;
+
+	for (char* state = NULL, * line = content != NULL ? strtok_r(content, "\n", &state) : NULL; line != NULL AND NOT restored; line = strtok_r(NULL, "\n", &state))
+	{
+		struct _CBuild_Strings discovered = { 0 };
+		_stringsReserve(&discovered, 0);
+
+		for (char* inner = NULL, * path = strtok_r(line + 1, "\t", &inner); path != NULL; path = strtok_r(NULL, "\t", &inner))
+		{
+			_stringsAppend(&discovered, path);
+		}
+
+		struct _CBuild_Sha256 key = base;
+
+		if (_storeDigestFiles(&key, discovered.items) == 0)
+		{
+			const char** outputs = _storeOutputs(action);
+			_sha256Hex(&key, digest);
+			restored = _storeRestore(digest, outputs);
+			free(outputs);
+		}
+
+		_stringsFree(&discovered);
+	}
+
+	if (restored)
+	{
+		utimensat(AT_FDCWD, manifest, NULL, 0);
+	}
+
+	free((void*)manifest);
+	free(content);
+	return restored;
+}
+
+/**
+ * Records outputs of an executed action in the store, under the key
+ * described in @ref _storeFetch, and adds its discovered inputs to the
+ * manifest, keeping the @ref CBUILD_STORE_VARIANTS most recent sets.
+ */
+void _storePut(const struct _CBuild_Action* const action)
+{
+	struct _CBuild_Sha256 base;
+	struct _CBuild_Sha256 key;
+	char digest[65];
+	const char** discovered = action->depfile != NULL ? _depfileInputs(action->depfile) : NULL;
+	_sha256Init(&base);
+	_storeDigestStrings(&base, action->argv);
+
+	if (_storeDigestFiles(&base, action->inputs) < 0)
+	{
+		return;
+	}
+
+	key = base;
+
+	if (_storeDigestFiles(&key, discovered) < 0)
+	{
+		return;
+	}
+
+	const char** outputs = _storeOutputs(action);
+	_sha256Hex(&key, digest);
+
+	if (_storeRecord(digest, outputs) < 0)
+	{
+#if CBUILD_ECHO_LEVEL >= 1
+		ECHO(stderr, CBUILD_WARNING_LABEL" Failed to store outputs of `%s`: "CBUILD_WARNING("%s")"\n", action->output, strerror(errno));
+#endif
+
+		free(outputs);
+		return;
+	}
+
+	free(outputs);
+	struct _CBuild_Buffer variant = { 0 };
+	BUFFER_APPEND(&variant, ">");
+
+	for (unsigned long long index = 0; discovered != NULL AND discovered[index] != NULL; ++index)
+	{
+		_bufferAppendf(&variant, index > 0 ? "\t%s" : "%s", discovered[index]);
+	}
+
+	BUFFER_APPEND(&variant, "\n");
+	_bufferReserve(&variant, 1);
+	variant.data[variant.length] = '\0';
+
+	_sha256Hex(&base, digest);
+	const char* manifest = _storePath("manifests", digest);
+	char* content = _readFile(manifest, NULL);
+
+	if (content == NULL OR strstr(content, variant.data) == NULL)
+	{
+		const char* rest = content != NULL ? content : "";
+		unsigned long long kept = 0;
+		unsigned long long lines = 1;
+
+		while (rest[kept] != '\0' AND lines < CBUILD_STORE_VARIANTS)
+		{
+			const char* end = strchr(rest + kept, '\n');
+			kept = end != NULL ? (unsigned long long)(end + 1 - rest) : strlen(rest);
+			++lines;
+		}
+
+		const struct iovec parts[] = { { variant.data, variant.length }, { (void*)rest, kept } };
+		_writeFilev(manifest, parts, 2);
+	}
+
+	free(content);
+	free((void*)manifest);
+	BUFFER_FREE(&variant);
+}
+
+/**
+ * Removes store entries not used for @ref CBUILD_STORE_MAX_AGE seconds,
+ * and then the least recently used ones until the store is below 90% of
+ * @ref CBUILD_STORE_MAX_SIZE. Blobs, results and manifests are touched
+ * on every use, so their modification time is the last use. Only one
+ * collection runs at a time, guarded by `flock` on `<store>/lock`.
+ * Readers need no lock: a blob removed under them is a cache miss.
+ */
+void _storeGc(void)
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _storeGc()\n");
+#endif
+
+#ifdef _WIN32
+	assert(!"TODO: implement _storeGc with Windows WIN32 API!");
+#else
+	if (_cbuildStore == NULL OR _ensureDir(_cbuildStore) < 0)
+	{
+		return;
+	}
+
+	const char* lockPath = PATH(_cbuildStore, "lock");
+	const int lock = open(lockPath, O_RDWR | O_CREAT | O_CLOEXEC, 0666);
+	free((void*)lockPath);
+
+	if (lock < 0 OR flock(lock, LOCK_EX | LOCK_NB) < 0)
+	{
+		if (lock >= 0)
+		{
+			close(lock);
+		}
+
+		return;
+	}
+
+	struct _CBuild_Strings paths = { 0 };
+	unsigned long long capacity = 0;
+	long long* times = NULL;
+	unsigned long long* sizes = NULL;
+	unsigned long long total = 0;
+	const long long oldest = (long long)time(NULL) - CBUILD_STORE_MAX_AGE;
+	const char* kinds[] = { "objects", "results", "manifests" };
+
+	for (unsigned long long kind = 0; kind < 3; ++kind)
+	{
+		const char* root = PATH(_cbuildStore, kinds[kind]);
+
+		if (NOT _isdir(root))
+		{
+			continue;
+		}
+
+		FOREACH_FILE_IN_DIRECTORY(shard, root,
+		{
+			IGNORE_DIRECTORY_IF_DOTS(shard);
+			const char* directory = PATH(root, shard);
+
+			FOREACH_FILE_IN_DIRECTORY(name, directory,
+			{
+				IGNORE_DIRECTORY_IF_DOTS(name);
+				const char* path = PATH(directory, name);
+				struct stat info;
+
+				if (stat(path, &info) < 0)
+				{
+					continue;
+				}
+
+				if ((long long)info.st_mtime < oldest)
+				{
+					unlink(path);
+					continue;
+				}
+
+				if (paths.count == capacity)
+				{
+					capacity = capacity > 0 ? 2 * capacity : 1024;
+					times = (long long*)realloc(times, capacity * sizeof(long long));
+					sizes = (unsigned long long*)realloc(sizes, capacity * sizeof(unsigned long long));
+				}
+
+				times[paths.count] = (long long)info.st_mtime;
+				sizes[paths.count] = info.st_blocks * 512ULL;
+				total += sizes[paths.count];
+				_stringsAppend(&paths, path);
+			});
+		});
+	}
+
+	const unsigned long long limit = CBUILD_STORE_MAX_SIZE / 10 * 9;
+
+	while (total > limit AND paths.count > 0)
+	{
+		unsigned long long victim = 0;
+
+		for (unsigned long long index = 1; index < paths.count; ++index)
+		{
+			if (times[index] < times[victim])
+			{
+				victim = index;
+			}
+		}
+
+		unlink(paths.items[victim]);
+		total -= sizes[victim];
+		--paths.count;
+		paths.items[victim] = paths.items[paths.count];
+		times[victim] = times[paths.count];
+		sizes[victim] = sizes[paths.count];
+	}
+
+	free(times);
+	free(sizes);
+	close(lock);
+#endif
+}
+
+/**
+ * Wraps @ref _storeGc function.
+ * 
+ * @code{.c}
+ * 		STORE_GC();
+ * @endcode
+ */
+#ifndef STORE_GC
+#	define STORE_GC() _storeGc()
+#endif
+
+/**
+ * Starts @ref _storeGc in a detached background process, at most once
+ * per @ref CBUILD_STORE_GC_INTERVAL seconds for the whole store, as
+ * recorded by the modification time of `<store>/gc`.
+ */
+void _storeGcBackground(void)
+{
+#ifdef _WIN32
+	assert(!"TODO: implement _storeGcBackground with Windows WIN32 API!");
+#else
+	static int started = 0;
+	const char* stamp = PATH(_cbuildStore, "gc");
+	const long long last = _mtime(stamp);
+
+	if (started OR (last >= 0 AND last / 1000000000LL + CBUILD_STORE_GC_INTERVAL > (long long)time(NULL)))
+	{
+		free((void*)stamp);
+		return;
+	}
+
+	started = 1;
+	const int fd = open(stamp, O_WRONLY | O_CREAT | O_CLOEXEC, 0666);
+
+	if (fd >= 0)
+	{
+		futimens(fd, NULL);
+		close(fd);
+	}
+
+	free((void*)stamp);
+	fflush(stdout);
+	fflush(stderr);
+	const pid_t child = fork();
+
+	if (child == 0)
+	{
+		setsid();
+
+		if (fork() == 0)
+		{
+			_storeGc();
+		}
+
+		_exit(0);
+	}
+
+	if (child > 0)
+	{
+		waitpid(child, NULL, 0);
+	}
+#endif
+}
+
+/**
+ * Action running in background, see @ref _actionSubmit. The action is
+ * the index of its copy in @ref _cbuildGraph, and the output is the file
+ * capturing what it prints (see @ref _progressCapture), or -1.
+ */
+struct _CBuild_Job
+{
+	pid_t pid;
+	unsigned long long action;
+	unsigned long long slot;
+	long long started;
+	int output;
+};
+
+struct _CBuild_Job* _cbuildRunning = NULL;
+unsigned long long _cbuildRunningCount = 0;
+
+/**
+ * Process that started the running actions, so processes forked from it
+ * leave them alone when they exit (see @ref _actionsAbandon).
+ */
+pid_t _cbuildRunningOwner = 0;
+
+/**
+ * Returns monotonic time in nanoseconds.
+ */
+long long _now(void)
+{
+#ifdef _WIN32
+	assert(!"TODO: implement _now with Windows WIN32 API!");
+#else
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+#endif
+}
+
+/**
+ * Reads durations recorded by earlier runs from the file into the map,
+ * in milliseconds plus one, keyed by name. The file has one
+ * `<milliseconds> <name>` line per entry.
+ */
+void _durationsLoad(const char* const path, struct _CBuild_Map* const durations)
+{
+	char* content = _readFile(path, NULL);
+
+	for (char* line = content; line != NULL AND *line != '\0';)
+	{
+		char* end = strchr(line, '\n');
+
+		if (end != NULL)
+		{
+			*end = '\0';
+		}
+
+		char* name = NULL;
+		const unsigned long long milliseconds = strtoull(line, &name, 10);
+
+		if (*name == ' ')
+		{
+			_mapSet(durations, name + 1, milliseconds + 1);
+		}
+
+		line = end != NULL ? end + 1 : NULL;
+	}
+
+	free(content);
+}
+
+/**
+ * Writes the durations in the map into the file read by
+ * @ref _durationsLoad.
+ */
+void _durationsSave(const char* const path, const struct _CBuild_Map* const durations)
+{
+	struct _CBuild_Buffer record = { 0 };
+
+	for (unsigned long long index = 0; index < durations->capacity; ++index)
+	{
+		if (durations->keys[index] != NULL AND durations->values[index] > 0)
+		{
+			_bufferAppendf(&record, "%llu %s\n", durations->values[index] - 1, durations->keys[index]);
+		}
+	}
+
+	_writeFile(path, record.data, record.length);
+	BUFFER_FREE(&record);
+}
+
+/**
+ * Milliseconds between redraws of the status line on a terminal, and
+ * between plain progress lines otherwise.
+ */
+#ifndef CBUILD_PROGRESS_INTERVAL
+#	define CBUILD_PROGRESS_INTERVAL 100
+#endif
+
+#ifndef CBUILD_PROGRESS_PLAIN_INTERVAL
+#	define CBUILD_PROGRESS_PLAIN_INTERVAL 5000
+#endif
+
+/**
+ * Progress of actions of this build. Total counts actions checked so
+ * far, plus those the replayed configuration is still going to submit
+ * (planned). Durations of actions executed by earlier builds, keyed by
+ * output, estimate the remaining time of running ones; for actions not
+ * checked yet, their average is weighed by the share of actions found
+ * stale so far.
+ */
+struct _CBuild_Progress
+{
+	unsigned long long total;
+	unsigned long long planned;
+	unsigned long long done;
+	unsigned long long started;
+	unsigned long long executed;
+	long long begin;
+	long long rendered;
+	long long recordedSum;
+	unsigned long long recordedCount;
+	long long measuredSum;
+	int terminal;
+	int loaded;
+	struct _CBuild_Map durations;
+};
+
+struct _CBuild_Progress _cbuildProgressState = { 0 };
+
+#ifndef CBUILD_DURATIONS_PATH
+#	define CBUILD_DURATIONS_PATH PATH(CBUILD_CACHE_DIRECTORY, "durations")
+#endif
+
+/**
+ * Erases the status line, if it is displayed.
+ */
+void _progressClear(void)
+{
+	if (_cbuildProgressShown)
+	{
+		fputs("\r\033[K", stdout);
+		fflush(stdout);
+		_cbuildProgressShown = 0;
+	}
+}
+
+/**
+ * Returns the average duration of actions in nanoseconds: of the
+ * recorded durations of actions started by this build, or of the ones
+ * measured by it, or -1 if nothing is known yet.
+ */
+long long _progressAverage(void)
+{
+	const struct _CBuild_Progress* progress = &_cbuildProgressState;
+
+	if (progress->recordedCount > 0)
+	{
+		return progress->recordedSum / (long long)progress->recordedCount;
+	}
+
+	return progress->executed > 0 ? progress->measuredSum / (long long)progress->executed : -1;
+}
+
+/**
+ * Returns the expected duration of an action with the output in
+ * nanoseconds, as recorded by an earlier build, or the average (see
+ * @ref _progressAverage).
+ */
+long long _progressExpected(const char* const output)
+{
+	unsigned long long recorded = 0;
+
+	if (_mapGet(&_cbuildProgressState.durations, output, &recorded) AND recorded > 0)
+	{
+		return (long long)(recorded - 1) * 1000000LL;
+	}
+
+	return _progressAverage();
+}
+
+/**
+ * Checks whether progress is displayed as a status line on a terminal
+ * (see @ref _progressRender).
+ */
+int _progressTerminal(void)
+{
+	struct _CBuild_Progress* progress = &_cbuildProgressState;
+
+	if (NOT _cbuildProgress OR CBUILD_ECHO_LEVEL < 1 OR _cbuildDryRun)
+	{
+		return 0;
+	}
+
+	if (progress->terminal == 0)
+	{
+		const char* term = getenv("TERM");
+		progress->terminal = isatty(STDOUT_FILENO) AND term != NULL AND NOT STREQL(term, "dumb") ? 1 : -1;
+	}
+
+	return progress->terminal > 0;
+}
+
+/**
+ * Displays progress of actions, at most every
+ * @ref CBUILD_PROGRESS_INTERVAL milliseconds unless forced: completed
+ * and total actions, running ones, throughput and the estimated time
+ * left. On a terminal it is a status line rewritten in place, which
+ * @ref ECHO erases before printing, and a plain line otherwise. Actions
+ * can not erase it, so their output is captured meanwhile (see
+ * @ref _progressCapture).
+ */
+void _progressRender(const int force)
+{
+	struct _CBuild_Progress* progress = &_cbuildProgressState;
+
+	if (NOT _cbuildProgress OR CBUILD_ECHO_LEVEL < 1 OR _cbuildDryRun OR progress->started == 0)
+	{
+		return;
+	}
+
+	const long long now = _now();
+	_progressTerminal();
+
+	const long long interval = (progress->terminal > 0 ? CBUILD_PROGRESS_INTERVAL : CBUILD_PROGRESS_PLAIN_INTERVAL) * 1000000LL;
+
+	if (NOT force AND now - progress->rendered < interval)
+	{
+		return;
+	}
+
+	progress->rendered = now;
+	long long remaining = 0;
+	long long longest = 0;
+	int known = 1;
+
+	for (unsigned long long index = 0; index < _cbuildRunningCount; ++index)
+	{
+		const long long expected = _progressExpected(_cbuildGraph.actions[_cbuildRunning[index].action].output);
+		const long long left = expected - (now - _cbuildRunning[index].started);
+		known &= expected >= 0;
+		remaining += left > 0 ? left : 0;
+		longest = left > longest ? left : longest;
+	}
+
+	const unsigned long long checked = progress->done + _cbuildRunningCount;
+	const unsigned long long unchecked = progress->total > checked ? progress->total - checked : 0;
+	const long long average = _progressAverage();
+
+	if (unchecked > 0 AND checked > 0)
+	{
+		known &= average >= 0;
+		remaining += (long long)((double)average * unchecked * progress->started / checked);
+	}
+
+	const long long slots = _cbuildJobs > 0 ? (long long)_cbuildJobs : 1;
+	const long long eta = (remaining / slots > longest ? remaining / slots : longest) / 1000000000LL;
+	const double seconds = (double)(now - progress->begin) / 1e9;
+	char line[128];
+	int length = snprintf(line, sizeof(line), "[%llu/%llu] %llu running, %.1f/s", progress->done, progress->total, _cbuildRunningCount,
+		seconds > 0 ? progress->executed / seconds : 0.0);
+
+	if (known)
+	{
+		snprintf(line + length, sizeof(line) - length, ", ETA %lld:%02lld", eta / 60, eta % 60);
+	}
+
+	if (progress->terminal > 0)
+	{
+		fprintf(stdout, "\r%s\033[K", line);
+		fflush(stdout);
+		_cbuildProgressShown = 1;
+	}
+	else
+	{
+		ECHO(stdout, " -- "CBUILD_INFO_LABEL" Progress %s\n", line);
+	}
+}
+
+/**
+ * Returns a new temporary file for output of an action about to start
+ * while the status line is displayed, or -1 when actions print straight
+ * to the terminal or the file could not be created. The file is already
+ * unlinked; @ref _progressOutput prints and closes it once the action
+ * finishes, so the output shows up whole above the status line.
+ */
+int _progressCapture(void)
+{
+	if (NOT _progressTerminal())
+	{
+		return -1;
+	}
+
+	char* path = (char*)PATH(getenv("TMPDIR") != NULL ? getenv("TMPDIR") : "/tmp", "cbuild.XXXXXX");
+	const int fd = mkstemp(path);
+
+	if (fd >= 0)
+	{
+		unlink(path);
+		fcntl(fd, F_SETFD, FD_CLOEXEC);
+	}
+
+	free(path);
+	return fd;
+}
+
+/**
+ * Prints output of a finished action captured by @ref _progressCapture,
+ * erasing the status line first and redrawing it afterwards, and closes
+ * the file.
+ */
+void _progressOutput(const int output)
+{
+	if (output < 0)
+	{
+		return;
+	}
+
+	struct _CBuild_Buffer content = { 0 };
+	char chunk[4096];
+
+	for (int rewound = lseek(output, 0, SEEK_SET) == 0; rewound;)
+	{
+		const ssize_t length = read(output, chunk, sizeof(chunk));
+
+		if (length < 0 AND errno == EINTR)
+		{
+			continue;
+		}
+
+		if (length <= 0)
+		{
+			break;
+		}
+
+		_bufferAppend(&content, chunk, length);
+	}
+
+	close(output);
+
+	if (content.length > 0)
+	{
+		_progressClear();
+		fwrite(content.data, 1, content.length, stdout);
+		fflush(stdout);
+		_progressRender(1);
+	}
+
+	BUFFER_FREE(&content);
+}
+
+/**
+ * Counts an action submitted or run, which either started (see
+ * @ref _progressFinish) or was up to date.
+ */
+void _progressCount(const int started)
+{
+	struct _CBuild_Progress* progress = &_cbuildProgressState;
+
+	if (progress->planned > 0)
+	{
+		--progress->planned;
+	}
+	else
+	{
+		++progress->total;
+	}
+
+	if (started)
+	{
+		if (NOT progress->loaded)
+		{
+			_durationsLoad(CBUILD_DURATIONS_PATH, &progress->durations);
+			progress->loaded = 1;
+		}
+
+		if (progress->started == 0)
+		{
+			progress->begin = _now();
+			progress->rendered = progress->begin;
+		}
+
+		++progress->started;
+		unsigned long long recorded = 0;
+		const char* output = _cbuildGraph.actions[_cbuildGraph.count - 1].output;
+
+		if (_mapGet(&progress->durations, output, &recorded) AND recorded > 0)
+		{
+			progress->recordedSum += (long long)(recorded - 1) * 1000000LL;
+			++progress->recordedCount;
+		}
+	}
+	else
+	{
+		++progress->done;
+	}
+
+	_progressRender(0);
+}
+
+/**
+ * Counts a finished action started at the time, and records how long it
+ * took for later builds.
+ */
+void _progressFinish(const char* const output, const long long started)
+{
+	struct _CBuild_Progress* progress = &_cbuildProgressState;
+	const long long duration = _now() - started;
+	++progress->done;
+	++progress->executed;
+	progress->measuredSum += duration;
+	_mapSet(&progress->durations, output, (unsigned long long)(duration / 1000000LL) + 1);
+	_progressRender(0);
+}
+
+/**
+ * Writes durations of executed actions for later builds, and erases the
+ * status line. Files written here are not part of the configuration, so
+ * they are not probed.
+ */
+void _progressSave(void)
+{
+	_progressClear();
+
+	if (_cbuildProgressState.executed > 0 AND NOT _cbuildDryRun)
+	{
+		const int probing = _cbuildProbing;
+		_cbuildProbing = 0;
+		_ensureDir(CBUILD_CACHE_DIRECTORY);
+		_durationsSave(CBUILD_DURATIONS_PATH, &_cbuildProgressState.durations);
+		_cbuildProbing = probing;
+	}
+}
+
+/**
+ * Checks whether an input of the action failed (see @ref _cbuildFailed).
+ * Such an action is skipped, and its output counts as failed as well.
+ */
+int _actionBlocked(const struct _CBuild_Action* const action)
+{
+	for (unsigned long long index = 0; _cbuildFailed.count > 0 AND action->inputs != NULL AND action->inputs[index] != NULL; ++index)
+	{
+		if (_mapGet(&_cbuildFailed, action->inputs[index], NULL))
+		{
+#if CBUILD_ECHO_LEVEL >= 1
+			ECHO(stderr, " -- "CBUILD_WARNING_LABEL" Skipping `%s`, its input "CBUILD_WARNING("`%s`")" failed.\n", action->output, action->inputs[index]);
+#endif
+
+			_mapSet(&_cbuildFailed, action->output, 1);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Removes what a failed or terminated action may have left half written:
+ * its output and its stamp, so the next build runs it again instead of
+ * taking the output for up to date.
+ */
+void _actionDiscard(const struct _CBuild_Action* const action)
+{
+	const char* stampPath = CONCAT(action->output, CBUILD_STAMP_EXTENSION);
+	unlink(action->output);
+	unlink(stampPath);
+	STAT_FORGET(action->output);
+	STAT_FORGET(stampPath);
+	free((void*)stampPath);
+}
+
+/**
+ * Terminates all running actions (see @ref _terminateGroups) and
+ * discards their outputs.
+ */
+void _actionsCancel(void)
+{
+	pid_t* pids = (pid_t*)malloc((_cbuildRunningCount + 1) * sizeof(pid_t));
+
+	for (unsigned long long index = 0; index < _cbuildRunningCount; ++index)
+	{
+		pids[index] = _cbuildRunning[index].pid;
+	}
+
+	_terminateGroups(pids, _cbuildRunningCount);
+
+	for (unsigned long long index = 0; index < _cbuildRunningCount; ++index)
+	{
+		_actionDiscard(&_cbuildGraph.actions[_cbuildRunning[index].action]);
+
+		if (_cbuildRunning[index].output >= 0)
+		{
+			close(_cbuildRunning[index].output);
+		}
+	}
+
+	_cbuildRunningCount = 0;
+	free(pids);
+}
+
+/**
+ * Terminates actions still running when the build exits early, for
+ * example when a command run by @ref CMD fails, and then removes the
+ * cgroup of the build (see @ref _cgroupCleanup). Registered with
+ * `atexit` when the first action starts.
+ */
+void _actionsAbandon(void)
+{
+	if (_cbuildRunningOwner != getpid())
+	{
+		return;
+	}
+
+	if (_cbuildRunningCount > 0)
+	{
+#if CBUILD_ECHO_LEVEL >= 1
+		ECHO(stderr, " -- "CBUILD_WARNING_LABEL" Terminating %llu running actions.\n", _cbuildRunningCount);
+#endif
+
+		_actionsCancel();
+	}
+
+	_cgroupCleanup();
+}
+
+/**
+ * Records the action in the graph and checks whether it has to be
+ * executed (see @ref _actionStale). With `--explain` the reason is
+ * printed, and with `--dry-run` the command is printed and its output is
+ * marked as pending instead. Outputs found in the store (see
+ * @ref _storeFetch) are restored instead of executing. Returns 1 if the
+ * action should be executed now, and 0 otherwise.
+ */
+int _actionPrepare(const struct _CBuild_Action* const action)
+{
+	_graphAdd(&_cbuildGraph, action);
+	const char* reason = _actionStale(action);
+
+	if (reason == NULL)
+	{
+		return 0;
+	}
+
+	if (_cbuildExplain)
+	{
+		ECHO(stdout, " -- "CBUILD_INFO_LABEL" Explain `%s`: %s\n", action->output, reason);
+	}
+#if CBUILD_ECHO_LEVEL >= 3
+	else
+	{
+		ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Running action for `%s`: %s\n", action->output, reason);
+	}
+#endif
+
+	free((void*)reason);
+
+	if (_cbuildDryRun)
+	{
+		ECHO(stdout, " -- "CBUILD_INFO_LABEL" Would run: ");
+		_echoCommand(stdout, action->argv);
+		_mapSet(&_cbuildPending, action->output, 1);
+		return 0;
+	}
+
+	const int probing = _cbuildProbing;
+	_cbuildProbing = 0;
+
+	if (_cbuildStore != NULL AND _storeFetch(action))
+	{
+#if CBUILD_ECHO_LEVEL >= 1
+		ECHO(stdout, " -- "CBUILD_INFO_LABEL" Restored `%s` from store.\n", action->output);
+#endif
+
+		_actionStamp(action);
+		_cbuildProbing = probing;
+		return 0;
+	}
+
+	_cbuildProbing = probing;
+	return 1;
+}
+
+/**
+ * Starts the command of the action in the worker slot, see @ref _spawn
+ * and @ref _placementPrepare, writing its output to the file unless it
+ * is -1. Compilers, archivers and linkers read long command lines from
+ * response files (see @ref _rspArgv), other commands get their
+ * arguments as they are.
+ */
+pid_t _actionSpawn(const struct _CBuild_Action* const action, const unsigned long long slot, const int output)
+{
+	if (action->kind == CBUILD_ACTION_ARCHIVE)
+	{
+		unlink(action->output);
+	}
+
+	if (_cbuildRunningOwner != getpid())
+	{
+		_cbuildRunningOwner = getpid();
+		_cancelSetup();
+		atexit(_actionsAbandon);
+	}
+
+	const char* rspArgv[3];
+	const char* const* argv = action->kind != CBUILD_ACTION_COMMAND ? _rspArgv(action->argv, rspArgv) : action->argv;
+	_placementPrepare((long long)slot);
+	_cbuildSlotOutput = output;
+	const pid_t pid = _spawn(argv);
+	setpgid(pid, 0);
+	_cbuildSlot = -1;
+	_cbuildSlotOutput = -1;
+	return pid;
+}
+
+/**
+ * Starts the action in background, in the lowest worker slot not taken
+ * by a running one.
+ */
+void _actionStart(const struct _CBuild_Action* const action)
+{
+	unsigned long long slot = 0;
+
+	for (unsigned long long job = 0; job < _cbuildRunningCount; ++job)
+	{
+		if (_cbuildRunning[job].slot == slot)
+		{
+			++slot;
+			job = (unsigned long long)-1;
+		}
+	}
+
+	_cbuildRunning = (struct _CBuild_Job*)realloc(_cbuildRunning, (_cbuildRunningCount + 1) * sizeof(struct _CBuild_Job));
+	_cbuildRunning[_cbuildRunningCount].action = _cbuildGraph.count - 1;
+	_cbuildRunning[_cbuildRunningCount].slot = slot;
+	_cbuildRunning[_cbuildRunningCount].started = _now();
+	_cbuildRunning[_cbuildRunningCount].output = _progressCapture();
+	_cbuildRunning[_cbuildRunningCount].pid = _actionSpawn(action, slot, _cbuildRunning[_cbuildRunningCount].output);
+	++_cbuildRunningCount;
+	_progressCount(1);
+}
+
+/**
+ * Records command stamp of an executed action, and its outputs in the
+ * store when it is enabled (see @ref _storePut). Files written here are
+ * not part of the configuration, so they are not probed.
+ */
+void _actionFinish(const struct _CBuild_Action* const action)
+{
+	const int probing = _cbuildProbing;
+	_cbuildProbing = 0;
+	STAT_FORGET(action->output);
+
+	if (action->depfile != NULL)
+	{
+		STAT_FORGET(action->depfile);
+	}
+
+	_actionStamp(action);
+
+	if (_cbuildStore != NULL)
+	{
+		_storePut(action);
+		_storeGcBackground();
+	}
+
+	_cbuildProbing = probing;
+}
+
+/**
+ * Waits for any one of the background actions to finish and records its
+ * stamp. If it failed, its output is discarded (see
+ * @ref _actionDiscard), and once @ref _cbuildKeepGoing actions failed,
+ * the running ones are terminated and the build exits. When the build is
+ * interrupted (see @ref _cancelSetup), running actions are terminated as
+ * well. Only children of actions are reaped, so processes started by the
+ * build script itself are left to it.
+ */
+void _actionsWaitOne(void)
+{
+#ifdef _WIN32
+	assert(!"TODO: implement _actionsWaitOne with Windows WIN32 API!");
+#else
+	assert(_cbuildRunningCount > 0);
+	sigset_t signals;
+	sigset_t previous;
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGCHLD);
+	sigaddset(&signals, SIGINT);
+	sigaddset(&signals, SIGTERM);
+	sigaddset(&signals, SIGHUP);
+	sigprocmask(SIG_BLOCK, &signals, &previous);
+
+	int status = 0;
+	pid_t pid = 0;
+
+	while (pid == 0 AND _cbuildCancelled == 0)
+	{
+		for (unsigned long long index = 0; index < _cbuildRunningCount AND pid == 0; ++index)
+		{
+			pid = waitpid(_cbuildRunning[index].pid, &status, WNOHANG);
+		}
+
+		if (pid == 0)
+		{
+			const int received = sigwaitinfo(&signals, NULL);
+
+			if (received > 0 AND received != SIGCHLD)
+			{
+				_cancelHandler(received);
+			}
+		}
+	}
+
+	const int error = errno;
+	sigprocmask(SIG_SETMASK, &previous, NULL);
+
+	if (_cbuildCancelled != 0 AND pid <= 0)
+	{
+		_actionsCancel();
+		_cancelExit();
+	}
+
+	if (pid < 0)
+	{
+		errno = error;
+
+#if CBUILD_ECHO_LEVEL >= 1
+		ECHO(stderr, CBUILD_ERROR_LABEL" Failed to wait for child process: "CBUILD_ERROR("%s")"\n", strerror(errno));
+#endif
+
+		exit(1);
+	}
+
+	for (unsigned long long index = 0; index < _cbuildRunningCount; ++index)
+	{
+		if (_cbuildRunning[index].pid == pid)
+		{
+			const struct _CBuild_Action* action = &_cbuildGraph.actions[_cbuildRunning[index].action];
+			const long long started = _cbuildRunning[index].started;
+			const int output = _cbuildRunning[index].output;
+			_cbuildRunning[index] = _cbuildRunning[--_cbuildRunningCount];
+			_progressOutput(output);
+			_progressFinish(action->output, started);
+			_statForgetPrefetched();
+
+			if (_childStatus(status) != 0)
+			{
+#if CBUILD_ECHO_LEVEL >= 1
+				ECHO(stderr, CBUILD_ERROR_LABEL" Failed to build "CBUILD_ERROR("`%s`")"\n", action->output);
+#endif
+
+				_actionDiscard(action);
+				_mapSet(&_cbuildFailed, action->output, 1);
+				++_cbuildFailures;
+
+				if (_cbuildKeepGoing != 0 AND _cbuildFailures >= _cbuildKeepGoing)
+				{
+					_actionsAbandon();
+					exit(1);
+				}
+
+				return;
+			}
+
+			_actionFinish(action);
+			return;
+		}
+	}
+#endif
+}
+
+/**
+ * Waits for all background actions to finish, leaving failed ones to
+ * @ref _actionsWait.
+ */
+void _actionsDrain(void)
+{
+	while (_cbuildRunningCount > 0)
+	{
+		_actionsWaitOne();
+	}
+}
+
+/**
+ * Waits for all background actions to finish (see @ref _actionSubmit).
+ * Exits if any action failed, including earlier ones the build kept
+ * going after.
+ */
+void _actionsWait(void)
+{
+	_actionsDrain();
+	_progressSave();
+
+	if (_cbuildFailures > 0)
+	{
+#if CBUILD_ECHO_LEVEL >= 1
+		ECHO(stderr, CBUILD_ERROR_LABEL" "CBUILD_ERROR("%llu")" actions failed.\n", _cbuildFailures);
+#endif
+
+		exit(1);
+	}
+}
+
+/**
+ * Wraps @ref _actionsWait function.
+ * 
+ * @code{.c}
+ * 		WAIT_ACTIONS();
+ * @endcode
+ */
+#ifndef WAIT_ACTIONS
+#	define WAIT_ACTIONS() _actionsWait()
+#endif
+
+/**
+ * Like @ref _actionRun, but starts a stale action in background and
+ * returns without waiting for it, so independent actions run in
+ * parallel. At most `--jobs` actions (see @ref _options) run at once;
+ * when all slots are taken, it waits for one to finish first. If an
+ * input of the action is produced by a running action, all running
+ * actions are waited for first. Call @ref _actionsWait before using the
+ * outputs; @ref _actionRun does it implicitly. Returns 1 if the action
+ * was started, and 0 otherwise.
+ * 
+ * @code{.c}
+ * 		_actionSubmit(&first);
+ * 		_actionSubmit(&second);
+ * 		_actionsWait();
+ * @endcode
+ */
+int _actionSubmit(const struct _CBuild_Action* const action)
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _actionSubmit()\n");
+#endif
+
+	for (unsigned long long index = 0; action->inputs != NULL AND action->inputs[index] != NULL AND _cbuildRunningCount > 0; ++index)
+	{
+		for (unsigned long long job = 0; job < _cbuildRunningCount; ++job)
+		{
+			if (STREQL(_cbuildGraph.actions[_cbuildRunning[job].action].output, action->inputs[index]))
+			{
+				_actionsDrain();
+				break;
+			}
+		}
+	}
+
+	if (_actionBlocked(action) OR NOT _actionPrepare(action))
+	{
+		_progressCount(0);
+		return 0;
+	}
+
+	if (_cbuildJobs == 0)
+	{
+		const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+		_cbuildJobs = processors > 0 ? (unsigned long long)processors : 1;
+	}
+
+	while (_cbuildRunningCount >= _cbuildJobs)
+	{
+		_actionsWaitOne();
+	}
+
+	_actionStart(action);
+	return 1;
+}
+
+/**
+ * Wraps @ref _actionSubmit function.
+ * 
+ * @code{.c}
+ * 		SUBMIT_ACTION(&action);
+ * @endcode
+ */
+#ifndef SUBMIT_ACTION
+#	define SUBMIT_ACTION(action) _actionSubmit(action)
+#endif
+
+/**
+ * Waits for background actions (see @ref _actionSubmit), records the
+ * action in the graph, executes it if it is stale (see
+ * @ref _actionStale), and records its command stamp afterwards. With
+ * `--dry-run` (see @ref _options) the command is printed instead, and
+ * with `--explain` the reason is printed as well. Actions depending on
+ * a failed one are skipped (see @ref _cbuildKeepGoing). Returns 1 if the
+ * action was executed successfully, and 0 otherwise.
+ * 
+ * @code{.c}
+ * 		const char* inputs[] = { "main.c", NULL };
+ * 		const char* argv[] = { "cc", "-c", "main.c", "-o", "main.o", NULL };
+ * 		struct _CBuild_Action action = { "main.o", NULL, inputs, argv, CBUILD_ACTION_COMMAND };
+ * 		_actionRun(&action);
+ * @endcode
+ */
+int _actionRun(const struct _CBuild_Action* const action)
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _actionRun()\n");
+#endif
+
+	_actionsDrain();
+
+	if (_actionBlocked(action) OR NOT _actionPrepare(action))
+	{
+		_progressCount(0);
+		return 0;
+	}
+
+	_actionStart(action);
+	_actionsDrain();
+	return NOT _mapGet(&_cbuildFailed, action->output, NULL);
+}
+
+/**
+ * Wraps @ref _actionRun function.
+ * 
+ * @code{.c}
+ * 		RUN_ACTION(&action);
+ * @endcode
+ */
+#ifndef RUN_ACTION
+#	define RUN_ACTION(action) _actionRun(action)
+#endif
+
+/**
+ * @}
+ */
+
+
+
+/**
+ * @addtogroup HERMETIC
+ * 
+ * @{
+ */
+
+#ifndef CBUILD_EXECUTOR_DIRECTORY
+#	define CBUILD_EXECUTOR_DIRECTORY PATH(CBUILD_CACHE_DIRECTORY, "executor")
+#endif
+
+/**
+ * Action described completely by its inputs, command, environment and
+ * outputs (all NULL terminated arrays), so it can run anywhere those
+ * are available (see @ref _hermeticRun). Relative inputs and outputs
+ * are staged in and collected from the action's working directory.
+ * Absolute inputs (like system headers) are only hashed. The command
+ * sees exactly the given environment, NULL meaning an empty one.
+ */
+struct _CBuild_Hermetic
+{
+	const char** inputs;
+	const char** argv;
+	const char** env;
+	const char** outputs;
+};
+
+/**
+ * Checks whether a path is staged in a sandbox, i.e. it is relative and
+ * does not leave the working directory.
+ */
+int _sandboxed(const char* const path)
+{
+	return path[0] != PATH_SEPARATOR[0] AND strncmp(path, "../", 3) != 0 AND strstr(path, "/../") == NULL AND NOT STREQL(path, "..");
+}
+
+/**
+ * Serializes the action as a sequence of tagged, NUL terminated strings:
+ * `a<argument>`, `e<variable>`, `i<SHA-256 of content>:<path>` and
+ * `o<path>`. Inputs are identified by content, so the SHA-256 of the
+ * description is the action digest used by the executor cache and by
+ * stamps. Returns 0 on success, and -1 if an input could not be read.
+ */
+int _hermeticDescribe(const struct _CBuild_Hermetic* const action, struct _CBuild_Buffer* const description)
+{
+	for (unsigned long long index = 0; action->argv[index] != NULL; ++index)
+	{
+		_bufferAppendf(description, "a%s", action->argv[index]);
+		_bufferAppend(description, "", 1);
+	}
+
+	for (unsigned long long index = 0; action->env != NULL AND action->env[index] != NULL; ++index)
+	{
+		_bufferAppendf(description, "e%s", action->env[index]);
+		_bufferAppend(description, "", 1);
+	}
+
+	for (unsigned long long index = 0; action->inputs != NULL AND action->inputs[index] != NULL; ++index)
+	{
+		struct _CBuild_Sha256 content;
+		char hex[65];
+		_sha256Init(&content);
+
+		if (_sha256File(&content, action->inputs[index]) < 0)
+		{
+#if CBUILD_ECHO_LEVEL >= 1
+			ECHO(stderr, CBUILD_ERROR_LABEL" Failed to read input `%s`: "CBUILD_ERROR("%s")"\n", action->inputs[index], strerror(errno));
+#endif
+
+			return -1;
+		}
+
+		_sha256Hex(&content, hex);
+		_bufferAppendf(description, "i%s:%s", hex, action->inputs[index]);
+		_bufferAppend(description, "", 1);
+	}
+
+	for (unsigned long long index = 0; action->outputs[index] != NULL; ++index)
+	{
+		_bufferAppendf(description, "o%s", action->outputs[index]);
+		_bufferAppend(description, "", 1);
+	}
+
+	return 0;
+}
+
+/**
+ * Writes the whole buffer into a file descriptor. Returns 0 on success,
+ * and -1 otherwise.
+ */
+int _writeAll(const int fd, const void* const data, const unsigned long long length)
+{
+	unsigned long long total = 0;
+
+	while (total < length)
+	{
+		const ssize_t count = write(fd, (const char*)data + total, length - total);
+
+		if (count < 0 AND errno == EINTR)
+		{
+			continue;
+		}
+
+		if (count <= 0)
+		{
+			return -1;
+		}
+
+		total += count;
+	}
+
+	return 0;
+}
+
+/**
+ * Reads exactly length bytes from a file descriptor. Returns 0 on
+ * success, and -1 on error or end of file.
+ */
+int _readAll(const int fd, void* const data, const unsigned long long length)
+{
+	unsigned long long total = 0;
+
+	while (total < length)
+	{
+		const ssize_t count = read(fd, (char*)data + total, length - total);
+
+		if (count < 0 AND errno == EINTR)
+		{
+			continue;
+		}
+
+		if (count <= 0)
+		{
+			return -1;
+		}
+
+		total += count;
+	}
+
+	return 0;
+}
+
+/**
+ * Reads a single line (without the newline) from a file descriptor into
+ * the buffer, replacing its content. The buffer is NUL terminated.
+ * Returns 0 on success, and -1 on error or end of file.
+ */
+int _readLine(const int fd, struct _CBuild_Buffer* const line)
+{
+	BUFFER_CLEAR(line);
+
+	for (;;)
+	{
+		char character = 0;
+
+		if (_readAll(fd, &character, 1) < 0)
+		{
+			return -1;
+		}
+
+		if (character == '\n')
+		{
+			break;
+		}
+
+		_bufferAppend(line, &character, 1);
+	}
+
+	_bufferReserve(line, 1);
+	line->data[line->length] = '\0';
+	return 0;
+}
+
+/**
+ * Creates a new empty sandbox directory under
+ * `<CBUILD_CACHE_DIRECTORY>/sandbox`, on the same file system as the
+ * build tree, so inputs are hard linked into it and outputs are renamed
+ * out of it. Returns its path, or NULL on failure.
+ */
+const char* _sandboxCreate(void)
+{
+#ifdef _WIN32
+	assert(!"TODO: implement _sandboxCreate with Windows WIN32 API!");
+#else
+	const char* root = PATH(CBUILD_CACHE_DIRECTORY, "sandbox");
+
+	if (_ensureDir(root) < 0)
+	{
+		return NULL;
+	}
+
+	char* sandbox = (char*)CONCAT(root, PATH_SEPARATOR, "XXXXXX");
+	free((void*)root);
+	return mkdtemp(sandbox);
+#endif
+}
+
+/**
+ * Places a file at relative path in the sandbox, creating its parent
+ * directories. The file is hard linked when possible, and copied
+ * otherwise. Returns 0 on success, and -1 otherwise.
+ */
+int _sandboxStage(const char* const sandbox, const char* const source, const char* const path)
+{
+	const char* destination = PATH(sandbox, path);
+	const char* separator = strrchr(destination, PATH_SEPARATOR[0]);
+	char* parent = strndup(destination, separator - destination);
+	int result = _ensureDir(parent);
+	free(parent);
+
+	if (result == 0 AND link(source, destination) < 0)
+	{
+		result = _copy(source, destination);
+	}
+
+	free((void*)destination);
+	return result;
+}
+
+/**
+ * Runs the argument vector in the sandbox directory with exactly the
+ * given environment. The executable is resolved by @ref _which in the
+ * calling process. When log is not NULL, standard output and standard
+ * error are captured into it. Returns 0 if the command succeeded, and
+ * 1 otherwise.
+ */
+int _sandboxExec(const char* const sandbox, const char* const* argv, const char* const* env, struct _CBuild_Buffer* const log)
+{
+#ifdef _WIN32
+	assert(!"TODO: implement _sandboxExec with Windows WIN32 API!");
+#else
+	static const char* const empty[] = { NULL };
+	const char* executable = _which(argv[0]);
+	int pipes[2] = { -1, -1 };
+
+	if (executable == NULL)
+	{
+#if CBUILD_ECHO_LEVEL >= 1
+		ECHO(stderr, CBUILD_ERROR_LABEL" Could not find executable "CBUILD_ERROR("`%s`")"\n", argv[0]);
+#endif
+
+		return 1;
+	}
+
+	if (executable[0] != PATH_SEPARATOR[0])
+	{
+		char* absolute = realpath(executable, NULL);
+		executable = absolute != NULL ? absolute : executable;
+	}
+
+	if (log != NULL AND pipe(pipes) < 0)
+	{
+		return 1;
+	}
+
+	fflush(stdout);
+	fflush(stderr);
+	const pid_t childProcessId = fork();
+
+	if (childProcessId == -1)
+	{
+#if CBUILD_ECHO_LEVEL >= 1
+		ECHO(stderr, CBUILD_ERROR_LABEL" Failed to fork child process: "CBUILD_ERROR("%s")"\n", strerror(errno));
+#endif
+
+		return 1;
+	}
+
+	if (childProcessId == 0)
+	{
+		if (log != NULL)
+		{
+			dup2(pipes[1], STDOUT_FILENO);
+			dup2(pipes[1], STDERR_FILENO);
+			close(pipes[0]);
+			close(pipes[1]);
+		}
+
+		if (chdir(sandbox) < 0)
+		{
+			_exit(127);
+		}
+
+		execve(executable, (char* const *)argv, (char* const *)(env != NULL ? env : empty));
+		fprintf(stderr, CBUILD_ERROR_LABEL" Failed to execute `%s`: %s\n", executable, strerror(errno));
+		_exit(127);
+	}
+
+	if (log != NULL)
+	{
+		char chunk[4096];
+		close(pipes[1]);
+
+		for (;;)
+		{
+			const ssize_t length = read(pipes[0], chunk, sizeof(chunk));
+
+			if (length < 0 AND errno == EINTR)
+			{
+				continue;
+			}
+
+			if (length <= 0)
+			{
+				break;
+			}
+
+			_bufferAppend(log, chunk, length);
+		}
+
+		close(pipes[0]);
+	}
+
+	return _waitChild(childProcessId);
+#endif
+}
+
+/**
+ * Runs the action locally in a fresh sandbox: stages relative inputs,
+ * runs the command there, and moves outputs back into the build tree.
+ * Returns 0 on success, and 1 otherwise.
+ */
+int _hermeticLocal(const struct _CBuild_Hermetic* const action)
+{
+	const char* sandbox = _sandboxCreate();
+
+	if (sandbox == NULL)
+	{
+#if CBUILD_ECHO_LEVEL >= 1
+		ECHO(stderr, CBUILD_ERROR_LABEL" Failed to create sandbox: "CBUILD_ERROR("%s")"\n", strerror(errno));
+#endif
+
+		return 1;
+	}
+
+	int result = 0;
+
+	for (unsigned long long index = 0; action->inputs != NULL AND action->inputs[index] != NULL AND result == 0; ++index)
+	{
+		if (_sandboxed(action->inputs[index]) AND _sandboxStage(sandbox, action->inputs[index], action->inputs[index]) < 0)
+		{
+#if CBUILD_ECHO_LEVEL >= 1
+			ECHO(stderr, CBUILD_ERROR_LABEL" Failed to stage input `%s`: "CBUILD_ERROR("%s")"\n", action->inputs[index], strerror(errno));
+#endif
+
+			result = 1;
+		}
+	}
+
+	for (unsigned long long index = 0; action->outputs[index] != NULL AND result == 0; ++index)
+	{
+		const char* separator = strrchr(action->outputs[index], PATH_SEPARATOR[0]);
+
+		if (separator != NULL)
+		{
+			char* parent = strndup(action->outputs[index], separator - action->outputs[index]);
+			result = _ensureDir(PATH(sandbox, parent)) < 0 OR _ensureDir(parent) < 0;
+			free(parent);
+		}
+	}
+
+	if (result == 0)
+	{
+		result = _sandboxExec(sandbox, action->argv, action->env, NULL);
+	}
+
+	for (unsigned long long index = 0; action->outputs[index] != NULL AND result == 0; ++index)
+	{
+		const char* produced = PATH(sandbox, action->outputs[index]);
+
+		if (rename(produced, action->outputs[index]) < 0)
+		{
+#if CBUILD_ECHO_LEVEL >= 1
+			ECHO(stderr, CBUILD_ERROR_LABEL" Action did not produce output `%s`: "CBUILD_ERROR("%s")"\n", action->outputs[index], strerror(errno));
+#endif
+
+			result = 1;
+		}
+
+		free((void*)produced);
+	}
+
+	_rmReport(sandbox, _rmat(AT_FDCWD, sandbox, 1));
+	free((void*)sandbox);
+	return result;
+}
+
+/**
+ * Connects to the executor socket. Returns the socket, or -1 on failure.
+ */
+int _executorConnect(const char* const path)
+{
+#ifdef _WIN32
+	assert(!"TODO: implement _executorConnect with Windows WIN32 API!");
+#else
+	struct sockaddr_un address = { 0 };
+	address.sun_family = AF_UNIX;
+
+	if (strlen(path) >= sizeof(address.sun_path))
+	{
+		errno = ENAMETOOLONG;
+		return -1;
+	}
+
+	strcpy(address.sun_path, path);
+	const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+	if (fd < 0)
+	{
+		return -1;
+	}
+
+	if (connect(fd, (struct sockaddr*)&address, sizeof(address)) < 0)
+	{
+		const int error = errno;
+		close(fd);
+		errno = error;
+		return -1;
+	}
+
+	return fd;
+#endif
+}
+
+/**
+ * Creates a Unix socket listening on the path, replacing any stale
+ * socket there. Returns the socket, or -1 on failure.
+ */
+int _unixListen(const char* const path)
+{
+#ifdef _WIN32
+	assert(!"TODO: implement _unixListen with Windows WIN32 API!");
+#else
+	struct sockaddr_un address = { 0 };
+	address.sun_family = AF_UNIX;
+
+	if (strlen(path) >= sizeof(address.sun_path))
+	{
+		errno = ENAMETOOLONG;
+		return -1;
+	}
+
+	strcpy(address.sun_path, path);
+	const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+	if (fd < 0)
+	{
+		return -1;
+	}
+
+	unlink(path);
+
+	if (bind(fd, (struct sockaddr*)&address, sizeof(address)) < 0 OR listen(fd, 64) < 0)
+	{
+		const int error = errno;
+		close(fd);
+		errno = error;
+		return -1;
+	}
+
+	return fd;
+#endif
+}
+
+/**
+ * Uploads inputs of the action the executor does not have yet. Returns
+ * 0 on success, and -1 otherwise.
+ */
+int _hermeticUpload(const int fd, const struct _CBuild_Buffer* const description)
+{
+	struct _CBuild_Buffer message = { 0 };
+	struct _CBuild_Buffer line = { 0 };
+	struct _CBuild_Map inputs = { 0 };
+	unsigned long long count = 0;
+	int result = 0;
+
+	for (unsigned long long offset = 0; offset < description->length; offset += strlen(description->data + offset) + 1)
+	{
+		const char* item = description->data + offset;
+
+		if (item[0] == 'i' AND _sandboxed(item + 66))
+		{
+			char name[65];
+			memcpy(name, item + 1, 64);
+			name[64] = '\0';
+			_mapSet(&inputs, name, offset + 66);
+			_bufferAppend(&message, item + 1, 64);
+			BUFFER_APPEND(&message, "\n");
+			++count;
+		}
+	}
+
+	char header[64];
+	sprintf(header, "MISSING %llu\n", count);
+
+	if (_writeAll(fd, header, strlen(header)) < 0 OR _writeAll(fd, message.data, message.length) < 0 OR _readLine(fd, &line) < 0 OR sscanf(line.data, "MISSING %llu", &count) != 1)
+	{
+		result = -1;
+	}
+
+	struct _CBuild_Strings missing = { 0 };
+
+	for (unsigned long long index = 0; index < count AND result == 0; ++index)
+	{
+		if (_readLine(fd, &line) < 0)
+		{
+			result = -1;
+			continue;
+		}
+
+		_stringsAppendCopy(&missing, line.data);
+	}
+
+	for (unsigned long long index = 0; index < missing.count AND result == 0; ++index)
+	{
+		unsigned long long offset = 0;
+
+		if (NOT _mapGet(&inputs, missing.items[index], &offset))
+		{
+			result = -1;
+			continue;
+		}
+
+		unsigned long long length = 0;
+		char* content = _readFile(description->data + offset, &length);
+		sprintf(header, "PUT %s %llu\n", missing.items[index], length);
+
+		if (content == NULL OR _writeAll(fd, header, strlen(header)) < 0 OR _writeAll(fd, content, length) < 0 OR _readLine(fd, &line) < 0 OR NOT STREQL(line.data, "OK"))
+		{
+			result = -1;
+		}
+
+		free(content);
+	}
+
+	_stringsFree(&missing);
+	_mapFree(&inputs);
+	BUFFER_FREE(&message);
+	BUFFER_FREE(&line);
+	return result;
+}
+
+/**
+ * Asks the executor to run the described action, prints its log, and
+ * writes its outputs into the build tree. Only outputs declared by the
+ * action are accepted, whatever paths the executor sends. Returns 0 if
+ * the action succeeded, 1 if it failed, and -1 if the executor could
+ * not run it.
+ */
+int _hermeticDownload(const int fd, const struct _CBuild_Buffer* const description)
+{
+	struct _CBuild_Buffer data = { 0 };
+	struct _CBuild_Buffer line = { 0 };
+	struct _CBuild_Map declared = { 0 };
+	char header[64];
+	int status = 0;
+	int cached = 0;
+	unsigned long long length = 0;
+	unsigned long long count = 0;
+	sprintf(header, "RUN %llu\n", description->length);
+
+	if (_writeAll(fd, header, strlen(header)) < 0 OR _writeAll(fd, description->data, description->length) < 0 OR _readLine(fd, &line) < 0 OR sscanf(line.data, "RESULT %d %d %llu %llu", &status, &cached, &length, &count) != 4 OR status < 0)
+	{
+		BUFFER_FREE(&line);
+		return -1;
+	}
+
+	for (unsigned long long offset = 0; offset < description->length; offset += strlen(description->data + offset) + 1)
+	{
+		if (description->data[offset] == 'o')
+		{
+			_mapSet(&declared, description->data + offset + 1, 1);
+		}
+	}
+
+	_bufferReserve(&data, length);
+
+	if (_readAll(fd, data.data, length) < 0)
+	{
+		status = -1;
+	}
+
+	fwrite(data.data, 1, length, stdout);
+	fflush(stdout);
+
+#if CBUILD_ECHO_LEVEL >= 2
+	if (cached)
+	{
+		ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Executor returned cached result\n");
+	}
+#endif
+
+	for (unsigned long long output = 0; output < count AND status == 0; ++output)
+	{
+		char hash[65];
+		char received[65];
+		unsigned int mode = 0;
+		int offset = 0;
+
+		if (_readLine(fd, &line) < 0 OR sscanf(line.data, "OUTPUT %64s %llu %o %n", hash, &length, &mode, &offset) != 3)
+		{
+			status = -1;
+			continue;
+		}
+
+		const char* path = line.data + offset;
+		BUFFER_CLEAR(&data);
+		_bufferReserve(&data, length);
+
+		const int valid = _mapGet(&declared, path, NULL) AND _readAll(fd, data.data, length) == 0;
+
+		if (valid)
+		{
+			_sha256Data(data.data, length, received);
+		}
+
+		if (NOT valid OR NOT STREQL(received, hash) OR _writeFile(path, data.data, length) < 0 OR chmod(path, mode & 0777) < 0)
+		{
+#if CBUILD_ECHO_LEVEL >= 1
+			ECHO(stderr, CBUILD_ERROR_LABEL" Failed to receive output `%s` from executor\n", path);
+#endif
+
+			status = -1;
+		}
+	}
+
+	_mapFree(&declared);
+	BUFFER_FREE(&data);
+	BUFFER_FREE(&line);
+	return status;
+}
+
+/**
+ * Sends the action to the executor (see @ref _executorServe) and writes
+ * its outputs into the build tree. Only inputs the executor does not
+ * have yet are uploaded. Returns 0 on success, 1 if the action failed,
+ * and -1 if the executor could not be used.
+ */
+int _hermeticRemote(const struct _CBuild_Buffer* const description)
+{
+	const int fd = _executorConnect(_cbuildExecutor);
+
+	if (fd < 0)
+	{
+#if CBUILD_ECHO_LEVEL >= 1
+		ECHO(stderr, CBUILD_WARNING_LABEL" Failed to connect to executor `%s`, running locally: "CBUILD_WARNING("%s")"\n", _cbuildExecutor, strerror(errno));
+#endif
+
+		return -1;
+	}
+
+	const int result = _hermeticUpload(fd, description) == 0 ? _hermeticDownload(fd, description) : -1;
+	close(fd);
+
+#if CBUILD_ECHO_LEVEL >= 1
+	if (result < 0)
+	{
+		ECHO(stderr, CBUILD_WARNING_LABEL" Executor `%s` failed to run the action, running locally\n", _cbuildExecutor);
+	}
+#endif
+
+	return result;
+}
+
+/**
+ * Runs a hermetic action if it is stale, either locally in a sandbox
+ * (see @ref _hermeticLocal) or, with `--executor <socket>` (see
+ * @ref _options), on the executor. Staleness is decided by content: the
+ * action digest (see @ref _hermeticDescribe) is stored in the stamp of
+ * its first output, and the action runs when the digest changes or an
+ * output is missing. When the store is enabled, outputs are restored
+ * from it (see @ref _storeRestore) under a SHA-256 digest of the
+ * description and the inputs. Supports `--dry-run` and `--explain`.
+ * Waits for background actions first. Exits if the action fails.
+ * Returns 1 if the action was executed, and 0 otherwise.
+ * 
+ * @code{.c}
+ * 		const char* inputs[] = { "main.c", NULL };
+ * 		const char* argv[] = { "cc", "-c", "main.c", "-o", "main.o", NULL };
+ * 		const char* env[] = { "PATH=/usr/bin:/bin", NULL };
+ * 		const char* outputs[] = { "main.o", NULL };
+ * 		struct _CBuild_Hermetic action = { inputs, argv, env, outputs };
+ * 		_hermeticRun(&action);
+ * @endcode
+ */
+int _hermeticRun(const struct _CBuild_Hermetic* const action)
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _hermeticRun()\n");
+#endif
+
+	assert(action->outputs[0] != NULL);
+	_actionsDrain();
+
+	struct _CBuild_Action view = { action->outputs[0], NULL, action->inputs, action->argv, CBUILD_ACTION_COMMAND };
+
+	if (_actionBlocked(&view))
+	{
+		return 0;
+	}
+
+	_graphAdd(&_cbuildGraph, &view);
+	_cbuildGraphOpaque = 1;
+
+	const char* reason = NULL;
+	struct _CBuild_Buffer description = { 0 };
+	char digest[66] = { 0 };
+
+	for (unsigned long long index = 0; action->inputs != NULL AND action->inputs[index] != NULL AND reason == NULL; ++index)
+	{
+		if (_mapGet(&_cbuildPending, action->inputs[index], NULL))
+		{
+			reason = CONCAT("input `", action->inputs[index], "` would be rebuilt");
+		}
+	}
+
+	if (reason == NULL)
+	{
+		if (_hermeticDescribe(action, &description) < 0)
+		{
+			exit(1);
+		}
+
+		_sha256Data(description.data, description.length, digest);
+		digest[64] = '\n';
+		const char* stampPath = CONCAT(action->outputs[0], CBUILD_STAMP_EXTENSION);
+		char* stamp = _readFile(stampPath, NULL);
+
+		for (unsigned long long index = 0; action->outputs[index] != NULL AND reason == NULL; ++index)
+		{
+			if (NOT _exists(action->outputs[index]))
+			{
+				reason = CONCAT("output `", action->outputs[index], "` does not exist");
+			}
+		}
+
+		if (reason == NULL AND (stamp == NULL OR strncmp(stamp, digest, 65) != 0))
+		{
+			reason = CONCAT("inputs or command of `", action->outputs[0], "` changed");
+		}
+
+		free(stamp);
+		free((void*)stampPath);
+	}
+
+	if (reason == NULL)
+	{
+		BUFFER_FREE(&description);
+		return 0;
+	}
+
+	if (_cbuildExplain)
+	{
+		ECHO(stdout, " -- "CBUILD_INFO_LABEL" Explain `%s`: %s\n", action->outputs[0], reason);
+	}
+
+	free((void*)reason);
+
+	if (_cbuildDryRun)
+	{
+		ECHO(stdout, " -- "CBUILD_INFO_LABEL" Would run: ");
+		_echoCommand(stdout, action->argv);
+
+		for (unsigned long long index = 0; action->outputs[index] != NULL; ++index)
+		{
+			_mapSet(&_cbuildPending, action->outputs[index], 1);
+		}
+
+		BUFFER_FREE(&description);
+		return 0;
+	}
+
+	struct _CBuild_Sha256 store;
+	char key[65];
+	_sha256Init(&store);
+	_sha256Update(&store, description.data, description.length);
+
+	if (_cbuildStore != NULL AND _storeDigestFiles(&store, action->inputs) < 0)
+	{
+		exit(1);
+	}
+
+	_sha256Hex(&store, key);
+
+	if (_cbuildStore != NULL AND _storeRestore(key, action->outputs))
+	{
+#if CBUILD_ECHO_LEVEL >= 1
+		ECHO(stdout, " -- "CBUILD_INFO_LABEL" Restored `%s` from store.\n", action->outputs[0]);
+#endif
+
+		BUFFER_FREE(&description);
+		_writeFile(CONCAT(action->outputs[0], CBUILD_STAMP_EXTENSION), digest, 65);
+		return 0;
+	}
+
+	int result = _cbuildExecutor != NULL ? _hermeticRemote(&description) : -1;
+
+	if (result < 0)
+	{
+		result = _hermeticLocal(action);
+	}
+
+	BUFFER_FREE(&description);
+
+	if (result != 0)
+	{
+#if CBUILD_ECHO_LEVEL >= 1
+		ECHO(stderr, CBUILD_ERROR_LABEL" Failed to build "CBUILD_ERROR("`%s`")"\n", action->outputs[0]);
+#endif
+
+		exit(1);
+	}
+
+	for (unsigned long long index = 0; action->outputs[index] != NULL; ++index)
+	{
+		STAT_FORGET(action->outputs[index]);
+	}
+
+	if (_cbuildStore != NULL)
+	{
+		_storeRecord(key, action->outputs);
+		_storeGcBackground();
+	}
+
+	_writeFile(CONCAT(action->outputs[0], CBUILD_STAMP_EXTENSION), digest, 65);
+	return 1;
+}
+
+/**
+ * Wraps @ref _hermeticRun function.
+ * 
+ * @code{.c}
+ * 		RUN_HERMETIC(&action);
+ * @endcode
+ */
+#ifndef RUN_HERMETIC
+#	define RUN_HERMETIC(action) _hermeticRun(action)
+#endif
+
+/**
+ * Sends a blob from the executor store, preceded by the header line.
+ * Returns 0 on success, and -1 otherwise.
+ */
+int _executorSendBlob(const int fd, const char* const header, const char* const blob)
+{
+	unsigned long long length = 0;
+	char* content = _readFile(blob, &length);
+
+	if (content == NULL)
+	{
+		return -1;
+	}
+
+	const int result = _writeAll(fd, header, strlen(header)) == 0 AND _writeAll(fd, content, length) == 0 ? 0 : -1;
+	free(content);
+	return result;
+}
+
+/**
+ * Stores a blob in the executor store under its SHA-256 digest. Blobs
+ * are made read only, since they are hard linked into sandboxes.
+ */
+void _executorStore(const char* const store, const void* const data, const unsigned long long length, const char* const digest)
+{
+	const char* blob = PATH(store, digest);
+
+	if (_writeFile(blob, data, length) > 0)
+	{
+		chmod(blob, 0444);
+	}
+
+	free((void*)blob);
+}
+
+/**
+ * Runs a described action in a sandbox built from the executor store,
+ * and stores its log and outputs in the store. Returns the result as
+ * a line with status, log blob and log length, followed by a line per
+ * output with its blob, length, mode and path. Successful results are
+ * recorded at record path, so the same digest is never run twice.
+ * Returns NULL if the action could not be set up, including when a
+ * staged input or an output would leave the sandbox.
+ */
+char* _executorRun(const char* const store, const char* const description, const unsigned long long length, const char* const record)
+{
+	struct _CBuild_Strings argv = { 0 };
+	struct _CBuild_Strings env = { 0 };
+	struct _CBuild_Strings outputs = { 0 };
+	const char* sandbox = _sandboxCreate();
+	int result = sandbox != NULL ? 0 : -1;
+	_stringsReserve(&env, 0);
+	_stringsReserve(&outputs, 0);
+
+	for (unsigned long long offset = 0; offset < length AND result == 0; offset += strlen(description + offset) + 1)
+	{
+		const char* item = description + offset;
+
+		if (item[0] == 'a')
+		{
+			_stringsAppend(&argv, item + 1);
+		}
+		else if (item[0] == 'e')
+		{
+			_stringsAppend(&env, item + 1);
+		}
+		else if (item[0] == 'o')
+		{
+			result = _sandboxed(item + 1) ? 0 : -1;
+			_stringsAppend(&outputs, item + 1);
+		}
+		else if (item[0] == 'i' AND strlen(item) > 66 AND item[65] == ':')
+		{
+			const char* path = item + 66;
+			char name[65];
+			memcpy(name, item + 1, 64);
+			name[64] = '\0';
+
+			if (NOT _sha256Valid(name) OR (path[0] != PATH_SEPARATOR[0] AND NOT _sandboxed(path)))
+			{
+				result = -1;
+			}
+			else if (path[0] != PATH_SEPARATOR[0])
+			{
+				const char* blob = PATH(store, name);
+				result = _sandboxStage(sandbox, blob, path);
+				free((void*)blob);
+			}
+		}
+		else
+		{
+			result = -1;
+		}
+	}
+
+	for (unsigned long long index = 0; index < outputs.count AND result == 0; ++index)
+	{
+		const char* separator = strrchr(outputs.items[index], PATH_SEPARATOR[0]);
+
+		if (separator != NULL)
+		{
+			char* parent = strndup(outputs.items[index], separator - outputs.items[index]);
+			const char* directory = PATH(sandbox, parent);
+			result = _ensureDir(directory);
+			free((void*)directory);
+			free(parent);
+		}
+	}
+
+	if (result < 0 OR argv.count == 0)
+	{
+		if (sandbox != NULL)
+		{
+			_rmReport(sandbox, _rmat(AT_FDCWD, sandbox, 1));
+			free((void*)sandbox);
+			ENSURE_DIR_FORGET();
+		}
+
+		_stringsFree(&argv);
+		_stringsFree(&env);
+		_stringsFree(&outputs);
+		return NULL;
+	}
+
+	struct _CBuild_Buffer log = { 0 };
+	struct _CBuild_Buffer entry = { 0 };
+	int status = _sandboxExec(sandbox, argv.items, env.items, &log);
+	char logHash[65];
+	_sha256Data(log.data, log.length, logHash);
+	_executorStore(store, log.data, log.length, logHash);
+
+	for (unsigned long long index = 0; index < outputs.count AND status == 0; ++index)
+	{
+		const char* produced = PATH(sandbox, outputs.items[index]);
+		unsigned long long outputLength = 0;
+		char* content = _readFile(produced, &outputLength);
+		struct stat info;
+
+		if (content == NULL OR stat(produced, &info) < 0)
+		{
+			free(content);
+			free((void*)produced);
+			status = 1;
+			continue;
+		}
+
+		char hash[65];
+		_sha256Data(content, outputLength, hash);
+		_executorStore(store, content, outputLength, hash);
+		_bufferAppendf(&entry, "%s %llu %o %s\n", hash, outputLength, (unsigned int)(info.st_mode & 0777), outputs.items[index]);
+		free(content);
+		free((void*)produced);
+	}
+
+	_rmReport(sandbox, _rmat(AT_FDCWD, sandbox, 1));
+	free((void*)sandbox);
+	ENSURE_DIR_FORGET();
+	_stringsFree(&argv);
+	_stringsFree(&env);
+	_stringsFree(&outputs);
+	char header[128];
+	sprintf(header, "%d %s %llu\n", status, logHash, log.length);
+
+	if (status != 0)
+	{
+		BUFFER_CLEAR(&entry);
+	}
+
+	const struct iovec parts[] = { { header, strlen(header) }, { entry.data, entry.length } };
+
+	if (status == 0)
+	{
+		_writeFilev(record, parts, 2);
+	}
+
+	char* content = (char*)malloc(parts[0].iov_len + parts[1].iov_len + 1);
+	memcpy(content, header, parts[0].iov_len);
+	memcpy(content + parts[0].iov_len, entry.data, entry.length);
+	content[parts[0].iov_len + entry.length] = '\0';
+	BUFFER_FREE(&log);
+	BUFFER_FREE(&entry);
+	return content;
+}
+
+/**
+ * Sends the result of an action (see @ref _executorRun) to the client:
+ * the `RESULT` line with the log, and the `OUTPUT` line with the blob
+ * for every output. An action the executor could not set up (entry is
+ * NULL) is answered with status -1, so the client runs it locally
+ * instead. Returns 0 on success, and -1 otherwise.
+ */
+int _executorReply(const int fd, const char* const store, char* const entry, const int cached)
+{
+	char* state = NULL;
+	char* line = entry != NULL ? strtok_r(entry, "\n", &state) : NULL;
+	int status = 1;
+	char logHash[65];
+	unsigned long long logLength = 0;
+
+	if (line == NULL OR sscanf(line, "%d %64s %llu", &status, logHash, &logLength) != 3)
+	{
+		const char* failure = "RESULT -1 0 0 0\n";
+		return _writeAll(fd, failure, strlen(failure));
+	}
+
+	struct _CBuild_Strings outputs = { 0 };
+
+	while ((line = strtok_r(NULL, "\n", &state)) != NULL)
+	{
+		_stringsAppend(&outputs, line);
+	}
+
+	char header[128];
+	char name[65];
+	sprintf(header, "RESULT %d %d %llu %llu\n", status, cached, logLength, outputs.count);
+	const char* blob = PATH(store, logHash);
+	int result = _executorSendBlob(fd, header, blob);
+	free((void*)blob);
+
+	for (unsigned long long index = 0; index < outputs.count AND result == 0; ++index)
+	{
+		sprintf(name, "%.64s", outputs.items[index]);
+		const char* output = CONCAT("OUTPUT ", outputs.items[index], "\n");
+		blob = PATH(store, name);
+		result = _executorSendBlob(fd, output, blob);
+		free((void*)output);
+		free((void*)blob);
+	}
+
+	_stringsFree(&outputs);
+	return result;
+}
+
+/**
+ * Serves one client connection of the executor. The protocol is line
+ * based, with blobs following their header line. Blobs and results are
+ * named by SHA-256 digests, like in the store (see @ref _storeInsert):
+ * 
+ * - `MISSING <n>` followed by n digests: replies with `MISSING <m>` and
+ *   the m digests not in the store.
+ * - `PUT <digest> <length>` followed by the blob: verifies and stores
+ *   it, replies with `OK`.
+ * - `RUN <length>` followed by the description (see
+ *   @ref _hermeticDescribe): runs the action, or reuses the recorded
+ *   result of the same digest, and replies with
+ *   `RESULT <status> <cached> <log length> <outputs>`, the log, and an
+ *   `OUTPUT <digest> <length> <mode> <path>` line with the blob for every
+ *   output. Status -1 means the action was rejected or could not be set
+ *   up, e.g. when a path leaves the sandbox.
+ */
+void _executorHandle(const int fd)
+{
+	const char* store = PATH(CBUILD_EXECUTOR_DIRECTORY, "store");
+	const char* actions = PATH(CBUILD_EXECUTOR_DIRECTORY, "actions");
+	struct _CBuild_Buffer line = { 0 };
+	struct _CBuild_Buffer reply = { 0 };
+	struct _CBuild_Buffer blob = { 0 };
+	_ensureDir(store);
+
+	while (_readLine(fd, &line) == 0)
+	{
+		unsigned long long count = 0;
+		char digest[65];
+		char received[65];
+		BUFFER_CLEAR(&reply);
+
+		if (sscanf(line.data, "MISSING %llu", &count) == 1)
+		{
+			unsigned long long missing = 0;
+			struct _CBuild_Buffer hashes = { 0 };
+
+			for (unsigned long long index = 0; index < count; ++index)
+			{
+				if (_readLine(fd, &line) < 0)
+				{
+					BUFFER_FREE(&hashes);
+					return;
+				}
+
+				if (NOT _sha256Valid(line.data))
+				{
+					BUFFER_FREE(&hashes);
+					return;
+				}
+
+				const char* blob = PATH(store, line.data);
+
+				if (NOT _isfile(blob))
+				{
+					_bufferAppendf(&hashes, "%s\n", line.data);
+					++missing;
+				}
+
+				free((void*)blob);
+			}
+
+			_bufferAppendf(&reply, "MISSING %llu\n", missing);
+			_bufferAppend(&reply, hashes.data, hashes.length);
+			BUFFER_FREE(&hashes);
+		}
+		else if (sscanf(line.data, "PUT %64s %llu", digest, &count) == 2)
+		{
+			BUFFER_CLEAR(&blob);
+			_bufferReserve(&blob, count);
+
+			if (_readAll(fd, blob.data, count) < 0)
+			{
+				return;
+			}
+
+			_sha256Data(blob.data, count, received);
+
+			if (NOT STREQL(received, digest))
+			{
+				return;
+			}
+
+			_executorStore(store, blob.data, count, digest);
+			BUFFER_APPEND(&reply, "OK\n");
+		}
+		else if (sscanf(line.data, "RUN %llu", &count) == 1)
+		{
+			BUFFER_CLEAR(&blob);
+			_bufferReserve(&blob, count);
+
+			if (_readAll(fd, blob.data, count) < 0)
+			{
+				return;
+			}
+
+			_sha256Data(blob.data, count, digest);
+			const char* record = PATH(actions, digest);
+			char* entry = _readFile(record, NULL);
+			const int cached = entry != NULL;
+
+			if (entry == NULL)
+			{
+				entry = _executorRun(store, blob.data, count, record);
+			}
+
+			const int result = _executorReply(fd, store, entry, cached);
+			free(entry);
+			free((void*)record);
+
+			if (result < 0)
+			{
+				return;
+			}
+
+			continue;
+		}
+		else
+		{
+			return;
+		}
+
+		if (_writeAll(fd, reply.data, reply.length) < 0)
+		{
+			return;
+		}
+	}
+}
+
+/**
+ * Runs a local executor daemon listening on the Unix socket path, as a
+ * stand in for a remote build farm. Every connection is served by a
+ * forked process (see @ref _executorHandle). Blobs and action results
+ * are kept in @ref CBUILD_EXECUTOR_DIRECTORY, so identical actions from
+ * any client run once. Never returns, unless the socket can not be set
+ * up, in which case it exits.
+ * 
+ * @code{.c}
+ * 		_executorServe("/tmp/cbuild.sock");
+ * @endcode
+ */
+void _executorServe(const char* const path)
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _executorServe()\n");
+#endif
+
+#ifdef _WIN32
+	assert(!"TODO: implement _executorServe with Windows WIN32 API!");
+#else
+	const int fd = _unixListen(path);
+
+	if (fd < 0)
+	{
+#if CBUILD_ECHO_LEVEL >= 1
+		ECHO(stderr, CBUILD_ERROR_LABEL" Failed to listen on executor socket `%s`: "CBUILD_ERROR("%s")"\n", path, strerror(errno));
+#endif
+
+		exit(1);
+	}
+
+#if CBUILD_ECHO_LEVEL >= 1
+	ECHO(stdout, CBUILD_INFO_LABEL" Executor is listening on `%s`.\n", path);
+	fflush(stdout);
+#endif
+
+	signal(SIGCHLD, SIG_IGN);
+
+	for (;;)
+	{
+		const int client = accept(fd, NULL, NULL);
+
+		if (client < 0)
+		{
+			continue;
+		}
+
+		fflush(stdout);
+		fflush(stderr);
+		const pid_t childProcessId = fork();
+
+		if (childProcessId == 0)
+		{
+			signal(SIGCHLD, SIG_DFL);
+			close(fd);
+			_executorHandle(client);
+			close(client);
+			_exit(0);
+		}
+
+		close(client);
+	}
+#endif
+}
+
+/**
+ * Wraps @ref _executorServe function.
+ * 
+ * @code{.c}
+ * 		SERVE_EXECUTOR("/tmp/cbuild.sock");
+ * @endcode
+ */
+#ifndef SERVE_EXECUTOR
+#	define SERVE_EXECUTOR(path) _executorServe(path)
+#endif
+
+/**
+ * @}
+ */
+
+
+
+/**
+ * @addtogroup SELFBUILDER
+ * 
+ * @{
+ */
+
+/**
+ * Checks if source file has any changes comparing to current built
+ * vesrion of the tool.
+ */
+int _isCBuildModified(const char* sourcePath, const char* binaryPath)
+{
+#ifdef _WIN32
+	assert(!"TODO: implement _isCBuildModified with Windows WIN32 API!");
+#else
+	struct stat info;
+
+	if (stat(sourcePath, &info) < 0)
+	{
+		ECHO(stderr, " -- "CBUILD_ERROR_LABEL" Could not stat %s: %s\n", sourcePath, strerror(errno));
+		exit(1);
+	}
+
+	int path1Time = info.st_mtime;
+
+	if (stat(binaryPath, &info) < 0)
+	{
+		ECHO(stderr, " -- "CBUILD_ERROR_LABEL" Could not stat %s: %s\n", binaryPath, strerror(errno));
+		exit(1);
+	}
+
+	int path2Time = info.st_mtime;
+	return path1Time > path2Time;
+#endif
+}
+
+/**
+ * Compiler used by @ref BUILD_MYSELF, defaults to the compiler the tool
+ * itself was built with.
+ */
+#ifndef CBUILD_COMPILER
+#	if defined(__clang__)
+#		define CBUILD_COMPILER "clang"
+#	elif defined(__GNUC__)
+#		define CBUILD_COMPILER "gcc"
+#	elif defined(_MSC_VER)
+#		define CBUILD_COMPILER "cl.exe"
+#	else
+#		define CBUILD_COMPILER "cc"
+#	endif
+#endif
+
+/**
+ * Intermediate step - actual building of the new executable.
+ */
+#ifndef BUILD_MYSELF
+#	if _WIN32
+#		if defined(__GNUC__)
+#			define BUILD_MYSELF(binaryPath, sourcePath) CMD("gcc", "-o", binaryPath, sourcePath)
+#		elif defined(__clang__)
+#			define BUILD_MYSELF(binaryPath, sourcePath) CMD("clang", "-o", binaryPath, sourcePath)
+#		elif defined(_MSC_VER)
+#			define BUILD_MYSELF(binaryPath, sourcePath) CMD("cl.exe", sourcePath)
+#		endif
+# 	else
+#		define BUILD_MYSELF(binaryPath, sourcePath) CMD(CBUILD_COMPILER, "-o", binaryPath, sourcePath)
+# 	endif
+#endif
+
+/**
+ * Tool being rebuilt by @ref _rebuildMyself, or NULL. The previous
+ * binary is kept next to it with `.old` extension meanwhile.
+ */
+const char* _cbuildRebuilding = NULL;
+
+/**
+ * Process rebuilding the tool, so processes forked from it do not
+ * restore the previous binary when they exit (see @ref _rebuildRestore).
+ */
+pid_t _cbuildRebuildingOwner = 0;
+
+/**
+ * Puts the previous binary back if rebuilding the tool did not finish,
+ * so a failed or interrupted rebuild leaves a working tool and no
+ * `.old` binary behind. Registered with `atexit`.
+ */
+void _rebuildRestore(void)
+{
+	if (_cbuildRebuildingOwner != getpid())
+	{
+		return;
+	}
+
+	if (_cbuildRebuilding != NULL)
+	{
+		const char* old = CONCAT(_cbuildRebuilding, ".old");
+		unlink(_cbuildRebuilding);
+		rename(old, _cbuildRebuilding);
+		free((void*)old);
+		_cbuildRebuilding = NULL;
+	}
+}
+
+/**
+ * Starts the rebuilding process for the tool. The rebuilt tool is run
+ * with the arguments recorded by @ref _options. If the rebuild fails or
+ * is interrupted, the previous binary is restored.
+ */
+void _rebuildMyself(const char* const sourcePath, const char* const binaryPath)
+{
+	if (_isCBuildModified(sourcePath, binaryPath))
+	{
+		if (_cbuildExplain)
+		{
+			ECHO(stdout, " -- "CBUILD_INFO_LABEL" Explain `%s`: input `%s` is newer than `%s`\n", binaryPath, sourcePath, binaryPath);
+		}
+
+		if (_cbuildDryRun)
+		{
+			ECHO(stdout, " -- "CBUILD_INFO_LABEL" Would rebuild CBUILD from `%s`, continuing with the current build.\n", sourcePath);
+			return;
+		}
+
+		ECHO(stdout, CBUILD_INFO_LABEL" Rebuilding CBUILD!\n");
+		_cancelSetup();
+		_cbuildRebuildingOwner = getpid();
+		atexit(_rebuildRestore);
+		MV(binaryPath, CONCAT(binaryPath, ".old"));
+		_cbuildRebuilding = binaryPath;
+		BUILD_MYSELF(binaryPath, sourcePath);
+		_cbuildRebuilding = NULL;
+		RM(CONCAT(binaryPath, ".old"));
+
+		struct _CBuild_Strings argv = { 0 };
+		_stringsAppend(&argv, binaryPath);
+
+		for (unsigned long long index = 0; _cbuildArguments != NULL AND _cbuildArguments[index] != NULL; ++index)
+		{
+			_stringsAppend(&argv, _cbuildArguments[index]);
+		}
+
+		_exec(argv.items);
+		exit(0);
+	}
+}
+
+/**
+ * Wraps @ref _rebuildMyself function.
+ */
+#ifndef REBUILD_MYSELF
+#	define REBUILD_MYSELF(program) \
+	{ \
+		const char* sourcePath = __FILE__; \
+		const char* binaryPath = program; \
+		_rebuildMyself(sourcePath, binaryPath); \
+	}
+#endif
+
+/**
+ * @}
+ */
+
+
+
+/**
+ * @addtogroup SERVER
+ * 
+ * @{
+ */
+
+/**
+ * State kept by the build server between runs: inotify watches on the
+ * directories of every path in @ref _cbuildStatCache, by directory and
+ * by watch descriptor.
+ */
+struct _CBuild_Server
+{
+	int notify;
+	struct _CBuild_Map watches;
+	const char** directories;
+	unsigned long long capacity;
+};
+
+/**
+ * Checks whether the directory containing the path is watched, so that
+ * the time of the path can be trusted, and starts watching it otherwise
+ * when asked to. A directory watched only now can not be trusted yet,
+ * since earlier changes in it went unnoticed.
+ */
+int _serverWatch(struct _CBuild_Server* const server, const char* const path, const int add)
+{
+#ifdef __linux__
+	const char* separator = strrchr(path, PATH_SEPARATOR[0]);
+	char* directory = separator == NULL ? strdup(".") : separator == path ? strdup(PATH_SEPARATOR) : strndup(path, separator - path);
+	unsigned long long watch = 0;
+
+	if (_mapGet(&server->watches, directory, &watch) AND watch != 0)
+	{
+		free(directory);
+		return 1;
+	}
+
+	if (NOT add)
+	{
+		free(directory);
+		return 0;
+	}
+
+	const int descriptor = inotify_add_watch(server->notify, directory, IN_ATTRIB | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MODIFY | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR);
+
+	if (descriptor < 0)
+	{
+		free(directory);
+		return 0;
+	}
+
+	if ((unsigned long long)descriptor >= server->capacity)
+	{
+		const unsigned long long capacity = 2 * (unsigned long long)descriptor + 64;
+		server->directories = (const char**)realloc(server->directories, capacity * sizeof(const char*));
+		memset(server->directories + server->capacity, 0, (capacity - server->capacity) * sizeof(const char*));
+		server->capacity = capacity;
+	}
+
+	server->directories[descriptor] = directory;
+	_mapSet(&server->watches, directory, descriptor + 1);
+	return 0;
+#else
+	(void)server;
+	(void)path;
+	(void)add;
+	return 0;
+#endif
+}
+
+/**
+ * Applies changes noticed by inotify since the last call to the stat
+ * cache. Changed paths are forgotten; the whole cache is forgotten when
+ * events were lost or a directory was removed or moved.
+ */
+void _serverRefresh(struct _CBuild_Server* const server)
+{
+#ifdef __linux__
+	union
+	{
+		struct inotify_event event;
+		char data[64 * 1024];
+	} buffer;
+
+	for (;;)
+	{
+		const ssize_t count = read(server->notify, buffer.data, sizeof(buffer.data));
+
+		if (count < 0 AND errno == EINTR)
+		{
+			continue;
+		}
+
+		if (count <= 0)
+		{
+			break;
+		}
+
+		for (ssize_t offset = 0; offset < count;)
+		{
+			const struct inotify_event* event = (const struct inotify_event*)(buffer.data + offset);
+			offset += sizeof(struct inotify_event) + event->len;
+			const char* directory = event->wd >= 0 AND (unsigned long long)event->wd < server->capacity ? server->directories[event->wd] : NULL;
+
+			if (event->mask & IN_IGNORED)
+			{
+				if (directory != NULL)
+				{
+					_mapSet(&server->watches, directory, 0);
+					server->directories[event->wd] = NULL;
+				}
+
+				STAT_FORGET_ALL();
+			}
+			else if (directory == NULL OR (event->mask & (IN_Q_OVERFLOW | IN_DELETE_SELF | IN_MOVE_SELF)) OR ((event->mask & IN_ISDIR) AND (event->mask & (IN_DELETE | IN_MOVED_FROM))))
+			{
+				if (event->mask & IN_MOVE_SELF)
+				{
+					inotify_rm_watch(server->notify, event->wd);
+				}
+
+				STAT_FORGET_ALL();
+			}
+			else if (event->len > 0)
+			{
+				const char* path = STREQL(directory, ".") ? strdup(event->name) : STREQL(directory, PATH_SEPARATOR) ? CONCAT(PATH_SEPARATOR, event->name) : PATH(directory, event->name);
+				STAT_FORGET(path);
+				free((void*)path);
+			}
+		}
+	}
+#else
+	(void)server;
+	STAT_FORGET_ALL();
+#endif
+}
+
+/**
+ * Waits for the run forked by the server while collecting its lookups
+ * from the report pipe. Stops the run if the client goes away. Adds the
+ * reported times to the stat cache for directories watched during the
+ * whole run, and watches the rest afterwards. Returns the wait status of
+ * the run.
+ */
+int _serverCollect(struct _CBuild_Server* const server, const pid_t pid, const int report, const int client)
+{
+	struct _CBuild_Buffer reports = { 0 };
+	char chunk[16 * 1024];
+	int status = 0;
+	int running = 1;
+	int stopped = 0;
+
+	while (running)
+	{
+		struct pollfd pollers[2] = { { report, POLLIN, 0 }, { client, POLLIN, 0 } };
+		const int ready = poll(pollers, stopped ? 1 : 2, 100);
+
+		if (ready > 0 AND pollers[0].revents != 0)
+		{
+			const ssize_t count = read(report, chunk, sizeof(chunk));
+
+			if (count > 0)
+			{
+				_bufferAppend(&reports, chunk, count);
+				continue;
+			}
+
+			if (count == 0)
+			{
+				running = waitpid(pid, &status, 0) != pid;
+				continue;
+			}
+		}
+
+		if (ready > 0 AND NOT stopped AND pollers[1].revents != 0)
+		{
+			kill(pid, SIGTERM);
+			stopped = 1;
+		}
+
+		if (waitpid(pid, &status, WNOHANG) == pid)
+		{
+			running = 0;
+		}
+	}
+
+	fcntl(report, F_SETFL, O_NONBLOCK);
+
+	for (ssize_t count = read(report, chunk, sizeof(chunk)); count > 0; count = read(report, chunk, sizeof(chunk)))
+	{
+		_bufferAppend(&reports, chunk, count);
+	}
+
+	_bufferAppend(&reports, "", 1);
+
+	for (int add = 0; add <= 1; ++add)
+	{
+		for (char* line = reports.data; *line != '\0';)
+		{
+			char* end = strchr(line, '\n');
+
+			if (end == NULL)
+			{
+				break;
+			}
+
+			*end = '\0';
+			char* path = NULL;
+			const long long mtime = strtoll(line, &path, 10);
+
+			if (*path == ' ' AND _serverWatch(server, path + 1, add) AND NOT add)
+			{
+				_mapSet(&_cbuildStatCache, path + 1, mtime < 0 ? 1 : (unsigned long long)mtime + 2);
+			}
+
+			*end = '\n';
+			line = end + 1;
+		}
+	}
+
+	BUFFER_FREE(&reports);
+	return status;
+}
+
+/**
+ * Receives a request: the standard streams of the client, and its
+ * working directory followed by its arguments. Returns 0 on success, and
+ * -1 otherwise.
+ */
+int _serverReceive(const int client, int* const streams, struct _CBuild_Strings* const arguments)
+{
+	unsigned long long length = 0;
+	char control[CMSG_SPACE(3 * sizeof(int))] = { 0 };
+	struct iovec part = { &length, sizeof(length) };
+	struct msghdr message = { 0 };
+	message.msg_iov = &part;
+	message.msg_iovlen = 1;
+	message.msg_control = control;
+	message.msg_controllen = sizeof(control);
+
+	if (recvmsg(client, &message, MSG_WAITALL | MSG_CMSG_CLOEXEC) != sizeof(length))
+	{
+		return -1;
+	}
+
+	const struct cmsghdr* header = CMSG_FIRSTHDR(&message);
+
+	if (header == NULL OR header->cmsg_type != SCM_RIGHTS OR header->cmsg_len != CMSG_LEN(3 * sizeof(int)))
+	{
+		return -1;
+	}
+
+	memcpy(streams, CMSG_DATA(header), 3 * sizeof(int));
+	char* payload = (char*)malloc(length + 1);
+
+	if (length == 0 OR _readAll(client, payload, length) < 0)
+	{
+		free(payload);
+		return -1;
+	}
+
+	payload[length] = '\0';
+
+	for (unsigned long long offset = 0; offset < length; offset += strlen(payload + offset) + 1)
+	{
+		_stringsAppendCopy(arguments, payload + offset);
+	}
+
+	free(payload);
+	return 0;
+}
+
+/**
+ * Serves builds on the Unix socket, for clients started with
+ * `--connect` (see @ref _serverForward). Every request is run by a fork
+ * of the server, with the standard streams and arguments of the client,
+ * so it starts warm: without loading the tool or checking whether it
+ * needs rebuilding, and with modification times of every path earlier
+ * runs looked up in @ref _cbuildStatCache, kept fresh by inotify. Runs
+ * are served one at a time, in the working directory of the server;
+ * requests from other directories are refused. Exits once the tool
+ * changes, so clients fall back to rebuilding it and running alone.
+ * 
+ * @code{.c}
+ * 		_serve(".cbuild/server.sock", program, __FILE__, _main);
+ * @endcode
+ */
+void _serve(const char* const path, const char* const program, const char* const sourcePath, int (*entry)(const char* const, int, char**))
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _serve()\n");
+#endif
+
+#ifdef _WIN32
+	assert(!"TODO: implement _serve with Windows WIN32 API!");
+#else
+	struct _CBuild_Server server = { 0 };
+	char directory[PATH_MAX];
+	const int fd = _ensureParent(path) < 0 ? -1 : _unixListen(path);
+
+	if (fd < 0 OR getcwd(directory, sizeof(directory)) == NULL)
+	{
+#if CBUILD_ECHO_LEVEL >= 1
+		ECHO(stderr, CBUILD_ERROR_LABEL" Failed to listen on server socket `%s`: "CBUILD_ERROR("%s")"\n", path, strerror(errno));
+#endif
+
+		exit(1);
+	}
+
+#ifdef __linux__
+	server.notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+
+	struct stat info;
+	const long long built = stat(program, &info) < 0 ? -1 : (long long)info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec;
+
+#if CBUILD_ECHO_LEVEL >= 1
+	ECHO(stdout, CBUILD_INFO_LABEL" Build server is listening on `%s`.\n", path);
+	fflush(stdout);
+#endif
+
+	for (;;)
+	{
+		const int client = accept(fd, NULL, NULL);
+
+		if (client < 0)
+		{
+			continue;
+		}
+
+		int streams[3] = { -1, -1, -1 };
+		struct _CBuild_Strings arguments = { 0 };
+
+		if (_serverReceive(client, streams, &arguments) < 0)
+		{
+			for (int index = 0; index < 3; ++index)
+			{
+				if (streams[index] >= 0)
+				{
+					close(streams[index]);
+				}
+			}
+
+			close(client);
+			_stringsFree(&arguments);
+			continue;
+		}
+
+		_serverRefresh(&server);
+		const int stale = _isCBuildModified(sourcePath, program) OR stat(program, &info) < 0
+			OR (long long)info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec != built;
+		int result = -1;
+		int report[2] = { -1, -1 };
+
+		if (NOT stale AND STREQL(arguments.items[0], directory) AND pipe2(report, O_CLOEXEC) == 0)
+		{
+			fflush(stdout);
+			fflush(stderr);
+			const pid_t pid = fork();
+
+			if (pid == 0)
+			{
+				close(fd);
+				close(client);
+				close(report[0]);
+
+				for (int index = 0; index < 3; ++index)
+				{
+					dup2(streams[index], index);
+					close(streams[index]);
+				}
+
+				_cbuildStatReport = report[1];
+				atexit(_statReportFlush);
+
+				int argc = (int)arguments.count - 1;
+				char** argv = (char**)malloc(arguments.count * sizeof(char*));
+				memcpy(argv, arguments.items + 1, (arguments.count - 1) * sizeof(char*));
+				argv[argc] = NULL;
+				_options(&argc, argv);
+				exit(entry(program, argc, argv));
+			}
+
+			close(report[1]);
+
+			if (pid > 0)
+			{
+				const int status = _serverCollect(&server, pid, report[0], client);
+				result = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+			}
+
+			close(report[0]);
+		}
+
+		for (int index = 0; index < 3; ++index)
+		{
+			close(streams[index]);
+		}
+
+		_writeAll(client, &result, sizeof(result));
+		close(client);
+		_stringsFree(&arguments);
+
+		if (stale)
+		{
+#if CBUILD_ECHO_LEVEL >= 1
+			ECHO(stdout, CBUILD_INFO_LABEL" Build server exits, since `%s` changed.\n", program);
+#endif
+
+			unlink(path);
+			exit(0);
+		}
+	}
+#endif
+}
+
+/**
+ * Forwards this run to the build server on the Unix socket: its standard
+ * streams, working directory and arguments (see @ref _options), except
+ * those selecting the server. The output of the run streams straight to
+ * the streams of the client. Returns the exit code of the run, or -1 if
+ * the server is not running or refused it, in which case the run should
+ * proceed locally.
+ * 
+ * @code{.c}
+ * 		const int status = _serverForward(".cbuild/server.sock");
+ * @endcode
+ */
+int _serverForward(const char* const path)
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _serverForward()\n");
+#endif
+
+#ifdef _WIN32
+	assert(!"TODO: implement _serverForward with Windows WIN32 API!");
+#else
+	char directory[PATH_MAX];
+
+	if (getcwd(directory, sizeof(directory)) == NULL)
+	{
+		return -1;
+	}
+
+	const int fd = _executorConnect(path);
+
+	if (fd < 0)
+	{
+		return -1;
+	}
+
+	struct _CBuild_Buffer payload = { 0 };
+	_bufferAppend(&payload, directory, strlen(directory) + 1);
+
+	for (unsigned long long index = 0; _cbuildArguments != NULL AND _cbuildArguments[index] != NULL; ++index)
+	{
+		if ((STREQL(_cbuildArguments[index], "--connect") OR STREQL(_cbuildArguments[index], "--server")) AND _cbuildArguments[index + 1] != NULL)
+		{
+			++index;
+			continue;
+		}
+
+		_bufferAppend(&payload, _cbuildArguments[index], strlen(_cbuildArguments[index]) + 1);
+	}
+
+	const int streams[3] = { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO };
+	char control[CMSG_SPACE(sizeof(streams))] = { 0 };
+	unsigned long long length = payload.length;
+	struct iovec part = { &length, sizeof(length) };
+	struct msghdr message = { 0 };
+	message.msg_iov = &part;
+	message.msg_iovlen = 1;
+	message.msg_control = control;
+	message.msg_controllen = sizeof(control);
+	struct cmsghdr* header = CMSG_FIRSTHDR(&message);
+	header->cmsg_level = SOL_SOCKET;
+	header->cmsg_type = SCM_RIGHTS;
+	header->cmsg_len = CMSG_LEN(sizeof(streams));
+	memcpy(CMSG_DATA(header), streams, sizeof(streams));
+
+	fflush(stdout);
+	fflush(stderr);
+	int result = -1;
+
+	if (sendmsg(fd, &message, MSG_NOSIGNAL) != sizeof(length) OR _writeAll(fd, payload.data, payload.length) < 0 OR _readAll(fd, &result, sizeof(result)) < 0)
+	{
+		result = -1;
+	}
+
+	close(fd);
+	BUFFER_FREE(&payload);
+	return result;
+#endif
+}
+
+/**
+ * Hands the run over to the build server, as selected by @ref _options:
+ * serves builds with `--server`, or forwards the run with `--connect`
+ * and exits with its result. Returns only when neither applies, or the
+ * server could not take the run. Expected right after
+ * @ref REBUILD_MYSELF, with the function running the build.
+ * 
+ * @code{.c}
+ * 		REBUILD_MYSELF(program);
+ * 		SERVER(program, _main);
+ * 		return _main(program, argc, argv);
+ * @endcode
+ */
+#ifndef SERVER
+#	define SERVER(program, entry) \
+	{ \
+		if (_cbuildServer != NULL) \
+		{ \
+			_serve(_cbuildServer, program, __FILE__, entry); \
+		} \
+		if (_cbuildConnect != NULL) \
+		{ \
+			const int _cbuildResult = _serverForward(_cbuildConnect); \
+			if (_cbuildResult >= 0) \
+			{ \
+				exit(_cbuildResult); \
+			} \
+		} \
+	}
+#endif
+
+/**
+ * @}
+ */
+
+
+
+/**
+ * @addtogroup TEST
+ * 
+ * @{
+ */
+
+#ifndef CBUILD_TEST_DIRECTORY
+#	define CBUILD_TEST_DIRECTORY PATH(CBUILD_CACHE_DIRECTORY, "tests")
+#endif
+
+/**
+ * Seconds a test may run before it is killed, unless given explicitly
+ * to @ref _addTestv.
+ */
+#ifndef CBUILD_TEST_TIMEOUT
+#	define CBUILD_TEST_TIMEOUT 300
+#endif
+
+/**
+ * Describes a test executable: its name, NULL terminated argument vector
+ * and timeout in seconds, along with the state of its run.
+ */
+struct _CBuild_Test
+{
+	const char* name;
+	const char** argv;
+	unsigned long long timeout;
+	long long duration;
+	long long started;
+	pid_t pid;
+	int status;
+	int timedOut;
+};
+
+/**
+ * Tests added by @ref _addTestv, in order.
+ */
+struct _CBuild_Tests
+{
+	struct _CBuild_Test* items;
+	unsigned long long count;
+	unsigned long long capacity;
+	struct _CBuild_Arena arena;
+};
+
+struct _CBuild_Tests _cbuildTests = { 0 };
+
+/**
+ * Returns path of the file capturing output of the test.
+ */
+const char* _testLog(const struct _CBuild_Test* const test)
+{
+	char* name = strdup(test->name);
+
+	for (char* character = name; *character != '\0'; ++character)
+	{
+		if (NOT ((*character >= 'a' AND *character <= 'z') OR (*character >= 'A' AND *character <= 'Z') OR (*character >= '0' AND *character <= '9') OR *character == '-' OR *character == '.'))
+		{
+			*character = '_';
+		}
+	}
+
+	const char* path = PATH(CBUILD_TEST_DIRECTORY, CONCAT(name, ".log"));
+	free(name);
+	return path;
+}
+
+/**
+ * Adds a test running the argument vector, to be run by @ref _runTests.
+ * The test passes if it exits with code 0 within timeout seconds (0 for
+ * @ref CBUILD_TEST_TIMEOUT). Exits if its name maps to the same log as
+ * the name of an earlier test (see @ref _testLog), such as `a b` and
+ * `a_b`.
+ * 
+ * @code{.c}
+ * 		const char* argv[] = { PATH("build", "tests.out"), "--fast", NULL };
+ * 		_addTestv("unit", argv, 60);
+ * @endcode
+ */
+void _addTestv(const char* const name, const char* const* argv, const unsigned long long timeout)
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _addTestv()\n");
+#endif
+
+	assert(argv[0] != NULL);
+
+	if (_cbuildTests.count == _cbuildTests.capacity)
+	{
+		_cbuildTests.capacity = _cbuildTests.capacity > 0 ? 2 * _cbuildTests.capacity : 64;
+		_cbuildTests.items = (struct _CBuild_Test*)realloc(_cbuildTests.items, _cbuildTests.capacity * sizeof(struct _CBuild_Test));
+	}
+
+	struct _CBuild_Test* test = &_cbuildTests.items[_cbuildTests.count];
+	memset(test, 0, sizeof(struct _CBuild_Test));
+	test->name = _arenaStrdup(&_cbuildTests.arena, name);
+	const char* log = _testLog(test);
+
+	for (unsigned long long index = 0; index < _cbuildTests.count; ++index)
+	{
+		const char* other = _testLog(&_cbuildTests.items[index]);
+		const int same = STREQL(log, other);
+		free((void*)other);
+
+		if (same)
+		{
+#if CBUILD_ECHO_LEVEL >= 1
+			ECHO(stderr, CBUILD_ERROR_LABEL" Test "CBUILD_ERROR("`%s`")" would share log `%s` with test `%s`\n", name, log, _cbuildTests.items[index].name);
+#endif
+
+			exit(1);
+		}
+	}
+
+	free((void*)log);
+	test->argv = _arenaStrdupv(&_cbuildTests.arena, argv);
+	test->timeout = timeout > 0 ? timeout : CBUILD_TEST_TIMEOUT;
+	test->duration = -1;
+	++_cbuildTests.count;
+}
+
+/**
+ * Wraps @ref _addTestv function with variadic arguments and the default
+ * timeout.
+ */
+void _addTest(const char* const name, ...)
+{
+	struct _CBuild_Strings argv = { 0 };
+	va_list args;
+
+	FOREACH_ARG_IN_VA_ARGS(name, const char*, arg, args,
+	{
+		_stringsAppend(&argv, arg);
+	});
+
+	_addTestv(name, argv.items, 0);
+	_stringsFree(&argv);
+}
+
+/**
+ * Wraps @ref _addTest function. The variadic arguments are the argument
+ * vector of the test.
+ * 
+ * @code{.c}
+ * 		ADD_TEST("unit", PATH("build", "tests.out"), "--fast");
+ * @endcode
+ */
+#ifndef ADD_TEST
+#	define ADD_TEST(name, ...) _addTest(name, __VA_ARGS__, NULL)
+#endif
+
+/**
+ * Orders tests by name, to assign them to shards the same way on every
+ * machine.
+ */
+int _compareTestNames(const void* const left, const void* const right)
+{
+	return strcmp((*(const struct _CBuild_Test* const*)left)->name, (*(const struct _CBuild_Test* const*)right)->name);
+}
+
+/**
+ * Selects tests of the shard given by `--shard I/N` (see @ref _options)
+ * into selected, which has room for all tests: every N-th test by name,
+ * starting with the I-th. Returns the number of selected tests.
+ */
+unsigned long long _testsShard(struct _CBuild_Test** const selected)
+{
+	unsigned long long count = 0;
+
+	for (unsigned long long index = 0; index < _cbuildTests.count; ++index)
+	{
+		selected[index] = &_cbuildTests.items[index];
+	}
+
+	qsort(selected, _cbuildTests.count, sizeof(struct _CBuild_Test*), _compareTestNames);
+
+	for (unsigned long long index = 0; index < _cbuildTests.count; ++index)
+	{
+		if (index % _cbuildShards == _cbuildShard - 1)
+		{
+			selected[count++] = selected[index];
+		}
+	}
+
+	return count;
+}
+
+/**
+ * Orders tests slowest first by recorded duration, tests without one
+ * first of all, so the longest ones do not end up running alone at the
+ * end.
+ */
+int _compareTestDurations(const void* const left, const void* const right)
+{
+	const struct _CBuild_Test* first = *(const struct _CBuild_Test* const*)left;
+	const struct _CBuild_Test* second = *(const struct _CBuild_Test* const*)right;
+	const long long a = first->duration < 0 ? LLONG_MAX : first->duration;
+	const long long b = second->duration < 0 ? LLONG_MAX : second->duration;
+
+	if (a != b)
+	{
+		return a > b ? -1 : 1;
+	}
+
+	return first < second ? -1 : first > second ? 1 : 0;
+}
+
+/**
+ * Starts the test with output captured to its log, in its own process
+ * group so that the whole group can be killed on timeout.
+ */
+void _testSpawn(struct _CBuild_Test* const test)
+{
+#ifdef _WIN32
+	assert(!"TODO: implement _testSpawn with Windows WIN32 API!");
+#else
+	const char* log = _testLog(test);
+	fflush(stdout);
+	fflush(stderr);
+	test->started = _now();
+	test->pid = fork();
+
+	if (test->pid == -1)
+	{
+#if CBUILD_ECHO_LEVEL >= 1
+		ECHO(stderr, CBUILD_ERROR_LABEL" Failed to fork child process: "CBUILD_ERROR("%s")"\n", strerror(errno));
+#endif
+
+		exit(1);
+	}
+
+	if (test->pid == 0)
+	{
+		const int input = open("/dev/null", O_RDONLY);
+		const int output = open(log, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+		if (input < 0 OR output < 0)
+		{
+			_exit(127);
+		}
+
+		setpgid(0, 0);
+		dup2(input, STDIN_FILENO);
+		dup2(output, STDOUT_FILENO);
+		dup2(output, STDERR_FILENO);
+		sigset_t signals;
+		sigemptyset(&signals);
+		sigprocmask(SIG_SETMASK, &signals, NULL);
+		execvp(test->argv[0], (char* const*)test->argv);
+		ECHO(stderr, CBUILD_ERROR_LABEL" Could not exec child process: %s\n", strerror(errno));
+		_exit(127);
+	}
+
+	setpgid(test->pid, test->pid);
+	free((void*)log);
+#endif
+}
+
+/**
+ * Reports the finished test, printing its captured output if it failed.
+ * Returns 0 if it passed, and 1 otherwise.
+ */
+int _testReport(const struct _CBuild_Test* const test)
+{
+	const double seconds = test->duration / 1e9;
+
+	if (NOT test->timedOut AND WIFEXITED(test->status) AND WEXITSTATUS(test->status) == 0)
+	{
+#if CBUILD_ECHO_LEVEL >= 1
+		ECHO(stdout, " -- "CBUILD_INFO_LABEL" Test `%s` passed in %.2f s.\n", test->name, seconds);
+#endif
+
+		return 0;
+	}
+
+#if CBUILD_ECHO_LEVEL >= 1
+	const char* log = _testLog(test);
+	char* output = _readFile(log, NULL);
+
+	if (test->timedOut)
+	{
+		ECHO(stderr, CBUILD_ERROR_LABEL" Test "CBUILD_ERROR("`%s`")" timed out after %llu s, output in `%s`:\n", test->name, test->timeout, log);
+	}
+	else if (WIFEXITED(test->status))
+	{
+		ECHO(stderr, CBUILD_ERROR_LABEL" Test "CBUILD_ERROR("`%s`")" exited with code %d in %.2f s, output in `%s`:\n", test->name, WEXITSTATUS(test->status), seconds, log);
+	}
+	else
+	{
+		ECHO(stderr, CBUILD_ERROR_LABEL" Test "CBUILD_ERROR("`%s`")" was terminated by signal %d in %.2f s, output in `%s`:\n", test->name, WTERMSIG(test->status), seconds, log);
+	}
+
+	if (output != NULL)
+	{
+		fputs(output, stderr);
+		free(output);
+	}
+
+	free((void*)log);
+#endif
+
+	return 1;
+}
+
+/**
+ * Runs the tests added by @ref _addTestv, as many at once as
+ * @ref _cbuildJobs allows, killing those exceeding their timeout. Output
+ * of each test is captured in @ref CBUILD_TEST_DIRECTORY and printed
+ * only if it failed, and processes it left behind are killed. Tests are
+ * ordered slowest first by durations recorded by earlier runs. With
+ * `--shard I/N` (see @ref _options), only every N-th test by name,
+ * starting with the I-th, runs. SIGINT, SIGTERM or SIGHUP terminates the
+ * running tests (see @ref _terminateGroups) and exits. Returns the
+ * number of failed tests.
+ * 
+ * @code{.c}
+ * 		if (_runTests() > 0) exit(1);
+ * @endcode
+ */
+unsigned long long _runTests(void)
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _runTests()\n");
+#endif
+
+#ifdef _WIN32
+	assert(!"TODO: implement _runTests with Windows WIN32 API!");
+#else
+	_actionsWait();
+
+	struct _CBuild_Map durations = { 0 };
+	_durationsLoad(PATH(CBUILD_TEST_DIRECTORY, "durations"), &durations);
+
+	struct _CBuild_Test** selected = (struct _CBuild_Test**)malloc((_cbuildTests.count + 1) * sizeof(struct _CBuild_Test*));
+	const unsigned long long count = _testsShard(selected);
+
+	for (unsigned long long index = 0; index < count; ++index)
+	{
+		unsigned long long recorded = 0;
+		selected[index]->duration = _mapGet(&durations, selected[index]->name, &recorded) AND recorded > 0 ? (long long)(recorded - 1) * 1000000LL : -1;
+	}
+
+	qsort(selected, count, sizeof(struct _CBuild_Test*), _compareTestDurations);
+
+#if CBUILD_ECHO_LEVEL >= 1
+	ECHO(stdout, CBUILD_INFO_LABEL" Running %llu of %llu tests...\n", count, _cbuildTests.count);
+#endif
+
+	if (_cbuildDryRun)
+	{
+		for (unsigned long long index = 0; index < count; ++index)
+		{
+			ECHO(stdout, " -- "CBUILD_INFO_LABEL" Would run test `%s`: ", selected[index]->name);
+			_echoCommand(stdout, selected[index]->argv);
+		}
+
+		free(selected);
+		return 0;
+	}
+
+	if (_ensureDir(CBUILD_TEST_DIRECTORY) < 0)
+	{
+#if CBUILD_ECHO_LEVEL >= 1
+		ECHO(stderr, CBUILD_ERROR_LABEL" Failed to create directory `%s`: "CBUILD_ERROR("%s")"\n", CBUILD_TEST_DIRECTORY, strerror(errno));
+#endif
+
+		exit(1);
+	}
+
+	if (_cbuildJobs == 0)
+	{
+		const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+		_cbuildJobs = processors > 0 ? (unsigned long long)processors : 1;
+	}
+
+	sigset_t signals;
+	sigset_t previous;
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGCHLD);
+	sigaddset(&signals, SIGINT);
+	sigaddset(&signals, SIGTERM);
+	sigaddset(&signals, SIGHUP);
+	sigprocmask(SIG_BLOCK, &signals, &previous);
+
+	struct _CBuild_Test** running = (struct _CBuild_Test**)malloc((_cbuildJobs + 1) * sizeof(struct _CBuild_Test*));
+	unsigned long long runningCount = 0;
+	unsigned long long next = 0;
+	unsigned long long failed = 0;
+
+	while (next < count OR runningCount > 0)
+	{
+		while (next < count AND runningCount < _cbuildJobs)
+		{
+			_testSpawn(selected[next]);
+			running[runningCount++] = selected[next++];
+		}
+
+		long long deadline = LLONG_MAX;
+
+		for (unsigned long long index = 0; index < runningCount; ++index)
+		{
+			const long long end = running[index]->started + (long long)running[index]->timeout * 1000000000LL;
+			deadline = end < deadline ? end : deadline;
+		}
+
+		const long long remaining = deadline - _now();
+
+		if (remaining > 0)
+		{
+			const struct timespec wait = { remaining / 1000000000LL, remaining % 1000000000LL };
+			const int received = sigtimedwait(&signals, NULL, &wait);
+
+			if (received > 0 AND received != SIGCHLD)
+			{
+				pid_t* pids = (pid_t*)malloc((runningCount + 1) * sizeof(pid_t));
+
+				for (unsigned long long index = 0; index < runningCount; ++index)
+				{
+					pids[index] = running[index]->pid;
+				}
+
+				sigprocmask(SIG_SETMASK, &previous, NULL);
+				_cbuildCancelled = received;
+				_terminateGroups(pids, runningCount);
+				free(pids);
+				_cancelExit();
+			}
+		}
+
+		const long long now = _now();
+
+		for (unsigned long long index = 0; index < runningCount;)
+		{
+			struct _CBuild_Test* test = running[index];
+			int status = 0;
+			const pid_t pid = waitpid(test->pid, &status, WNOHANG);
+
+			if (pid == 0 AND now >= test->started + (long long)test->timeout * 1000000000LL)
+			{
+				kill(-test->pid, SIGKILL);
+				waitpid(test->pid, &status, 0);
+				test->timedOut = 1;
+			}
+			else if (pid == 0)
+			{
+				++index;
+				continue;
+			}
+
+			test->status = status;
+			test->duration = _now() - test->started;
+			kill(-test->pid, SIGKILL);
+			failed += _testReport(test);
+			_mapSet(&durations, test->name, test->duration / 1000000LL + 1);
+			running[index] = running[--runningCount];
+		}
+	}
+
+	sigprocmask(SIG_SETMASK, &previous, NULL);
+
+	_durationsSave(PATH(CBUILD_TEST_DIRECTORY, "durations"), &durations);
+	free(running);
+	free(selected);
+
+#if CBUILD_ECHO_LEVEL >= 1
+	if (failed > 0)
+	{
+		ECHO(stderr, CBUILD_ERROR_LABEL" "CBUILD_ERROR("%llu")" of %llu tests failed.\n", failed, count);
+	}
+	else
+	{
+		ECHO(stdout, CBUILD_INFO_LABEL" All %llu tests passed.\n", count);
+	}
+#endif
+
+	return failed;
+#endif
+}
+
+/**
+ * Wraps @ref _runTests function.
+ * 
+ * @code{.c}
+ * 		if (RUN_TESTS() > 0) exit(1);
+ * @endcode
+ */
+#ifndef RUN_TESTS
+#	define RUN_TESTS() _runTests()
+#endif
+
+/**
+ * @}
+ */
+
+
+
+/**
+ * @addtogroup CONFIGURE
+ * 
+ * @{
+ */
+
+#ifndef CBUILD_CONFIGURE_DIRECTORY
+#	define CBUILD_CONFIGURE_DIRECTORY PATH(CBUILD_CACHE_DIRECTORY, "configure")
+#endif
+
+#define CBUILD_SNAPSHOT_MAGIC "CBGRAPH1"
+
+/**
+ * Appends a number to a snapshot.
+ */
+void _snapshotNumber(struct _CBuild_Buffer* const snapshot, const unsigned long long number)
+{
+	_bufferAppend(snapshot, &number, sizeof(number));
+}
+
+/**
+ * Appends a length prefixed string to a snapshot, NULL is written as
+ * the largest length.
+ */
+void _snapshotString(struct _CBuild_Buffer* const snapshot, const char* const string)
+{
+	const unsigned long long length = string != NULL ? strlen(string) : ULLONG_MAX;
+	_snapshotNumber(snapshot, length);
+
+	if (string != NULL)
+	{
+		_bufferAppend(snapshot, string, length);
+	}
+}
+
+/**
+ * Appends a count prefixed NULL terminated array of strings to a
+ * snapshot.
+ */
+void _snapshotStrings(struct _CBuild_Buffer* const snapshot, const char* const* strings)
+{
+	unsigned long long count = 0;
+
+	while (strings[count] != NULL)
+	{
+		++count;
+	}
+
+	_snapshotNumber(snapshot, count);
+
+	for (unsigned long long index = 0; index < count; ++index)
+	{
+		_snapshotString(snapshot, strings[index]);
+	}
+}
+
+/**
+ * Position in a snapshot being read. Once reading runs past the end,
+ * it is marked as failed and all further reads return nothing.
+ */
+struct _CBuild_SnapshotReader
+{
+	const char* data;
+	unsigned long long length;
+	unsigned long long offset;
+	int failed;
+	struct _CBuild_Arena* arena;
+};
+
+/**
+ * Reads a number from a snapshot.
+ */
+unsigned long long _snapshotReadNumber(struct _CBuild_SnapshotReader* const reader)
+{
+	unsigned long long number = 0;
+
+	if (reader->failed OR reader->length - reader->offset < sizeof(number))
+	{
+		reader->failed = 1;
+		return 0;
+	}
+
+	memcpy(&number, reader->data + reader->offset, sizeof(number));
+	reader->offset += sizeof(number);
+	return number;
+}
+
+/**
+ * Reads a string from a snapshot into its arena.
+ */
+const char* _snapshotReadString(struct _CBuild_SnapshotReader* const reader)
+{
+	const unsigned long long length = _snapshotReadNumber(reader);
+
+	if (reader->failed OR length == ULLONG_MAX)
+	{
+		return NULL;
+	}
+
+	if (reader->length - reader->offset < length)
+	{
+		reader->failed = 1;
+		return NULL;
+	}
+
+	char* string = (char*)_arenaAlloc(reader->arena, length + 1);
+	memcpy(string, reader->data + reader->offset, length);
+	string[length] = '\0';
+	reader->offset += length;
+	return string;
+}
+
+/**
+ * Reads an array of strings from a snapshot into its arena.
+ */
+const char** _snapshotReadStrings(struct _CBuild_SnapshotReader* const reader)
+{
+	const unsigned long long count = _snapshotReadNumber(reader);
+
+	if (reader->failed OR count > reader->length)
+	{
+		reader->failed = 1;
+		return NULL;
+	}
+
+	const char** strings = (const char**)_arenaAlloc(reader->arena, (count + 1) * sizeof(const char*));
+
+	for (unsigned long long index = 0; index < count; ++index)
+	{
+		strings[index] = _snapshotReadString(reader);
+	}
+
+	strings[count] = NULL;
+	return reader->failed ? NULL : strings;
+}
+
+/**
+ * Writes the snapshot of the configuration: every path it probed (see
+ * @ref _cbuildProbes) with its current state, and the actions it
+ * added to the graph starting with the first one.
+ */
+void _snapshotSave(const char* const path, const unsigned long long key, const unsigned long long first)
+{
+	struct _CBuild_Buffer snapshot = { 0 };
+	_bufferAppend(&snapshot, CBUILD_SNAPSHOT_MAGIC, 8);
+	_snapshotNumber(&snapshot, key);
+	_snapshotNumber(&snapshot, _cbuildProbes.count);
+
+	for (unsigned long long index = 0; index < _cbuildProbes.capacity; ++index)
+	{
+		if (_cbuildProbes.keys[index] != NULL)
+		{
+			_snapshotString(&snapshot, _cbuildProbes.keys[index]);
+			_snapshotNumber(&snapshot, (unsigned long long)_probeState(_cbuildProbes.keys[index]));
+		}
+	}
+
+	_snapshotNumber(&snapshot, _cbuildGraph.count - first);
+
+	for (unsigned long long index = first; index < _cbuildGraph.count; ++index)
+	{
+		const struct _CBuild_Action* action = &_cbuildGraph.actions[index];
+		_snapshotNumber(&snapshot, action->kind);
+		_snapshotString(&snapshot, action->output);
+		_snapshotString(&snapshot, action->depfile);
+		_snapshotStrings(&snapshot, action->inputs);
+		_snapshotStrings(&snapshot, action->argv);
+	}
+
+	if (_writeFile(path, snapshot.data, snapshot.length) < 0)
+	{
+#if CBUILD_ECHO_LEVEL >= 1
+		ECHO(stderr, " -- "CBUILD_WARNING_LABEL" Failed to write configuration snapshot `%s`: "CBUILD_WARNING("%s")"\n", path, strerror(errno));
+#endif
+	}
+
+	BUFFER_FREE(&snapshot);
+}
+
+/**
+ * Prepares staleness checks of all replayed actions at once: reads their
+ * stamps and depfiles in one batch, which @ref _actionStale then takes
+ * over, and looks up their outputs, inputs and prerequisites listed in
+ * depfiles in another (see @ref _statPrefetch).
+ */
+void _replayPrefetch(const struct _CBuild_Action* const actions, const unsigned long long count)
+{
+	struct _CBuild_Strings paths = { 0 };
+
+	for (unsigned long long index = 0; index < count; ++index)
+	{
+		const char* stampPath = CONCAT(actions[index].output, CBUILD_STAMP_EXTENSION);
+		_stringsAppend(&paths, _arenaStrdup(&paths.arena, stampPath));
+		free((void*)stampPath);
+
+		if (actions[index].depfile != NULL)
+		{
+			_stringsAppend(&paths, actions[index].depfile);
+		}
+	}
+
+	_readAhead(paths.items, paths.count);
+	_stringsFree(&paths);
+	struct _CBuild_Strings discovered = { 0 };
+
+	for (unsigned long long index = 0; index < count; ++index)
+	{
+		_stringsAppend(&paths, actions[index].output);
+
+		for (unsigned long long input = 0; actions[index].inputs != NULL AND actions[index].inputs[input] != NULL; ++input)
+		{
+			_stringsAppend(&paths, actions[index].inputs[input]);
+		}
+
+		unsigned long long ahead = 0;
+
+		if (actions[index].depfile != NULL AND _mapGet(&_cbuildReadAhead, actions[index].depfile, &ahead) AND ahead != 0
+			AND ((struct _CBuild_ReadAhead*)(uintptr_t)ahead)->content != NULL)
+		{
+			const char** inputs = _depfileParse(((struct _CBuild_ReadAhead*)(uintptr_t)ahead)->content);
+
+			for (unsigned long long input = 0; inputs[input] != NULL; ++input)
+			{
+				_stringsAppend(&paths, _arenaStrdup(&discovered.arena, inputs[input]));
+				free((void*)inputs[input]);
+			}
+
+			free(inputs);
+		}
+	}
+
+	_statPrefetch(paths.items, paths.count);
+	_stringsFree(&paths);
+	_stringsFree(&discovered);
+}
+
+/**
+ * Loads the snapshot of the configuration and, if every path it probed
+ * is still in the same state, submits its actions in order (see
+ * @ref _actionSubmit) and waits for them. Returns 1 if the snapshot was
+ * replayed, and 0 if it is missing, stale or damaged.
+ */
+int _snapshotReplay(const char* const path, const unsigned long long key)
+{
+	unsigned long long length = 0;
+	char* data = _readFile(path, &length);
+
+	if (data == NULL)
+	{
+		return 0;
+	}
+
+	struct _CBuild_Arena arena = { 0 };
+	struct _CBuild_SnapshotReader reader = { data, length, 8, length < 8 OR memcmp(data, CBUILD_SNAPSHOT_MAGIC, 8) != 0, &arena };
+	const char* reason = _snapshotReadNumber(&reader) != key ? "arguments or build script changed" : NULL;
+	const unsigned long long probes = reason == NULL ? _snapshotReadNumber(&reader) : 0;
+	const char** probed = (const char**)malloc((probes + 1) * sizeof(const char*));
+	long long* recorded = (long long*)malloc((probes + 1) * sizeof(long long));
+	unsigned long long probedCount = 0;
+
+	for (; probedCount < probes AND NOT reader.failed; ++probedCount)
+	{
+		const char* probe = _snapshotReadString(&reader);
+		recorded[probedCount] = (long long)_snapshotReadNumber(&reader);
+		reader.failed |= probe == NULL;
+		probed[probedCount] = probe != NULL ? probe + 1 : NULL;
+	}
+
+	struct _CBuild_Stat* stats = (struct _CBuild_Stat*)malloc((probedCount + 1) * sizeof(struct _CBuild_Stat));
+	_statBatch(probed, reader.failed ? 0 : probedCount, stats);
+
+	for (unsigned long long index = 0; index < probedCount AND NOT reader.failed AND reason == NULL; ++index)
+	{
+		const long long state = stats[index].kind < 0 ? -1 : probed[index][-1] == CBUILD_PROBE_TIME ? stats[index].mtime : stats[index].kind;
+
+		if (state != recorded[index])
+		{
+			reason = CONCAT("path `", probed[index], "` changed");
+		}
+	}
+
+	free(stats);
+	free(recorded);
+	free(probed);
+
+	const unsigned long long count = reason == NULL ? _snapshotReadNumber(&reader) : 0;
+	struct _CBuild_Action* actions = (struct _CBuild_Action*)malloc((count + 1) * sizeof(struct _CBuild_Action));
+
+	for (unsigned long long index = 0; index < count AND NOT reader.failed; ++index)
+	{
+		actions[index].kind = (int)_snapshotReadNumber(&reader);
+		actions[index].output = _snapshotReadString(&reader);
+		actions[index].depfile = _snapshotReadString(&reader);
+		actions[index].inputs = _snapshotReadStrings(&reader);
+		actions[index].argv = _snapshotReadStrings(&reader);
+		reader.failed |= actions[index].output == NULL OR actions[index].argv == NULL OR actions[index].argv[0] == NULL;
+	}
+
+	free(data);
+
+	if (reader.failed OR reason != NULL)
+	{
+		if (_cbuildExplain)
+		{
+			ECHO(stdout, " -- "CBUILD_INFO_LABEL" Explain configuration: %s\n", reader.failed ? "snapshot is damaged" : reason);
+		}
+
+		free(actions);
+		_arenaFree(&arena);
+		return 0;
+	}
+
+#if CBUILD_ECHO_LEVEL >= 1
+	ECHO(stdout, " -- "CBUILD_INFO_LABEL" Configuration is unchanged, replaying %llu actions.\n", count);
+#endif
+
+	_replayPrefetch(actions, count);
+	_cbuildProgressState.total += count;
+	_cbuildProgressState.planned += count;
+
+	for (unsigned long long index = 0; index < count; ++index)
+	{
+		if (_actionSubmit(&actions[index]))
+		{
+#if CBUILD_ECHO_LEVEL >= 1
+			switch (actions[index].kind)
+			{
+				case CBUILD_ACTION_COMPILE:
+					ECHO(stdout, " -- "CBUILD_INFO_LABEL" Compiling `%s`.\n", actions[index].inputs[0]);
+					break;
+				case CBUILD_ACTION_LINK:
+					ECHO(stdout, " -- "CBUILD_INFO_LABEL" Linked `%s`.\n", actions[index].output);
+					break;
+				case CBUILD_ACTION_ARCHIVE:
+					ECHO(stdout, " -- "CBUILD_INFO_LABEL" Archived `%s`.\n", actions[index].output);
+					break;
+				default:
+					ECHO(stdout, " -- "CBUILD_INFO_LABEL" Built `%s`.\n", actions[index].output);
+					break;
+			}
+#endif
+		}
+	}
+
+	_actionsWait();
+	_readAheadClear();
+	free(actions);
+	_arenaFree(&arena);
+	return 1;
+}
+
+/**
+ * Runs the configuration of the build: the function looking at the tree
+ * and adding actions, called with the context. Its graph is snapshotted
+ * to @ref CBUILD_CONFIGURE_DIRECTORY, keyed by the build script binary
+ * and the arguments left for it by @ref _options, along with every path
+ * the configuration looked at: directories listed and files written, by
+ * modification time, and paths checked with @ref ISFILE, @ref ISDIR or
+ * @ref EXISTS. While all of them are unchanged, the next runs replay the
+ * actions directly instead of calling the function, so the configuration
+ * must not depend on anything else. Graphs with hermetic actions or
+ * shared libraries are not snapshotted, since those run logic of their
+ * own, and neither are configurations that run commands or copy, move
+ * or remove files themselves (see @ref _probeEffect), nor dry runs,
+ * which write nothing. Returns 1 if the snapshot was replayed, and 0 if
+ * the function was called.
+ * 
+ * @code{.c}
+ * 		_configure(program, _build, &options);
+ * @endcode
+ */
+int _configure(const char* const program, void (*configure)(void* context), void* const context)
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _configure()\n");
+#endif
+
+#ifdef _WIN32
+	assert(!"TODO: implement _configure with Windows WIN32 API!");
+#else
+	struct stat info;
+
+	if (stat(program, &info) < 0)
+	{
+		configure(context);
+		return 0;
+	}
+
+	const unsigned long long identity[4] = { (unsigned long long)info.st_mtim.tv_sec, (unsigned long long)info.st_mtim.tv_nsec, (unsigned long long)info.st_size, (unsigned long long)info.st_ino };
+	unsigned long long key = _hash(identity, sizeof(identity), CBUILD_HASH_SEED);
+
+	for (unsigned long long index = 0; _cbuildScriptArguments != NULL AND _cbuildScriptArguments[index] != NULL; ++index)
+	{
+		key = _hash(_cbuildScriptArguments[index], strlen(_cbuildScriptArguments[index]) + 1, key);
+	}
+
+	char name[32];
+	sprintf(name, "%016llx", key);
+	const char* path = PATH(CBUILD_CONFIGURE_DIRECTORY, name);
+
+	if (_snapshotReplay(path, key))
+	{
+		return 1;
+	}
+
+	const unsigned long long first = _cbuildGraph.count;
+	_mapClear(&_cbuildProbes);
+	_cbuildGraphOpaque = 0;
+	_cbuildProbing = 1;
+	configure(context);
+	_cbuildProbing = 0;
+	_actionsWait();
+
+	if (_cbuildDryRun)
+	{
+		return 0;
+	}
+
+	if (_cbuildGraphOpaque)
+	{
+		unlink(path);
+	}
+	else
+	{
+		_snapshotSave(path, key, first);
+	}
+
+	return 0;
+#endif
+}
+
+/**
+ * Wraps @ref _configure function.
+ * 
+ * @code{.c}
+ * 		CONFIGURE(program, _build, &options);
+ * @endcode
+ */
+#ifndef CONFIGURE
+#	define CONFIGURE(program, configure, context) _configure(program, configure, context)
+#endif
+
+/**
+ * @}
+ */
+
+#endif
+
+
+
+#if !defined(CBUILD_H_C_EXTENTION) && defined(CBUILD_ENABLE_C_EXTENTION)
+#define CBUILD_H_C_EXTENTION
+
+#ifndef ADD_EXECUTABLE
+#	define ADD_EXECUTABLE(compiler, options, sources) \
+	{ \
+		CMD(compiler, options, sources); \
+	}
+#endif
+
+
+
+/**
+ * @addtogroup TOOLCHAIN
+ * 
+ * @{
+ */
+
+#define CBUILD_TOOLCHAIN_UNKNOWN 0
+#define CBUILD_TOOLCHAIN_GCC 1
+#define CBUILD_TOOLCHAIN_CLANG 2
+
+/**
+ * What is known about a compiler: its resolved binary, family, version
+ * line, whether it writes `-MMD` depfiles, system include directories,
+ * and flags probed so far (map value is 1 when supported). Everything
+ * is cached in `<CBUILD_CACHE_DIRECTORY>/toolchain`, keyed by the
+ * compiler binary and validated by its mtime and size, so later runs
+ * start no probing processes at all.
+ */
+struct _CBuild_Toolchain
+{
+	const char* compiler;
+	const char* path;
+	const char* cache;
+	const char* version;
+	long long mtime;
+	unsigned long long size;
+	int kind;
+	int depfiles;
+	struct _CBuild_Strings includes;
+	struct _CBuild_Map flags;
+};
+
+struct _CBuild_Toolchain** _cbuildToolchains = NULL;
+unsigned long long _cbuildToolchainsCount = 0;
+
+/**
+ * Writes the toolchain into its cache file, except in dry runs.
+ */
+void _toolchainSave(const struct _CBuild_Toolchain* const toolchain)
+{
+	if (_cbuildDryRun)
+	{
+		return;
+	}
+
+	struct _CBuild_Buffer buffer = { 0 };
+	_bufferAppendf(&buffer, "stamp %lld %llu\n", toolchain->mtime, toolchain->size);
+	_bufferAppendf(&buffer, "kind %d\n", toolchain->kind);
+	_bufferAppendf(&buffer, "depfiles %d\n", toolchain->depfiles);
+	_bufferAppendf(&buffer, "version %s\n", toolchain->version);
+
+	for (unsigned long long index = 0; index < toolchain->includes.count; ++index)
+	{
+		_bufferAppendf(&buffer, "include %s\n", toolchain->includes.items[index]);
+	}
+
+	for (unsigned long long index = 0; index < toolchain->flags.capacity; ++index)
+	{
+		if (toolchain->flags.keys[index] != NULL)
+		{
+			_bufferAppendf(&buffer, "flag %llu %s\n", toolchain->flags.values[index], toolchain->flags.keys[index]);
+		}
+	}
+
+	if (_writeFile(toolchain->cache, buffer.data, buffer.length) < 0)
+	{
+#if CBUILD_ECHO_LEVEL >= 1
+		ECHO(stderr, CBUILD_WARNING_LABEL" Failed to write toolchain cache `%s`: "CBUILD_WARNING("%s")"\n", toolchain->cache, strerror(errno));
+#endif
+	}
+
+	BUFFER_FREE(&buffer);
+}
+
+/**
+ * Reads the toolchain from its cache file. Returns 1 if the cache
+ * exists and was written for the same compiler binary, and 0 otherwise.
+ */
+int _toolchainLoad(struct _CBuild_Toolchain* const toolchain)
+{
+	char* content = _readFile(toolchain->cache, NULL);
+
+	if (content == NULL)
+	{
+		return 0;
+	}
+
+	long long mtime = -1;
+	unsigned long long size = 0;
+
+	if (sscanf(content, "stamp %lld %llu\n", &mtime, &size) != 2 OR mtime != toolchain->mtime OR size != toolchain->size)
+	{
+		free(content);
+		return 0;
+	}
+
+	for (char* line = content; line != NULL AND *line != '\0';)
+	{
+		char* end = strchr(line, '\n');
+
+		if (end != NULL)
+		{
+			*end = '\0';
+		}
+
+		if (strncmp(line, "kind ", 5) == 0)
+		{
+			toolchain->kind = atoi(line + 5);
+		}
+		else if (strncmp(line, "depfiles ", 9) == 0)
+		{
+			toolchain->depfiles = atoi(line + 9);
+		}
+		else if (strncmp(line, "version ", 8) == 0)
+		{
+			toolchain->version = strdup(line + 8);
+		}
+		else if (strncmp(line, "include ", 8) == 0)
+		{
+			_stringsAppendCopy(&toolchain->includes, line + 8);
+		}
+		else if (strncmp(line, "flag ", 5) == 0 AND strchr(line + 5, ' ') != NULL)
+		{
+			_mapSet(&toolchain->flags, strchr(line + 5, ' ') + 1, strtoull(line + 5, NULL, 10));
+		}
+
+		line = end != NULL ? end + 1 : NULL;
+	}
+
+	free(content);
+	return 1;
+}
+
+/**
+ * Probes the compiler with a single verbose preprocessor run, which
+ * reports both its version and its system include directories. Only
+ * compilers of unknown family get a second run to check depfiles.
+ */
+void _toolchainProbe(struct _CBuild_Toolchain* const toolchain)
+{
+#if CBUILD_ECHO_LEVEL >= 1
+	ECHO(stdout, " -- "CBUILD_INFO_LABEL" Probing compiler `%s`.\n", toolchain->path);
+#endif
+
+	struct _CBuild_Buffer output = { 0 };
+	const char* argv[] = { toolchain->path, "-E", "-v", "-x", "c", "/dev/null", "-o", "/dev/null", NULL };
+	_capture(argv, &output);
+	BUFFER_APPEND(&output, "\n");
+	_bufferReserve(&output, 1);
+	output.data[output.length] = '\0';
+
+	int includes = 0;
+
+	for (char* line = output.data; line != NULL AND *line != '\0';)
+	{
+		char* end = strchr(line, '\n');
+		*end = '\0';
+
+		if (STREQL(line, "End of search list."))
+		{
+			includes = 0;
+		}
+		else if (includes AND line[0] == ' ')
+		{
+			_stringsAppendCopy(&toolchain->includes, line + 1);
+		}
+		else if (strncmp(line, "#include <...> search starts here:", 34) == 0)
+		{
+			includes = 1;
+		}
+		else if (toolchain->kind == CBUILD_TOOLCHAIN_UNKNOWN AND strstr(line, "clang version ") != NULL)
+		{
+			toolchain->kind = CBUILD_TOOLCHAIN_CLANG;
+			toolchain->version = strdup(line);
+		}
+		else if (toolchain->kind == CBUILD_TOOLCHAIN_UNKNOWN AND strncmp(line, "gcc version ", 12) == 0)
+		{
+			toolchain->kind = CBUILD_TOOLCHAIN_GCC;
+			toolchain->version = strdup(line);
+		}
+
+		line = end + 1;
+	}
+
+	toolchain->depfiles = toolchain->kind != CBUILD_TOOLCHAIN_UNKNOWN;
+
+	if (NOT toolchain->depfiles)
+	{
+		const char* depfiles[] = { toolchain->path, "-E", "-MMD", "-MF", "/dev/null", "-x", "c", "/dev/null", "-o", "/dev/null", NULL };
+		BUFFER_CLEAR(&output);
+		toolchain->depfiles = _capture(depfiles, &output) == 0;
+	}
+
+	BUFFER_FREE(&output);
+}
+
+/**
+ * Returns the toolchain of the compiler, loading it from the cache or
+ * probing it on first use in a run (see @ref _CBuild_Toolchain). Exits
+ * if the compiler cannot be found.
+ * 
+ * @code{.c}
+ * 		struct _CBuild_Toolchain* toolchain = _toolchain("cc");
+ * @endcode
+ */
+struct _CBuild_Toolchain* _toolchain(const char* const compiler)
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _toolchain()\n");
+#endif
+
+	for (unsigned long long index = 0; index < _cbuildToolchainsCount; ++index)
+	{
+		if (STREQL(_cbuildToolchains[index]->compiler, compiler))
+		{
+			return _cbuildToolchains[index];
+		}
+	}
+
+	struct _CBuild_Toolchain* toolchain = (struct _CBuild_Toolchain*)calloc(1, sizeof(struct _CBuild_Toolchain));
+	toolchain->compiler = strdup(compiler);
+	toolchain->path = _which(compiler);
+	toolchain->version = "";
+	struct stat info;
+
+	if (toolchain->path == NULL OR stat(toolchain->path, &info) < 0)
+	{
+#if CBUILD_ECHO_LEVEL >= 1
+		ECHO(stderr, CBUILD_ERROR_LABEL" Could not find compiler "CBUILD_ERROR("`%s`")"\n", compiler);
+#endif
+
+		exit(1);
+	}
+
+	char name[32];
+	sprintf(name, "%016llx", _hash(toolchain->path, strlen(toolchain->path) + 1, HASH(compiler)));
+	toolchain->cache = PATH(CBUILD_CACHE_DIRECTORY, "toolchain", name);
+	toolchain->mtime = (long long)info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec;
+	toolchain->size = info.st_size;
+	_stringsReserve(&toolchain->includes, 0);
+
+	if (NOT _toolchainLoad(toolchain))
+	{
+		_stringsClear(&toolchain->includes);
+		_mapClear(&toolchain->flags);
+		_toolchainProbe(toolchain);
+		_toolchainSave(toolchain);
+	}
+
+	_cbuildToolchains = (struct _CBuild_Toolchain**)realloc(_cbuildToolchains, (_cbuildToolchainsCount + 1) * sizeof(struct _CBuild_Toolchain*));
+	_cbuildToolchains[_cbuildToolchainsCount++] = toolchain;
+	return toolchain;
+}
+
+/**
+ * Wraps @ref _toolchain function.
+ * 
+ * @code{.c}
+ * 		struct _CBuild_Toolchain* toolchain = TOOLCHAIN("cc");
+ * @endcode
+ */
+#ifndef TOOLCHAIN
+#	define TOOLCHAIN(compiler) _toolchain(compiler)
+#endif
+
+/**
+ * Checks whether the compiler accepts a flag without warnings, by
+ * compiling and linking an empty program with it. The answer is stored
+ * in the toolchain cache, so each flag is probed once per compiler
+ * binary. Dry runs probe in the temporary directory and leave the cache
+ * as it is. Returns 1 if the flag is supported, and 0 otherwise.
+ * 
+ * @code{.c}
+ * 		if (_toolchainSupports(toolchain, "-fuse-ld=mold")) { ... }
+ * @endcode
+ */
+int _toolchainSupports(struct _CBuild_Toolchain* const toolchain, const char* const flag)
+{
+	unsigned long long supported = 0;
+
+	if (_mapGet(&toolchain->flags, flag, &supported))
+	{
+		return (int)supported;
+	}
+
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Probing flag `%s` of compiler `%s`\n", flag, toolchain->path);
+#endif
+
+	const int dryRun = _cbuildDryRun;
+	const char* base = toolchain->cache;
+
+	if (dryRun)
+	{
+		char name[32];
+		sprintf(name, "cbuild.%d", (int)getpid());
+		base = PATH(getenv("TMPDIR") != NULL ? getenv("TMPDIR") : "/tmp", name);
+	}
+
+	const char* source = CONCAT(base, ".c");
+	const char* binary = CONCAT(base, ".out");
+	_cbuildDryRun = 0;
+	WRITE_FILE(source, "int main(void) { return 0; }\n");
+	_cbuildDryRun = dryRun;
+
+	struct _CBuild_Buffer output = { 0 };
+	const char* argv[] = { toolchain->path, "-Werror", flag, source, "-o", binary, NULL };
+	supported = _capture(argv, &output) == 0 AND output.length == 0;
+	BUFFER_FREE(&output);
+	unlink(binary);
+
+	if (dryRun)
+	{
+		unlink(source);
+	}
+
+	_mapSet(&toolchain->flags, flag, supported);
+	_toolchainSave(toolchain);
+	return (int)supported;
+}
+
+/**
+ * Wraps @ref _toolchainSupports function.
+ * 
+ * @code{.c}
+ * 		if (TOOLCHAIN_SUPPORTS(toolchain, "-fuse-ld=mold")) { ... }
+ * @endcode
+ */
+#ifndef TOOLCHAIN_SUPPORTS
+#	define TOOLCHAIN_SUPPORTS(toolchain, flag) _toolchainSupports(toolchain, flag)
+#endif
+
+/**
+ * @}
+ */
+
+
+
+/**
+ * @addtogroup UNITY
+ * 
+ * @{
+ */
+
+#ifndef CBUILD_UNITY_PREFIX
+#	define CBUILD_UNITY_PREFIX "unity_"
+#endif
+
+/**
+ * Makes the include path for a source file as seen from the unity file
+ * in provided directory. Both paths are expected to be relative to the
+ * current working directory, otherwise the absolute source path is used.
+ */
+const char* _unityIncludePath(const char* const directory, const char* const source)
+{
+	if (directory[0] == '/' OR source[0] == '/' OR strstr(directory, "..") != NULL)
+	{
+		char* absolute = realpath(source, NULL);
+		return absolute != NULL ? absolute : source;
+	}
+
+	unsigned long long depth = 0;
+	int inComponent = 0;
+
+	for (const char* character = directory; *character != '\0'; ++character)
+	{
+		if (*character == PATH_SEPARATOR[0])
+		{
+			inComponent = 0;
+		}
+		else if (NOT inComponent)
+		{
+			inComponent = 1;
+			depth += NOT (character[0] == '.' AND (character[1] == '\0' OR character[1] == PATH_SEPARATOR[0]));
+		}
+	}
+
+	char* buffer = (char*)malloc((depth * 3 + strlen(source) + 1) * sizeof(char));
+	unsigned long long length = 0;
+
+	for (unsigned long long index = 0; index < depth; ++index)
+	{
+		memcpy(buffer + length, ".."PATH_SEPARATOR, 3);
+		length += 3;
+	}
+
+	strcpy(buffer + length, source);
+	return buffer;
+}
+
+/**
+ * Groups source files into unity (jumbo) translation units, written as
+ * `unity_<hash>.c` files into provided directory, and returns a NULL
+ * terminated array of their paths.
+ * 
+ * Sources are sorted and a group is closed after a source whose path
+ * hash is divisible by the batch size (or once a group grows to twice
+ * the batch size). Groups therefore average batch size sources, and
+ * adding or removing a source changes only the group it belongs to.
+ * Each file is named after the hash of its first source, and files
+ * with unchanged content are not rewritten. Unity files left over from
+ * previous groupings are removed from the directory.
+ * 
+ * @code{.c}
+ * 		const char* sources[] = { "a.c", "b.c", "c.c" };
+ * 		const char** units = _unity(PATH("build", "unity"), 8, sources, 3);
+ * @endcode
+ */
+const char** _unity(const char* const directory, const unsigned long long batchSize, const char* const* sources, const unsigned long long count)
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _unity()\n");
+#endif
+
+#ifdef _WIN32
+	assert(!"TODO: implement _unity with Windows WIN32 API!");
+#else
+	const unsigned long long batch = batchSize > 0 ? batchSize : 1;
+	const char** sorted = (const char**)malloc((count + 1) * sizeof(const char*));
+	memcpy(sorted, sources, count * sizeof(const char*));
+	qsort(sorted, count, sizeof(const char*), _compareStrings);
+
+	const char** units = (const char**)malloc((count + 1) * sizeof(const char*));
+	unsigned long long unitsCount = 0;
+
+	ENSURE_DIR(directory);
+
+	unsigned long long capacity = 4096;
+	char* content = (char*)malloc(capacity * sizeof(char));
+
+	for (unsigned long long first = 0; first < count;)
+	{
+		unsigned long long last = first;
+
+		while (last < count)
+		{
+			const unsigned long long members = ++last - first;
+
+			if (HASH(sorted[last - 1]) % batch == 0 OR members >= 2 * batch)
+			{
+				break;
+			}
+		}
+
+		unsigned long long length = 0;
+
+		for (unsigned long long index = first; index < last; ++index)
+		{
+			const char* include = _unityIncludePath(directory, sorted[index]);
+			const unsigned long long needed = length + strlen(include) + 16;
+
+			while (needed > capacity)
+			{
+				capacity *= 2;
+				content = (char*)realloc(content, capacity * sizeof(char));
+			}
+
+			length += sprintf(content + length, "#include \"%s\"\n", include);
+		}
+
+		char name[sizeof(CBUILD_UNITY_PREFIX) + 32];
+		sprintf(name, CBUILD_UNITY_PREFIX"%016llx.c", HASH(sorted[first]));
+		const char* path = PATH(directory, name);
+		const int written = _writeFile(path, content, length);
+
+		if (written < 0)
+		{
+#if CBUILD_ECHO_LEVEL >= 1
+			ECHO(stderr, CBUILD_ERROR_LABEL" Failed to write unity file at path `%s`: "CBUILD_ERROR("%s")"\n", path, strerror(errno));
+#endif
+
+			exit(1);
+		}
+
+#if CBUILD_ECHO_LEVEL >= 1
+		if (written > 0 AND NOT _cbuildDryRun)
+		{
+			ECHO(stdout, " -- "CBUILD_INFO_LABEL" Updated unity file `%s`.\n", path);
+		}
+#endif
+		units[unitsCount++] = path;
+		first = last;
+	}
+
+	units[unitsCount] = NULL;
+	free(content);
+	free(sorted);
+
+	DIR* dir = opendir(directory);
+	struct dirent* dp = NULL;
+
+	while (dir != NULL AND (dp = readdir(dir)))
+	{
+		if (strncmp(dp->d_name, CBUILD_UNITY_PREFIX, sizeof(CBUILD_UNITY_PREFIX) - 1) != 0)
+		{
+			continue;
+		}
+
+		const char* path = PATH(directory, dp->d_name);
+		int used = 0;
+
+		for (unsigned long long index = 0; index < unitsCount AND NOT used; ++index)
+		{
+			used = STREQL(units[index], path);
+		}
+
+		if (NOT used AND NOT _dryRunSkip("remove", path))
+		{
+			unlink(path);
+		}
+
+		free((void*)path);
+	}
+
+	if (dir != NULL)
+	{
+		closedir(dir);
+	}
+
+	return units;
+#endif
+}
+
+/**
+ * Wraps @ref _unity function.
+ * 
+ * @code{.c}
+ * 		const char** units = UNITY(PATH("build", "unity"), 8, sources, sourcesCount);
+ * @endcode
+ */
+#ifndef UNITY
+#	define UNITY(directory, batchSize, sources, count) _unity(directory, batchSize, sources, count)
+#endif
+
+/**
+ * @}
+ */
+
+
+
+/**
+ * @addtogroup PCH
+ * 
+ * @{
+ */
+
+/**
+ * Precompiled header registered by @ref _pch. Compile actions with the
+ * same compiler and flags get it injected with `-include`.
+ */
+struct _CBuild_Pch
+{
+	const char* compiler;
+	unsigned long long flags;
+	const char* include;
+	const char* gch;
+};
+
+struct _CBuild_Pch* _cbuildPchs = NULL;
+unsigned long long _cbuildPchsCount = 0;
+
+/**
+ * Hashes compiler and NULL terminated flags, which together identify the
+ * set of compile actions a precompiled header is valid for.
+ */
+unsigned long long _flagsHash(const char* const compiler, const char* const* flags)
+{
+	unsigned long long hash = _hash(compiler, strlen(compiler) + 1, CBUILD_HASH_SEED);
+
+	for (unsigned long long index = 0; flags[index] != NULL; ++index)
+	{
+		hash = _hash(flags[index], strlen(flags[index]) + 1, hash);
+	}
+
+	return hash;
+}
+
+/**
+ * Precompiles a header into `<output>.gch` once per (header, flags)
+ * pair and registers it, so every later @ref _compilev with the same
+ * compiler and flags gets `-include <output>`. The precompiled header
+ * is rebuilt when the header, anything it includes, or the flags change.
+ * A forwarding header is written to output itself (creating its parent
+ * directory), so compilers that reject the precompiled header still
+ * compile correctly. Flags are a NULL terminated array. Returns the
+ * include path.
+ * 
+ * @code{.c}
+ * 		const char* flags[] = { "-O2", NULL };
+ * 		_pchv("cc", PATH("include", "common.h"), PATH("build", "common.h"), flags);
+ * @endcode
+ */
+const char* _pchv(const char* const compiler, const char* const header, const char* const output, const char* const* flags)
 {
 #if CBUILD_ECHO_LEVEL >= 2
-	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _mkfile()\n");
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _pchv()\n");
 #endif
 
 #ifdef _WIN32
-	assert(!"TODO: implement _mkfile with Windows WIN32 API!");
+	assert(!"TODO: implement _pchv with Windows WIN32 API!");
 #else
+	static struct _CBuild_Strings argv = { 0 };
+	_stringsClear(&argv);
+	const char* gch = CONCAT(output, ".gch");
+	const char* depfile = CONCAT(gch, ".d");
+	_stringsAppend(&argv, compiler);
 
-	signed long long separatorsCount = -1;
-	unsigned long long length = 0;
-	va_list args;
-
-	FOREACH_ARG_IN_VA_ARGS(ignore, const char*, arg, args,
+	for (unsigned long long index = 0; flags[index] != NULL; ++index)
 	{
-		length += strlen(arg);
-		++separatorsCount;
-	});
+		_stringsAppend(&argv, flags[index]);
+	}
 
-	char* buffer = (char*)malloc((length + separatorsCount * PATH_SEPARATOR_LENGTH + 1) * sizeof(char));
-	length = 0;
+	STRINGS_APPEND(&argv, "-MMD", "-MF", depfile, "-MT", gch, "-x", "c-header", header, "-o", gch);
+	const char* inputs[] = { header, NULL };
+	struct _CBuild_Action action = { gch, depfile, inputs, argv.items, CBUILD_ACTION_PCH };
 
-	FOREACH_ARG_IN_VA_ARGS(ignore, const char*, arg, args,
+	char* forward = realpath(header, NULL);
+	WRITE_FILE(output, "#include \"", forward != NULL ? forward : header, "\"\n");
+	free(forward);
+
+	if (_actionRun(&action))
 	{
-		const unsigned long long argLength = strlen(arg);
-		memcpy(buffer + length, arg, argLength);
-		length += argLength;
-		buffer[length] = '\0';
+#if CBUILD_ECHO_LEVEL >= 1
+		ECHO(stdout, " -- "CBUILD_INFO_LABEL" Precompiled header `%s`.\n", header);
+#endif
+	}
 
-		if (separatorsCount > 0)
+	const unsigned long long hash = _flagsHash(compiler, flags);
+
+	for (unsigned long long index = 0; index < _cbuildPchsCount; ++index)
+	{
+		if (_cbuildPchs[index].flags == hash AND STREQL(_cbuildPchs[index].include, output))
 		{
-			if (mkdir(buffer, 0777) == -1)
-			{
-				if (errno == EEXIST)
-				{
-#if CBUILD_ECHO_LEVEL >= 1
-					ECHO(stderr, " -- "CBUILD_WARNING_LABEL" Directory `%s` already exists: "CBUILD_WARNING("%s")"\n", buffer, strerror(errno));
+			return output;
+		}
+	}
+
+	_cbuildPchs = (struct _CBuild_Pch*)realloc(_cbuildPchs, (_cbuildPchsCount + 1) * sizeof(struct _CBuild_Pch));
+	_cbuildPchs[_cbuildPchsCount++] = (struct _CBuild_Pch){ compiler, hash, output, gch };
+	return output;
 #endif
-				}
-				else
-				{
-#if CBUILD_ECHO_LEVEL >= 1
-					ECHO(stderr, " -- "CBUILD_ERROR_LABEL" Failed to create directory at path `%s`: "CBUILD_ERROR("%s")"\n", buffer, strerror(errno));
+}
+
+/**
+ * Wraps @ref _pchv function with NULL terminated variadic flags.
+ * 
+ * @code{.c}
+ * 		_pch("cc", PATH("include", "common.h"), PATH("build", "common.h"), "-O2", NULL);
+ * @endcode
+ */
+const char* _pch(const char* const compiler, const char* const header, const char* const output, ...)
+{
+	static struct _CBuild_Strings flags = { 0 };
+	_stringsClear(&flags);
+	_stringsReserve(&flags, 0);
+	va_list args;
+
+	FOREACH_ARG_IN_VA_ARGS(output, const char*, arg, args,
+	{
+		_stringsAppend(&flags, arg);
+	});
+
+	return _pchv(compiler, header, output, flags.items);
+}
+
+/**
+ * Wraps @ref _pch function. The first variadic argument is the output.
+ * 
+ * @code{.c}
+ * 		PCH("cc", PATH("include", "common.h"), PATH("build", "common.h"), "-O2");
+ * @endcode
+ */
+#ifndef PCH
+#	define PCH(compiler, header, ...) _pch(compiler, header, __VA_ARGS__, NULL)
 #endif
 
-					free(buffer);
-					exit(1);
-				}
-			}
+/**
+ * @}
+ */
+
+
+
+/**
+ * @addtogroup COMPILE
+ * 
+ * @{
+ */
+
+/**
+ * Whether debug info of compiled objects is split into `.dwo` files
+ * next to them with `-gsplit-dwarf`, so it does not flow through the
+ * link. Off by default, since the artifact store only carries objects.
+ */
+#ifndef CBUILD_SPLIT_DWARF
+#	define CBUILD_SPLIT_DWARF 0
+#endif
+
+/**
+ * Checks whether a compile with provided flags should split its debug
+ * info (see @ref CBUILD_SPLIT_DWARF): the flags ask for debug info and
+ * the compiler supports it.
+ */
+int _splitDwarf(const char* const compiler, const char* const* flags)
+{
+#if CBUILD_SPLIT_DWARF
+	int debug = 0;
+
+	for (unsigned long long index = 0; flags[index] != NULL; ++index)
+	{
+		if (STREQL(flags[index], "-gsplit-dwarf"))
+		{
+			return 0;
 		}
-		else
+
+		if (strncmp(flags[index], "-g", 2) == 0)
 		{
-			if (open(buffer, O_WRONLY | O_CREAT | O_EXCL | O_TRUNC, S_IRWXU) == -1)
-			{
-				if (errno == EEXIST)
-				{
-#if CBUILD_ECHO_LEVEL >= 1
-					ECHO(stderr, " -- "CBUILD_WARNING_LABEL" Path `%s` already exists: "CBUILD_WARNING("%s")"\n", buffer, strerror(errno));
+			debug = NOT STREQL(flags[index], "-g0");
+		}
+	}
+
+	return debug AND _toolchainSupports(_toolchain(compiler), "-gsplit-dwarf");
+#else
+	(void)compiler;
+	(void)flags;
+	return 0;
 #endif
-				}
-				else
-				{
-#if CBUILD_ECHO_LEVEL >= 1
-					ECHO(stderr, " -- "CBUILD_ERROR_LABEL" Failed to create file at path `%s`: "CBUILD_ERROR("%s")"\n", buffer, strerror(errno));
+}
+
+/**
+ * Compiles a single source file into an object file, if it is stale
+ * (see @ref _actionStale). The compiler runs in background (see
+ * @ref _actionSubmit), so the object is ready once @ref _actionsWait
+ * or the next @ref _actionRun returns. Header dependencies are tracked through
+ * `<object>.d` depfile, when the toolchain writes depfiles (see
+ * @ref _CBuild_Toolchain). Precompiled headers registered by @ref _pchv
+ * for the same compiler and flags are injected with `-include`. Flags
+ * are a NULL terminated array. Returns the object path.
+ * 
+ * @code{.c}
+ * 		const char* flags[] = { "-O2", NULL };
+ * 		_compilev("cc", PATH("source", "main.c"), PATH("build", "main.o"), flags);
+ * @endcode
+ */
+const char* _compilev(const char* const compiler, const char* const source, const char* const object, const char* const* flags)
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _compilev()\n");
 #endif
 
-					free(buffer);
-					exit(1);
-				}
-			}
-		}
+	static struct _CBuild_Strings argv = { 0 };
+	_stringsClear(&argv);
+	const unsigned long long hash = _flagsHash(compiler, flags);
+	const struct _CBuild_Pch* pch = NULL;
 
-		if (separatorsCount > 0)
+	for (unsigned long long index = 0; index < _cbuildPchsCount AND pch == NULL; ++index)
+	{
+		if (_cbuildPchs[index].flags == hash)
 		{
-			memcpy(buffer + length, PATH_SEPARATOR, PATH_SEPARATOR_LENGTH);
-			length += PATH_SEPARATOR_LENGTH;
+			pch = &_cbuildPchs[index];
 		}
+	}
 
-		--separatorsCount;
-		buffer[length] = '\0';
-	});
+	const char* depfile = _toolchain(compiler)->depfiles ? CONCAT(object, ".d") : NULL;
+	_stringsAppend(&argv, compiler);
 
-	free(buffer);
+	if (pch != NULL)
+	{
+		STRINGS_APPEND(&argv, "-include", pch->include);
+	}
+
+	for (unsigned long long index = 0; flags[index] != NULL; ++index)
+	{
+		_stringsAppend(&argv, flags[index]);
+	}
+
+	if (depfile != NULL)
+	{
+		STRINGS_APPEND(&argv, "-MMD", "-MF", depfile);
+	}
+
+	if (_splitDwarf(compiler, flags))
+	{
+		_stringsAppend(&argv, "-gsplit-dwarf");
+	}
+
+	STRINGS_APPEND(&argv, "-c", source, "-o", object);
+	const char* inputs[] = { source, pch != NULL ? pch->gch : NULL, NULL };
+	struct _CBuild_Action action = { object, depfile, inputs, argv.items, CBUILD_ACTION_COMPILE };
+
+	if (_actionSubmit(&action))
+	{
+#if CBUILD_ECHO_LEVEL >= 1
+		ECHO(stdout, " -- "CBUILD_INFO_LABEL" Compiling `%s`.\n", source);
 #endif
+	}
+
+	free((void*)depfile);
+	return object;
 }
 
 /**
- * Wraps @ref _mkfile function and handles first and last arguments.
+ * Wraps @ref _compilev function with NULL terminated variadic flags.
  * 
  * @code{.c}
- * 		MKFILE("first", "second", "third.txt");
- * 		// Creates directories: 'first/', 'first/second/', and 'first/second/third.txt'
+ * 		_compile("cc", PATH("source", "main.c"), PATH("build", "main.o"), "-O2", NULL);
  * @endcode
  */
-#ifndef MKFILE
-#	define MKFILE(...) _mkfile(0, __VA_ARGS__, NULL)
+const char* _compile(const char* const compiler, const char* const source, const char* const object, ...)
+{
+	static struct _CBuild_Strings flags = { 0 };
+	_stringsClear(&flags);
+	_stringsReserve(&flags, 0);
+	va_list args;
+
+	FOREACH_ARG_IN_VA_ARGS(object, const char*, arg, args,
+	{
+		_stringsAppend(&flags, arg);
+	});
+
+	return _compilev(compiler, source, object, flags.items);
+}
+
+/**
+ * Wraps @ref _compile function. The first variadic argument is the
+ * object path, and the rest are compile flags.
+ * 
+ * @code{.c}
+ * 		COMPILE("cc", PATH("source", "main.c"), PATH("build", "main.o"), "-O2");
+ * @endcode
+ */
+#ifndef COMPILE
+#	define COMPILE(compiler, source, ...) _compile(compiler, source, __VA_ARGS__, NULL)
 #endif
 
 /**
- * @}
+ * Appends a string to the buffer as a JSON string literal.
  */
+void _bufferAppendJson(struct _CBuild_Buffer* const buffer, const char* string)
+{
+	_bufferReserve(buffer, 2 * strlen(string) + 2);
+	buffer->data[buffer->length++] = '"';
+
+	for (; *string != '\0'; ++string)
+	{
+		const unsigned char character = (unsigned char)*string;
 
+		if (character == '"' OR character == '\\')
+		{
+			buffer->data[buffer->length++] = '\\';
+			buffer->data[buffer->length++] = character;
+		}
+		else if (character < 0x20)
+		{
+			_bufferAppendf(buffer, "\\u%04x", character);
+			_bufferReserve(buffer, 2 * strlen(string) + 2);
+		}
+		else
+		{
+			buffer->data[buffer->length++] = character;
+		}
+	}
 
+	buffer->data[buffer->length++] = '"';
+	buffer->data[buffer->length] = '\0';
+}
 
 /**
- * @addtogroup RM
+ * Writes compilation database (`compile_commands.json`) with every
+ * compile action recorded in this run, whether it was executed or up to
+ * date, so no build is needed to produce it. The file is assembled in
+ * one buffer and written only if its content changed (see
+ * @ref _writeFile).
  * 
- * @{
+ * @code{.c}
+ * 		_writeCompileCommands("compile_commands.json");
+ * @endcode
  */
-
-void _rm(const char* const path)
+void _writeCompileCommands(const char* const path)
 {
 #if CBUILD_ECHO_LEVEL >= 2
-	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _rm()\n");
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _writeCompileCommands()\n");
 #endif
 
-#ifdef _WINN32
-	assert(!"TODO: implement _rm with Windows WIN32 API!");
-#else
-	if (_isdir(path))
+	char* directory = getcwd(NULL, 0);
+	struct _CBuild_Buffer buffer = { 0 };
+	unsigned long long entries = 0;
+	BUFFER_APPEND(&buffer, "[");
+
+	for (unsigned long long index = 0; index < _cbuildGraph.count; ++index)
 	{
-		FOREACH_FILE_IN_DIRECTORY(file, path,
+		const struct _CBuild_Action* action = &_cbuildGraph.actions[index];
+
+		if (action->kind != CBUILD_ACTION_COMPILE)
 		{
-			IGNORE_DIRECTORY_IF_DOTS(file);
-			_rm(PATH(path, file));
-		});
+			continue;
+		}
 
-		if (rmdir(path) < 0)
+		BUFFER_APPEND(&buffer, entries > 0 ? ",\n  {\n    \"directory\": " : "\n  {\n    \"directory\": ");
+		++entries;
+		_bufferAppendJson(&buffer, directory != NULL ? directory : ".");
+		BUFFER_APPEND(&buffer, ",\n    \"file\": ");
+		_bufferAppendJson(&buffer, action->inputs[0]);
+		BUFFER_APPEND(&buffer, ",\n    \"output\": ");
+		_bufferAppendJson(&buffer, action->output);
+		BUFFER_APPEND(&buffer, ",\n    \"arguments\": [");
+
+		for (unsigned long long arg = 0; action->argv[arg] != NULL; ++arg)
 		{
-			if (errno == ENOENT)
-			{
+			BUFFER_APPEND(&buffer, arg > 0 ? ", " : "");
+			_bufferAppendJson(&buffer, action->argv[arg]);
+		}
+
+		BUFFER_APPEND(&buffer, "]\n  }");
+	}
+
+	BUFFER_APPEND(&buffer, "\n]\n");
+	const int written = _writeFile(path, buffer.data, buffer.length);
+
+	if (written < 0)
+	{
 #if CBUILD_ECHO_LEVEL >= 1
-				ECHO(stdout, CBUILD_WARNING_LABEL" Directory `%s` does not exist: "CBUILD_WARNING("%s")"\n", path, strerror(errno));
+		ECHO(stderr, CBUILD_ERROR_LABEL" Failed to write compilation database at path `%s`: "CBUILD_ERROR("%s")"\n", path, strerror(errno));
 #endif
 
-				errno = 0;
-			}
-			else
-			{
+		exit(1);
+	}
+
 #if CBUILD_ECHO_LEVEL >= 1
-				ECHO(stderr, CBUILD_ERROR_LABEL" Failed to remove directory at path `%s`: "CBUILD_ERROR("%s")"\n", path, strerror(errno));
+	if (written > 0 AND NOT _cbuildDryRun)
+	{
+		ECHO(stdout, " -- "CBUILD_INFO_LABEL" Updated compilation database `%s`.\n", path);
+	}
 #endif
-			}
+
+	BUFFER_FREE(&buffer);
+	free(directory);
+}
+
+/**
+ * Wraps @ref _writeCompileCommands function.
+ * 
+ * @code{.c}
+ * 		WRITE_COMPILE_COMMANDS("compile_commands.json");
+ * @endcode
+ */
+#ifndef WRITE_COMPILE_COMMANDS
+#	define WRITE_COMPILE_COMMANDS(path) _writeCompileCommands(path)
+#endif
+
+/**
+ * @}
+ */
+
+
+
+/**
+ * @addtogroup LINK
+ * 
+ * @{
+ */
+
+#ifndef CBUILD_INTERFACE_EXTENSION
+#	define CBUILD_INTERFACE_EXTENSION ".abi"
+#endif
+
+/**
+ * Whether @ref _linkv picks the fastest linker the compiler can use,
+ * mold or lld, unless the flags already choose one with `-fuse-ld=`.
+ * Off by default, since another linker can produce different binaries
+ * and reject flags the default one accepts.
+ */
+#ifndef CBUILD_FAST_LINKER
+#	define CBUILD_FAST_LINKER 0
+#endif
+
+/**
+ * Number of threads used by the fast linker, 0 leaves it to the linker,
+ * which uses all processors. It is fixed at compile time rather than
+ * taken from `--jobs`, since it is part of the link command and changing
+ * it relinks.
+ */
+#ifndef CBUILD_LINKER_THREADS
+#	define CBUILD_LINKER_THREADS 0
+#endif
+
+/**
+ * Appends flags selecting the fastest linker the compiler can use (see
+ * @ref CBUILD_FAST_LINKER), probed once per compiler binary, with
+ * @ref CBUILD_LINKER_THREADS.
+ */
+void _linkerFlags(const char* const compiler, const char* const* flags, struct _CBuild_Strings* const argv)
+{
+#if CBUILD_FAST_LINKER
+	for (unsigned long long index = 0; flags[index] != NULL; ++index)
+	{
+		if (strncmp(flags[index], "-fuse-ld=", 9) == 0)
+		{
+			return;
 		}
 	}
+
+	struct _CBuild_Toolchain* toolchain = _toolchain(compiler);
+	char threads[64];
+
+	if (_toolchainSupports(toolchain, "-fuse-ld=mold"))
+	{
+		_stringsAppend(argv, "-fuse-ld=mold");
+		sprintf(threads, "-Wl,--thread-count=%d", CBUILD_LINKER_THREADS);
+	}
+	else if (_toolchainSupports(toolchain, "-fuse-ld=lld"))
+	{
+		_stringsAppend(argv, "-fuse-ld=lld");
+		sprintf(threads, "-Wl,--threads=%d", CBUILD_LINKER_THREADS);
+	}
 	else
 	{
-		if (unlink(path) < 0)
-		{
-			if (errno == ENOENT)
-			{
-#if CBUILD_ECHO_LEVEL >= 1
-				ECHO(stdout, CBUILD_WARNING_LABEL" File `%s` does not exist: "CBUILD_WARNING("%s")"\n", path, strerror(errno));
-#endif
+		return;
+	}
 
-				errno = 0;
-			}
-			else
-			{
-#if CBUILD_ECHO_LEVEL >= 1
-				ECHO(stderr, CBUILD_ERROR_LABEL" Failed to remove file at path `%s`: "CBUILD_ERROR("%s")"\n", path, strerror(errno));
-#endif
-			}
-		}
+	if (CBUILD_LINKER_THREADS > 0)
+	{
+		_stringsAppendCopy(argv, threads);
 	}
+#else
+	(void)compiler;
+	(void)flags;
+	(void)argv;
 #endif
 }
 
 /**
- * Wraps @ref _rm function.
+ * Returns the path a link action should depend on for the input. Shared
+ * libraries with an interface file (see @ref _sharedLibraryv) are
+ * represented by it, so dependents are relinked only when the exported
+ * interface changes. Any other input is returned as is.
+ */
+const char* _linkInput(const char* const input)
+{
+	const char* interface = CONCAT(input, CBUILD_INTERFACE_EXTENSION);
+
+	if (_isfile(interface))
+	{
+		return interface;
+	}
+
+	free((void*)interface);
+	return input;
+}
+
+/**
+ * Links objects and libraries into output, if it is stale (see
+ * @ref _actionStale), which also skips relinking when recompiled inputs
+ * came out the same. Waits for background compiles first (see
+ * @ref _actionRun). Uses mold or lld when available and enabled by
+ * @ref CBUILD_FAST_LINKER (see @ref _linkerFlags). Inputs and flags are
+ * NULL terminated arrays. Returns 1 if output was linked, and 0
+ * otherwise.
  * 
  * @code{.c}
- * 		RM(PATH("folder1", "file.txt"));
+ * 		const char* inputs[] = { PATH("build", "main.o"), PATH("build", "libutil.so"), NULL };
+ * 		const char* flags[] = { "-lm", NULL };
+ * 		_linkv("cc", PATH("build", "main"), inputs, flags);
  * @endcode
  */
-#ifndef RM
-#	define RM(path) _rm(path)
+int _linkv(const char* const compiler, const char* const output, const char* const* inputs, const char* const* flags)
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _linkv()\n");
 #endif
 
-/**
- * @}
- */
+	struct _CBuild_Strings argv = { 0 };
+	struct _CBuild_Strings dependencies = { 0 };
+	STRINGS_APPEND(&argv, compiler, "-o", output);
+	_stringsReserve(&dependencies, 0);
 
+	for (unsigned long long index = 0; inputs[index] != NULL; ++index)
+	{
+		_stringsAppend(&argv, inputs[index]);
+		_stringsAppend(&dependencies, _linkInput(inputs[index]));
+	}
 
+	for (unsigned long long index = 0; flags[index] != NULL; ++index)
+	{
+		_stringsAppend(&argv, flags[index]);
+	}
 
-/**
- * @addtogroup MV
- * 
- * @{
- */
+	_linkerFlags(compiler, flags, &argv);
+	struct _CBuild_Action action = { output, NULL, dependencies.items, argv.items, CBUILD_ACTION_LINK };
+	const int linked = _actionRun(&action);
+
+#if CBUILD_ECHO_LEVEL >= 1
+	if (linked)
+	{
+		ECHO(stdout, " -- "CBUILD_INFO_LABEL" Linked `%s`.\n", output);
+	}
+#endif
+
+	_stringsFree(&argv);
+	_stringsFree(&dependencies);
+	return linked;
+}
 
 /**
- * Moves a file to other location. It can effectively rename a file.
- * Source and destination are paths that can be formatted with @ref PATH
- * macro.
+ * Wraps @ref _linkv function with NULL terminated variadic flags.
  * 
  * @code{.c}
- * 		_mv(PATH("folder1", "file.txt"), PATH("folder2", "file.txt"));
+ * 		_link("cc", PATH("build", "main"), inputs, "-lm", NULL);
  * @endcode
  */
-void _mv(const char* const source, const char* const destination)
+int _link(const char* const compiler, const char* const output, const char* const* inputs, ...)
 {
-#if CBUILD_ECHO_LEVEL >= 2
-	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _mv()\n");
-#endif
+	static struct _CBuild_Strings flags = { 0 };
+	_stringsClear(&flags);
+	_stringsReserve(&flags, 0);
+	va_list args;
 
-#ifdef _WIN32
-	assert(!"TODO: implement _mv with Windows WIN32 API!");
-#else
-	if (rename(source, destination) < 0)
+	FOREACH_ARG_IN_VA_ARGS(inputs, const char*, arg, args,
 	{
-#if CBUILD_ECHO_LEVEL >= 1
-				ECHO(stderr, CBUILD_ERROR_LABEL" Failed to move path from `%s` to `%s`: "CBUILD_ERROR("%s")"\n", source, destination, strerror(errno));
-#endif
+		_stringsAppend(&flags, arg);
+	});
 
-		exit(1);
-	}
-#endif
+	return _linkv(compiler, output, inputs, flags.items);
 }
 
 /**
- * Wraps @ref _mv function.
+ * Wraps @ref _link function. The first variadic argument is the NULL
+ * terminated array of inputs, and the rest are link flags.
  * 
  * @code{.c}
- * 		MV(PATH("folder1", "file.txt"), PATH("folder2", "file.txt"));
+ * 		LINK("cc", PATH("build", "main"), inputs, "-lm");
  * @endcode
  */
-#ifndef MV
-#	define MV(source, destination) _mv(source, destination)
+#ifndef LINK
+#	define LINK(compiler, output, ...) _link(compiler, output, __VA_ARGS__, NULL)
 #endif
 
 /**
@@ -748,210 +11029,284 @@ void _mv(const char* const source, const char* const destination)
 
 
 /**
- * @addtogroup CMD
+ * @addtogroup LIBRARY
  * 
  * @{
  */
 
+#ifndef CBUILD_ARCHIVER
+#	define CBUILD_ARCHIVER "ar"
+#endif
+
 /**
- * Calls a command line command as a child process. It requires the whole
- * command to be provided either separates or not as a variadic arguments.
- * Last parameter must be NULL!
- * 
- * @code{.c}
- * 		_cmd("ls", "-la");
- * 		// or
- * 		_cmd("ls -la");
- * @endcode
+ * When set, static libraries are thin archives, which only reference
+ * objects in the build directory instead of copying them. Such archives
+ * are cheap to create, but are not usable outside the build tree.
  */
-void _cmd(int ignore, ...)
-{
-#if CBUILD_ECHO_LEVEL >= 2
-	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _cmd()\n");
+#ifndef CBUILD_THIN_ARCHIVES
+#	ifdef __linux__
+#		define CBUILD_THIN_ARCHIVES 1
+#	else
+#		define CBUILD_THIN_ARCHIVES 0
+#	endif
 #endif
 
-#ifdef _WIN32
-	assert(!"TODO: implement _cmd with Windows WIN32 API!");
-#else
-	unsigned long long argc = 0;
-	va_list args;
+#ifndef CBUILD_SYMBOLS
+#	define CBUILD_SYMBOLS "nm"
+#endif
 
-	FOREACH_ARG_IN_VA_ARGS(ignore, const char*, arg, args,
-	{
-		++argc;
-	});
+/**
+ * Compiles every source of the NULL terminated array into
+ * `<directory>/<source name>.o` in parallel (see @ref _compilev), and
+ * returns NULL terminated array of objects. Sources sharing a name, such
+ * as `a/util.c` and `b/util.c`, are compiled into
+ * `<source name>.<path hash>.o` instead, so they do not overwrite each
+ * other.
+ */
+const char** _objectsv(const char* const compiler, const char* const directory, const char* const* sources, const char* const* flags)
+{
+	struct _CBuild_Strings objects = { 0 };
+	struct _CBuild_Map names = { 0 };
+	_stringsReserve(&objects, 0);
+	ENSURE_DIR(directory);
 
-	assert(argc >= 1);
-	const char** argv = (const char**)malloc((argc + 1) * sizeof(const char*));
-	argc = 0;
+	for (unsigned long long index = 0; sources[index] != NULL; ++index)
+	{
+		const char* name = strrchr(sources[index], PATH_SEPARATOR[0]);
+		unsigned long long count = 0;
+		_mapGet(&names, name != NULL ? name + 1 : sources[index], &count);
+		_mapSet(&names, name != NULL ? name + 1 : sources[index], count + 1);
+	}
 
-	FOREACH_ARG_IN_VA_ARGS(ignore, const char*, arg, args,
+	for (unsigned long long index = 0; sources[index] != NULL; ++index)
 	{
-		argv[argc++] = arg;
-	});
+		const char* name = strrchr(sources[index], PATH_SEPARATOR[0]);
+		name = name != NULL ? name + 1 : sources[index];
+		unsigned long long count = 0;
+		_mapGet(&names, name, &count);
+		char suffix[32];
+		sprintf(suffix, ".%08llx.o", _hash(sources[index], strlen(sources[index]), CBUILD_HASH_SEED) & 0xffffffffULL);
+		const char* object = PATH(directory, CONCAT(name, count > 1 ? suffix : ".o"));
+		_stringsAppend(&objects, _compilev(compiler, sources[index], object, flags));
+	}
 
-	argv[argc] = NULL;
-	assert(argc >= 1);
-	pid_t childProcessId = fork();
+	_mapFree(&names);
+	return objects.items;
+}
 
-	if (childProcessId == -1)
+/**
+ * Writes exported interface of a shared library, its defined dynamic
+ * symbols with their types, and sizes of data symbols (whose layout is
+ * part of the interface, unlike the size of a function), into
+ * `<library>.abi`. The file is only rewritten when the interface
+ * changes (see @ref _writeFile), so link actions depending on it (see
+ * @ref _linkInput) are not relinked when only the implementation
+ * changed. If symbols cannot be listed, the file is removed and
+ * dependents fall back to the library itself.
+ */
+void _interfaceUpdate(const char* const library)
+{
+	const char* interface = CONCAT(library, CBUILD_INTERFACE_EXTENSION);
+	struct _CBuild_Buffer output = { 0 };
+	struct _CBuild_Buffer symbols = { 0 };
+	const char* argv[] = { CBUILD_SYMBOLS, "-D", "--defined-only", "-P", library, NULL };
+
+	if (_capture(argv, &output) != 0)
 	{
 #if CBUILD_ECHO_LEVEL >= 1
-		ECHO(stderr, CBUILD_ERROR_LABEL" Failed to fork child process: "CBUILD_ERROR("%s")"\n", strerror(errno));
+		ECHO(stderr, CBUILD_WARNING_LABEL" Failed to list symbols of `%s`, dependents will relink on every change.\n", library);
 #endif
 
-		free(argv);
-		exit(1);
+		unlink(interface);
+		BUFFER_FREE(&output);
+		free((void*)interface);
+		return;
 	}
 
-	if (childProcessId == 0)
+	for (unsigned long long index = 0; index < output.length;)
 	{
-		if (execvp(argv[0], (char* const *)argv) < 0)
-		{
-#if CBUILD_ECHO_LEVEL >= 1
-			ECHO(stderr, CBUILD_ERROR_LABEL" Failed to execute child process: "CBUILD_ERROR("%s")"\n", strerror(errno));
-#endif
+		const char* line = output.data + index;
+		const char* end = (const char*)memchr(line, '\n', output.length - index);
+		const unsigned long long length = end != NULL ? (unsigned long long)(end - line) : output.length - index;
+		const char* name = (const char*)memchr(line, ' ', length);
+		const char* type = name != NULL ? name + 1 : NULL;
 
-			free(argv);
-			exit(1);
-		}
-	}
-	else
-	{
-		for (;;)
+		if (type != NULL AND type < line + length)
 		{
-			int status = 0;
-			wait(&status);
+			_bufferAppend(&symbols, line, type + 1 - line);
+			const char* value = type + 1 < line + length ? (const char*)memchr(type + 1, ' ', line + length - type - 1) : NULL;
+			const char* size = value != NULL ? (const char*)memchr(value + 1, ' ', line + length - value - 1) : NULL;
 
-			if (WIFEXITED(status))
+			if (size != NULL AND strchr("BbDdGgRrSsVv", *type) != NULL)
 			{
-				const int exitStatus = WEXITSTATUS(status);
-
-				if (exitStatus != 0)
-				{
-#if CBUILD_ECHO_LEVEL >= 1
-					ECHO(stderr, CBUILD_ERROR_LABEL" Child process exited with code "CBUILD_ERROR("%d")"\n", exitStatus);
-#endif
+				_bufferAppend(&symbols, size, line + length - size);
+			}
 
-					free(argv);
-					exit(1);
-				}
+			BUFFER_APPEND(&symbols, "\n");
+		}
 
-				break;
-			}
+		index += length + 1;
+	}
 
-			if (WIFSIGNALED(status))
-			{
+	if (_writeFile(interface, symbols.data, symbols.length) > 0)
+	{
 #if CBUILD_ECHO_LEVEL >= 1
-					ECHO(stderr, CBUILD_ERROR_LABEL" Child process was terminated by "CBUILD_ERROR("%d")" signal\n", WTERMSIG(status));
+		ECHO(stdout, " -- "CBUILD_INFO_LABEL" Interface of `%s` changed.\n", library);
 #endif
-
-				free(argv);
-				exit(1);
-			}
-		}
 	}
 
-	free(argv);
-#endif
+	BUFFER_FREE(&output);
+	BUFFER_FREE(&symbols);
+	free((void*)interface);
 }
 
 /**
- * Wraps @ref _cmd function.
+ * Builds a static library from the NULL terminated array of sources.
+ * Objects are compiled in parallel into directory (see @ref _objectsv)
+ * with the NULL terminated flags, and archived with
+ * @ref CBUILD_ARCHIVER, as a thin archive when
+ * @ref CBUILD_THIN_ARCHIVES is set. Returns the library path.
  * 
  * @code{.c}
- * 		CMD("ls", "-la");
+ * 		const char* sources[] = { PATH("source", "util.c"), NULL };
+ * 		const char* flags[] = { "-O2", NULL };
+ * 		_staticLibraryv("cc", PATH("build", "libutil.a"), PATH("build", "util"), sources, flags);
  * @endcode
  */
-#ifndef CMD
-#	define CMD(...) _cmd(0, __VA_ARGS__, NULL)
+const char* _staticLibraryv(const char* const compiler, const char* const output, const char* const directory, const char* const* sources, const char* const* flags)
+{
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _staticLibraryv()\n");
+#endif
+
+	const char** objects = _objectsv(compiler, directory, sources, flags);
+	struct _CBuild_Strings argv = { 0 };
+	STRINGS_APPEND(&argv, CBUILD_ARCHIVER, CBUILD_THIN_ARCHIVES ? "crsT" : "crs", output);
+
+	for (unsigned long long index = 0; objects[index] != NULL; ++index)
+	{
+		_stringsAppend(&argv, objects[index]);
+	}
+
+	struct _CBuild_Action action = { output, NULL, objects, argv.items, CBUILD_ACTION_ARCHIVE };
+
+	if (_actionRun(&action))
+	{
+#if CBUILD_ECHO_LEVEL >= 1
+		ECHO(stdout, " -- "CBUILD_INFO_LABEL" Archived `%s`.\n", output);
 #endif
+	}
+
+	_stringsFree(&argv);
+	return output;
+}
 
 /**
- * @}
+ * Wraps @ref _staticLibraryv function with NULL terminated variadic
+ * flags.
  */
+const char* _staticLibrary(const char* const compiler, const char* const output, const char* const directory, const char* const* sources, ...)
+{
+	static struct _CBuild_Strings flags = { 0 };
+	_stringsClear(&flags);
+	_stringsReserve(&flags, 0);
+	va_list args;
 
+	FOREACH_ARG_IN_VA_ARGS(sources, const char*, arg, args,
+	{
+		_stringsAppend(&flags, arg);
+	});
 
+	return _staticLibraryv(compiler, output, directory, sources, flags.items);
+}
 
 /**
- * @addtogroup SELFBUILDER
+ * Wraps @ref _staticLibrary function. The first two variadic arguments
+ * are the objects directory and the NULL terminated array of sources,
+ * and the rest are compile flags.
  * 
- * @{
+ * @code{.c}
+ * 		ADD_STATIC_LIBRARY("cc", PATH("build", "libutil.a"), PATH("build", "util"), sources, "-O2");
+ * @endcode
  */
+#ifndef ADD_STATIC_LIBRARY
+#	define ADD_STATIC_LIBRARY(compiler, output, ...) _staticLibrary(compiler, output, __VA_ARGS__, NULL)
+#endif
 
 /**
- * Checks if source file has any changes comparing to current built
- * vesrion of the tool.
+ * Builds a shared library from the NULL terminated array of sources.
+ * Objects are compiled in parallel into directory (see @ref _objectsv)
+ * with the NULL terminated flags and `-fPIC`, and linked with `-shared`
+ * (see @ref _linkv). Its exported interface is then recorded (see
+ * @ref _interfaceUpdate), so executables linked against the library
+ * with @ref _linkv are only relinked when the interface changes.
+ * Returns the library path.
+ * 
+ * @code{.c}
+ * 		const char* sources[] = { PATH("source", "util.c"), NULL };
+ * 		const char* flags[] = { "-O2", NULL };
+ * 		_sharedLibraryv("cc", PATH("build", "libutil.so"), PATH("build", "util"), sources, flags);
+ * @endcode
  */
-int _isCBuildModified(const char* sourcePath, const char* binaryPath)
+const char* _sharedLibraryv(const char* const compiler, const char* const output, const char* const directory, const char* const* sources, const char* const* flags)
 {
-#ifdef _WIN32
-	assert(!"TODO: implement _isCBuildModified with Windows WIN32 API!");
-#else
-	struct stat info;
+#if CBUILD_ECHO_LEVEL >= 2
+	ECHO(stdout, " -- "CBUILD_TRACE_LABEL" Calling _sharedLibraryv()\n");
+#endif
 
-	if (stat(sourcePath, &info) < 0)
+	struct _CBuild_Strings compileFlags = { 0 };
+	_stringsReserve(&compileFlags, 0);
+
+	for (unsigned long long index = 0; flags[index] != NULL; ++index)
 	{
-		ECHO(stderr, " -- "CBUILD_ERROR_LABEL" Could not stat %s: %s\n", sourcePath, strerror(errno));
-		exit(1);
+		_stringsAppend(&compileFlags, flags[index]);
 	}
 
-	int path1Time = info.st_mtime;
+	_stringsAppend(&compileFlags, "-fPIC");
+	const char** objects = _objectsv(compiler, directory, sources, compileFlags.items);
+	const char* linkFlags[] = { "-shared", NULL };
+	_cbuildGraphOpaque = 1;
+	const int linked = _linkv(compiler, output, objects, linkFlags);
 
-	if (stat(binaryPath, &info) < 0)
+	if (NOT _cbuildDryRun AND (linked OR NOT _isfile(CONCAT(output, CBUILD_INTERFACE_EXTENSION))))
 	{
-		ECHO(stderr, " -- "CBUILD_ERROR_LABEL" Could not stat %s: %s\n", binaryPath, strerror(errno));
-		exit(1);
+		_interfaceUpdate(output);
 	}
 
-	int path2Time = info.st_mtime;
-	return path1Time > path2Time;
-#endif
+	_stringsFree(&compileFlags);
+	return output;
 }
 
 /**
- * Intermediate step - actual building of the new executable.
- */
-#ifndef BUILD_MYSELF
-#	if _WIN32
-#		if defined(__GNUC__)
-#			define BUILD_MYSELF(binaryPath, sourcePath) CMD("gcc", "-o", binaryPath, sourcePath)
-#		elif defined(__clang__)
-#			define BUILD_MYSELF(binaryPath, sourcePath) CMD("clang", "-o", binaryPath, sourcePath)
-#		elif defined(_MSC_VER)
-#			define BUILD_MYSELF(binaryPath, sourcePath) CMD("cl.exe", sourcePath)
-#		endif
-# 	else
-#		define BUILD_MYSELF(binaryPath, sourcePath) CMD("cc", "-o", binaryPath, sourcePath)
-# 	endif
-#endif
-
-/**
- * Starts the rebuilding process for the tool.
+ * Wraps @ref _sharedLibraryv function with NULL terminated variadic
+ * flags.
  */
-void _rebuildMyself(const char* const sourcePath, const char* const binaryPath)
+const char* _sharedLibrary(const char* const compiler, const char* const output, const char* const directory, const char* const* sources, ...)
 {
-	if (_isCBuildModified(sourcePath, binaryPath))
+	static struct _CBuild_Strings flags = { 0 };
+	_stringsClear(&flags);
+	_stringsReserve(&flags, 0);
+	va_list args;
+
+	FOREACH_ARG_IN_VA_ARGS(sources, const char*, arg, args,
 	{
-		ECHO(stdout, CBUILD_INFO_LABEL" Rebuilding CBUILD!\n");
-		MV(binaryPath, CONCAT(binaryPath, ".old"));
-		BUILD_MYSELF(binaryPath, sourcePath);
-		RM(CONCAT(binaryPath, ".old"));
-		CMD(binaryPath);
-		exit(0); 
-	}
+		_stringsAppend(&flags, arg);
+	});
+
+	return _sharedLibraryv(compiler, output, directory, sources, flags.items);
 }
 
 /**
- * Wraps @ref _rebuildMyself function.
+ * Wraps @ref _sharedLibrary function. The first two variadic arguments
+ * are the objects directory and the NULL terminated array of sources,
+ * and the rest are compile flags.
+ * 
+ * @code{.c}
+ * 		ADD_SHARED_LIBRARY("cc", PATH("build", "libutil.so"), PATH("build", "util"), sources, "-O2");
+ * @endcode
  */
-#ifndef REBUILD_MYSELF
-#	define REBUILD_MYSELF(program) \
-	{ \
-		const char* sourcePath = __FILE__; \
-		const char* binaryPath = program; \
-		_rebuildMyself(sourcePath, binaryPath); \
-	}
+#ifndef ADD_SHARED_LIBRARY
+#	define ADD_SHARED_LIBRARY(compiler, output, ...) _sharedLibrary(compiler, output, __VA_ARGS__, NULL)
 #endif
 
 /**
@@ -959,17 +11314,3 @@ void _rebuildMyself(const char* const sourcePath, const char* const binaryPath)
  */
 
 #endif
-
-
-
-#if !defined(CBUILD_H_C_EXTENTION) && defined(CBUILD_ENABLE_C_EXTENTION)
-#define CBUILD_H_C_EXTENTION
-
-#ifndef ADD_EXECUTABLE
-#	define ADD_EXECUTABLE(compiler, options, sources) \
-	{ \
-		CMD(compiler, options, sources); \
-	}
-#endif
-
-#endif
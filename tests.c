@@ -1,107 +1,1095 @@
 // #define CBUILD_NOECHO			// Disable echo
 #define CBUILD_IMPLEMENTATION	// Enable implementations
+#define CBUILD_ENABLE_C_EXTENTION	// Enable compile, link and library helpers
 #include "./cbuild.h"
 
 static void _usage(FILE* stream, const char* const program)
 {
 	ECHO(stream, "Usage [%s]: \n", program);
 	ECHO(stream, "    --help / -h                Print usage to the terminal\n");
-	ECHO(stream, "    --tests / -t               Enable tests\n");
+	ECHO(stream, "    --case                     Run only the provided test case\n");
+	ECHO(stream, "    --jobs / -j                Number of test cases to run at once\n");
+	ECHO(stream, "    --shard                    Run only the I-th of N shards of test cases, as I/N\n");
 	ECHO(stream, "\n");
 }
 
-#define TEST_BOOL(expression, label)	\
+#define EXPECT(expression) \
 { \
-	fprintf(stdout, "%s\n", label); \
-	fprintf(stdout, "%s => %d\n\n", #expression, expression); \
+	if (NOT (expression)) \
+	{ \
+		ECHO(stderr, CBUILD_ERROR_LABEL" %s:%d: expected "CBUILD_ERROR("%s")"\n", __FILE__, __LINE__, #expression); \
+		exit(1); \
+	} \
 }
 
-#define TEST_VOID(expression, label)	\
-{ \
-	fprintf(stdout, "%s\n", label); \
-	fprintf(stdout, "%s\n\n", #expression); \
-	expression; \
-}
+#define SCRATCH(name) PATH(CBUILD_CACHE_DIRECTORY, "scratch", name)
+
+static const char* _program = NULL;
 
-#define PAUSE { int c = getchar(); }
+static void _setTime(const char* const path, const time_t time)
+{
+	const struct timespec times[2] = { { time, 0 }, { time, 0 } };
+	EXPECT(utimensat(AT_FDCWD, path, times, 0) == 0);
+	STAT_FORGET(path);
+}
 
-void tests()
+static void _testPredicates(void)
 {
-	TEST_VOID(RM(PATH("test_cases")), "RM:");
+	const char* root = SCRATCH("predicates");
+	RM(root);
+	EXPECT(NOT EXISTS(root));
 
-	PAUSE
+	MKDIR(root, "one");
+	MKFILE(root, "one", "main.c");
 
-	TEST_BOOL(ISFILE(PATH("test_cases", "one")), "ISFILE:");
-	TEST_BOOL(ISFILE(PATH("test_cases", "one", "something.txt")), "ISFILE:");
-	TEST_BOOL(ISFILE(PATH("test_cases", "one", "main.c")), "ISFILE:");
+	EXPECT(NOT ISFILE(PATH(root, "one")));
+	EXPECT(NOT ISFILE(PATH(root, "one", "something.txt")));
+	EXPECT(ISFILE(PATH(root, "one", "main.c")));
 
-	TEST_BOOL(ISDIR(PATH("test_cases", "one")), "ISDIR:");
-	TEST_BOOL(ISDIR(PATH("test_cases", "one", "something.txt")), "ISDIR:");
-	TEST_BOOL(ISDIR(PATH("test_cases", "one", "main.c")), "ISDIR:");
+	EXPECT(ISDIR(PATH(root, "one")));
+	EXPECT(NOT ISDIR(PATH(root, "one", "something.txt")));
+	EXPECT(NOT ISDIR(PATH(root, "one", "main.c")));
 
-	TEST_BOOL(EXISTS(PATH("test_cases", "one")), "EXISTS:");
-	TEST_BOOL(EXISTS(PATH("test_cases", "one", "something.txt")), "EXISTS:");
-	TEST_BOOL(EXISTS(PATH("test_cases", "one", "main.c")), "EXISTS:");
+	EXPECT(EXISTS(PATH(root, "one")));
+	EXPECT(NOT EXISTS(PATH(root, "one", "something.txt")));
+	EXPECT(EXISTS(PATH(root, "one", "main.c")));
+
+	RM(root);
+	EXPECT(NOT EXISTS(root));
+}
+
+static void _testMake(void)
+{
+	const char* root = SCRATCH("make");
+	RM(root);
 
-	PAUSE
+	MKDIR(root, "one", "inner");
+	MKFILE(PATH(root, "one", "config.json"));
+	MKFILE(root, "one", "inner", "text.txt");
 
-	TEST_VOID(MKDIR("test_cases", "one", "inner"), "MKDIR:");
-	TEST_VOID(MKFILE(PATH("test_cases", "one", "config.json")), "MKFILE:");
-	TEST_VOID(MKFILE("test_cases", "one", "inner", "text.txt"), "MKFILE:");
+	EXPECT(ISDIR(PATH(root, "one", "inner")));
+	EXPECT(ISFILE(PATH(root, "one", "config.json")));
+	EXPECT(ISFILE(PATH(root, "one", "inner", "text.txt")));
 
-	PAUSE
+	RM(root);
+}
 
-	TEST_BOOL(ISFILE(PATH("test_cases", "one")), "ISFILE:");
-	TEST_BOOL(ISFILE(PATH("test_cases", "one", "something.txt")), "ISFILE:");
-	TEST_BOOL(ISFILE(PATH("test_cases", "one", "main.c")), "ISFILE:");
+static void _testWriteFile(void)
+{
+	const char* root = SCRATCH("write");
+	const char* path = PATH(root, "config.h");
+	RM(root);
 
-	TEST_BOOL(ISDIR(PATH("test_cases", "one")), "ISDIR:");
-	TEST_BOOL(ISDIR(PATH("test_cases", "one", "something.txt")), "ISDIR:");
-	TEST_BOOL(ISDIR(PATH("test_cases", "one", "main.c")), "ISDIR:");
+	EXPECT(_writeFile(path, "#define A 1\n", 12) == 1);
+	EXPECT(_writeFile(path, "#define A 1\n", 12) == 0);
+	EXPECT(_writeFile(path, "#define A 2\n", 12) == 1);
 
-	TEST_BOOL(EXISTS(PATH("test_cases", "one")), "EXISTS:");
-	TEST_BOOL(EXISTS(PATH("test_cases", "one", "something.txt")), "EXISTS:");
-	TEST_BOOL(EXISTS(PATH("test_cases", "one", "main.c")), "EXISTS:");
+	char* content = READ_FILE(path);
+	EXPECT(content != NULL AND STREQL(content, "#define A 2\n"));
+	free(content);
 
-	PAUSE
+	struct stat info;
+	EXPECT(chmod(path, 0750) == 0);
+	EXPECT(_writeFile(path, "#define A 3\n", 12) == 1);
+	EXPECT(stat(path, &info) == 0 AND (info.st_mode & 07777) == 0750);
 
-#ifdef _WIN32
-	TEST_VOID(CMD("gcc", "-o", PATH("examples", "test", "build", "main.out.exe"), PATH("examples", "test", "main.c")), "CMD:");
-	TEST_VOID(CMD(PATH("examples", "test", "build", "main.out.exe"), "hello", "?", "what's the time?"), "CMD:");
-#else
-	TEST_VOID(CMD("cc", "-o", PATH("examples", "test", "build", "main.out"), PATH("examples", "test", "main.c")), "CMD:");
-	TEST_VOID(CMD(PATH("examples", "test", "build", "main.out"), "hello", "?", "what's the time?"), "CMD:");
-#endif
+	RM(root);
+}
 
-	PAUSE
+static void _testForeach(void)
+{
+	const char* root = SCRATCH("foreach");
+	RM(root);
 
-	TEST_VOID(MKFILE(PATH("test_cases", "one", "note1.txt")), "MKFILE:");
-	TEST_VOID(MKFILE(PATH("test_cases", "one", "note2.txt")), "MKFILE:");
-	TEST_VOID(MKFILE(PATH("test_cases", "one", "note3.txt")), "MKFILE:");
-	TEST_VOID(MKFILE(PATH("test_cases", "one", "note4.txt")), "MKFILE:");
-	TEST_VOID(MKFILE(PATH("test_cases", "one", "note5.txt")), "MKFILE:");
+	MKDIR(root, "inner");
+	MKFILE(PATH(root, "note1.txt"));
+	MKFILE(PATH(root, "note2.txt"));
+	MKFILE(PATH(root, "note3.txt"));
+	MKFILE(PATH(root, "note4.txt"));
+	MKFILE(PATH(root, "note5.txt"));
 
-	PAUSE
+	unsigned long long files = 0;
+	unsigned long long directories = 0;
 
-	FOREACH_FILE_IN_DIRECTORY(file, PATH("test_cases", "one"),
+	FOREACH_FILE_IN_DIRECTORY(file, root,
 	{
 		IGNORE_DIRECTORY_IF_DOTS(file);
 
-		if (ISFILE(PATH("test_cases", "one", file)))
+		if (ISFILE(PATH(root, file)))
 		{
-			ECHO(stdout, CBUILD_INFO_LABEL" File: %s\n", file);
+			++files;
 		}
-		else if (ISDIR(PATH("test_cases", "one", file)))
+		else if (ISDIR(PATH(root, file)))
+		{
+			++directories;
+		}
+	});
+
+	EXPECT(files == 5);
+	EXPECT(directories == 1);
+
+	RM(root);
+}
+
+static void _testCmd(void)
+{
+	const char* root = SCRATCH("cmd");
+	RM(root);
+
+	WRITE_FILE(PATH(root, "main.c"),
+		"#include <stdio.h>\n",
+		"int main(int argc, char** argv) { for (int i = 1; i < argc; ++i) printf(\"%s\\n\", argv[i]); return 0; }\n");
+	CMD("cc", "-o", PATH(root, "main.out"), PATH(root, "main.c"));
+
+	const char* argv[] = { PATH(root, "main.out"), "hello", "?", "what's the time?", NULL };
+	struct _CBuild_Buffer output = { 0 };
+	EXPECT(CAPTURE(argv, &output) == 0);
+	EXPECT(STREQL(output.data, "hello\n?\nwhat's the time?\n"));
+
+	RM(root);
+}
+
+static void _testStrings(void)
+{
+	struct _CBuild_Strings strings = { 0 };
+	STRINGS_APPEND(&strings, "-O2", "-g");
+
+	for (int round = 0; round < 5; ++round)
+	{
+		STRINGS_EXTEND(&strings, &strings);
+	}
+
+	EXPECT(strings.count == 64 AND strings.items[64] == NULL);
+
+	for (unsigned long long index = 0; index < strings.count; ++index)
+	{
+		EXPECT(STREQL(strings.items[index], index % 2 == 0 ? "-O2" : "-g"));
+	}
+
+	_stringsSplice(&strings, 1, 62, strings.items + 62, 2);
+	EXPECT(strings.count == 4 AND STREQL(strings.items[1], "-O2") AND STREQL(strings.items[2], "-g") AND STREQL(strings.items[3], "-g"));
+	_stringsFree(&strings);
+}
+
+static void _testObjects(void)
+{
+	const char* root = SCRATCH("objects");
+	RM(root);
+	WRITE_FILE(PATH(root, "a", "util.c"), "int a(void) { return 1; }\n");
+	WRITE_FILE(PATH(root, "b", "util.c"), "int b(void) { return 2; }\n");
+	WRITE_FILE(PATH(root, "main.c"), "int a(void);\nint b(void);\nint main(void) { return a() + b(); }\n");
+
+	const char* sources[] = { PATH(root, "a", "util.c"), PATH(root, "b", "util.c"), PATH(root, "main.c"), NULL };
+	const char* flags[] = { NULL };
+	const char** objects = _objectsv("cc", PATH(root, "objects"), sources, flags);
+	EXPECT(NOT STREQL(objects[0], objects[1]));
+	EXPECT(STREQL(objects[2], PATH(root, "objects", "main.c.o")));
+	EXPECT(_linkv("cc", PATH(root, "main.out"), objects, flags) == 1);
+
+	const char* argv[] = { PATH(root, "main.out"), NULL };
+	struct _CBuild_Buffer output = { 0 };
+	EXPECT(CAPTURE(argv, &output) == 3);
+
+	RM(root);
+}
+
+static int _connectBuild(const char* const program, int argc, char** argv)
+{
+	(void)program;
+	const char* root = SCRATCH("connect");
+	const char* input = PATH(root, "input.txt");
+	const char* output = PATH(root, "output.txt");
+
+	if (argc > 0 AND STREQL(argv[argc - 1], "regenerate"))
+	{
+		CMD("sh", "-c", CONCAT("echo two > ", input));
+	}
+
+	const char* inputs[] = { input, NULL };
+	const char* command[] = { "cp", input, output, NULL };
+	const struct _CBuild_Action action = { output, NULL, inputs, command, CBUILD_ACTION_COMMAND };
+	RUN_ACTION(&action);
+
+	char* expected = READ_FILE(input);
+	char* content = READ_FILE(output);
+	return expected != NULL AND content != NULL AND STREQL(expected, content) ? 0 : 1;
+}
+
+static pid_t _server = 0;
+
+static void _serverStop(void)
+{
+	if (_server > 0)
+	{
+		kill(_server, SIGTERM);
+		waitpid(_server, NULL, 0);
+		_server = 0;
+	}
+}
+
+static void _testConnect(void)
+{
+	const char* root = SCRATCH("connect");
+	const char* socket = PATH(root, "server.sock");
+	RM(root);
+	WRITE_FILE(PATH(root, "input.txt"), "one\n");
+
+	const time_t now = time(NULL);
+	_setTime(PATH(root, "input.txt"), now - 7200);
+
+	fflush(stdout);
+	fflush(stderr);
+	_server = fork();
+
+	if (_server == 0)
+	{
+		_serve(socket, _program, __FILE__, _connectBuild);
+	}
+
+	atexit(_serverStop);
+
+	const char* first[] = { "--case", "connect", NULL };
+	const char* last[] = { "--case", "connect", "regenerate", NULL };
+	_cbuildArguments = first;
+	int status = -1;
+
+	for (int attempt = 0; attempt < 100 AND (status = _serverForward(socket)) < 0; ++attempt)
+	{
+		usleep(50 * 1000);
+	}
+
+	EXPECT(status == 0);
+	_setTime(PATH(root, "output.txt"), now - 3600);
+	EXPECT(_serverForward(socket) == 0);
+	_cbuildArguments = last;
+	EXPECT(_serverForward(socket) == 0);
+
+	char* content = READ_FILE(PATH(root, "output.txt"));
+	EXPECT(content != NULL AND STREQL(content, "two\n"));
+
+	RM(root);
+}
+
+static void _executorReject(const int fd, const char* const marker)
+{
+	while (1)
+	{
+		const int client = accept(fd, NULL, NULL);
+		struct _CBuild_Buffer line = { 0 };
+		unsigned long long count = 0;
+
+		while (_readLine(client, &line) == 0)
 		{
-			ECHO(stdout, CBUILD_INFO_LABEL" Directory: %s\n", file);
+			if (sscanf(line.data, "MISSING %llu", &count) == 1)
+			{
+				for (unsigned long long index = 0; index < count; ++index)
+				{
+					_readLine(client, &line);
+				}
+
+				_writeAll(client, "MISSING 0\n", 10);
+			}
+			else if (sscanf(line.data, "RUN %llu", &count) == 1)
+			{
+				char* description = (char*)malloc(count);
+				_readAll(client, description, count);
+				free(description);
+				WRITE_FILE(marker, "");
+				_writeAll(client, "RESULT -1 0 0 0\n", 16);
+			}
 		}
+
+		BUFFER_FREE(&line);
+		close(client);
+	}
+}
+
+static void _testExecutor(void)
+{
+	const char* root = SCRATCH("executor");
+	const char* socket = PATH(root, "executor.sock");
+	const char* input = PATH(root, "input.txt");
+	const char* output = PATH(root, "output.txt");
+	const char* escape = PATH(CBUILD_CACHE_DIRECTORY, "escape.txt");
+	const char* absolute = PATH(getcwd(NULL, 0), root, "absolute.txt");
+	RM(root);
+	RM(escape);
+	WRITE_FILE(input, "one\n");
+
+	fflush(stdout);
+	fflush(stderr);
+	_server = fork();
+
+	if (_server == 0)
+	{
+		_executorServe(socket);
+	}
+
+	atexit(_serverStop);
+
+	const char* inputs[] = { input, NULL };
+	const char* copy[] = { "cp", input, output, NULL };
+	const char* outputs[] = { output, NULL };
+	const struct _CBuild_Hermetic action = { inputs, copy, NULL, outputs };
+	_cbuildExecutor = socket;
+
+	for (int attempt = 0; attempt < 100 AND NOT EXISTS(socket); ++attempt)
+	{
+		usleep(50 * 1000);
+	}
+
+	EXPECT(RUN_HERMETIC(&action) == 1);
+	EXPECT(STREQL(READ_FILE(output), "one\n"));
+
+	char digest[65];
+	_sha256Data("one\n", 4, digest);
+	EXPECT(ISFILE(PATH(CBUILD_EXECUTOR_DIRECTORY, "store", digest)));
+
+	const char* leaving[] = { "sh", "-c", CONCAT("echo two > ", root, "/../../escape.txt"), NULL };
+	const char* relative[] = { PATH(root, "..", "..", "escape.txt"), NULL };
+	const char* rooted[] = { absolute, NULL };
+	const char** rejected[] = { relative, rooted };
+
+	for (unsigned long long index = 0; index < 2; ++index)
+	{
+		const struct _CBuild_Hermetic unsafe = { inputs, leaving, NULL, rejected[index] };
+		struct _CBuild_Buffer description = { 0 };
+		EXPECT(_hermeticDescribe(&unsafe, &description) == 0);
+		EXPECT(_hermeticRemote(&description) == -1);
+		EXPECT(NOT EXISTS(rejected[index][0]));
+		EXPECT(NOT EXISTS(escape));
+	}
+
+	_serverStop();
+	const int fd = _unixListen(socket);
+	EXPECT(fd >= 0);
+	_server = fork();
+
+	if (_server == 0)
+	{
+		_executorReject(fd, PATH(root, "rejected"));
+	}
+
+	close(fd);
+
+	RM(output);
+	WRITE_FILE(input, "two\n");
+	EXPECT(RUN_HERMETIC(&action) == 1);
+	EXPECT(STREQL(READ_FILE(output), "two\n"));
+	EXPECT(ISFILE(PATH(root, "rejected")));
+
+	RM(root);
+}
+
+static int _storeBuild(const char* const directory)
+{
+	const char* inputs[] = { "input.txt", NULL };
+	const char* copy[] = { "cp", "input.txt", "output.txt", NULL };
+	const char* env[] = { "PATH=/usr/bin:/bin", NULL };
+	const char* outputs[] = { "output.txt", NULL };
+	const struct _CBuild_Hermetic action = { inputs, copy, env, outputs };
+	char* previous = getcwd(NULL, 0);
+
+	MKDIR(directory);
+	EXPECT(chdir(directory) == 0);
+	STAT_FORGET_ALL();
+	ENSURE_DIR_FORGET();
+	WRITE_FILE("input.txt", "one\n");
+	const int result = RUN_HERMETIC(&action);
+	char* content = READ_FILE("output.txt");
+	EXPECT(content != NULL AND STREQL(content, "one\n"));
+
+	EXPECT(chdir(previous) == 0);
+	STAT_FORGET_ALL();
+	ENSURE_DIR_FORGET();
+	free(previous);
+	return result;
+}
+
+static void _testStore(void)
+{
+	const char* root = SCRATCH("store");
+	char* cwd = getcwd(NULL, 0);
+	RM(root);
+	_cbuildStore = PATH(cwd, root, "store");
+
+	EXPECT(_storeBuild(PATH(root, "one")) == 1);
+	EXPECT(_storeBuild(PATH(root, "two")) == 0);
+
+	char digest[65];
+	_sha256Data("one\n", 4, digest);
+	const char* blob = _storePath("objects", digest);
+	EXPECT(ISFILE(blob));
+	EXPECT(chmod(blob, 0644) == 0);
+	WRITE_FILE(blob, "forged\n");
+	STAT_FORGET(blob);
+
+	EXPECT(_storeBuild(PATH(root, "three")) == 1);
+	char* content = READ_FILE(blob);
+	EXPECT(content != NULL AND STREQL(content, "one\n"));
+
+	FOREACH_FILE_IN_DIRECTORY(name, PATH(root, "three"),
+	{
+		EXPECT(strncmp(name, "output.txt.tmp.", 15) != 0);
 	});
 
-	PAUSE
+	const time_t now = time(NULL);
+	_setTime(blob, now - CBUILD_STORE_MAX_AGE - 3600);
+	STORE_GC();
+	STAT_FORGET(blob);
+	EXPECT(NOT EXISTS(blob));
+	EXPECT(EXISTS(PATH(root, "store", "results")));
+	EXPECT(_storeBuild(PATH(root, "four")) == 1);
+	EXPECT(ISFILE(blob));
+
+	_cbuildStore = NULL;
+	RM(root);
+}
+
+static int _exitStatus(const pid_t child)
+{
+	int status = 0;
+	EXPECT(waitpid(child, &status, 0) == child AND WIFEXITED(status));
+	return WEXITSTATUS(status);
+}
+
+static int _alive(const pid_t pid)
+{
+	char path[64];
+	sprintf(path, "/proc/%d/stat", (int)pid);
+	char* content = READ_FILE(path);
+	const char* state = content != NULL ? strrchr(content, ')') : NULL;
+	return state != NULL AND state[1] == ' ' AND state[2] != 'Z';
+}
+
+static pid_t _actionsStart(const char* const root, const unsigned long long keepGoing, const char* const* failing, const char* const* slow, const char* const* dependent)
+{
+	fflush(stdout);
+	fflush(stderr);
+	const pid_t child = fork();
+
+	if (child == 0)
+	{
+		const char* fail[] = { PATH(root, "fail.txt"), NULL };
+		const struct _CBuild_Action first = { fail[0], NULL, NULL, failing, CBUILD_ACTION_COMMAND };
+		const struct _CBuild_Action second = { PATH(root, "slow.txt"), NULL, NULL, slow, CBUILD_ACTION_COMMAND };
+		const struct _CBuild_Action third = { PATH(root, "dependent.txt"), NULL, fail, dependent, CBUILD_ACTION_COMMAND };
+		_cbuildJobs = 4;
+		_cbuildKeepGoing = keepGoing;
+
+		if (failing != NULL)
+		{
+			SUBMIT_ACTION(&first);
+		}
+
+		SUBMIT_ACTION(&second);
+
+		if (dependent != NULL)
+		{
+			SUBMIT_ACTION(&third);
+		}
+
+		WAIT_ACTIONS();
+		exit(0);
+	}
+
+	return child;
+}
+
+static void _testActions(void)
+{
+	const char* root = SCRATCH("actions");
+	const char* fail = PATH(root, "fail.txt");
+	const char* slow = PATH(root, "slow.txt");
+	const char* dependent = PATH(root, "dependent.txt");
+	const char* pidPath = PATH(root, "pid");
+	RM(root);
+	MKDIR(root);
+
+	const char* failing[] = { "sh", "-c", CONCAT("echo partial > ", fail, "; exit 1"), NULL };
+	const char* quick[] = { "touch", slow, NULL };
+	const char* copy[] = { "cp", fail, dependent, NULL };
+	EXPECT(_exitStatus(_actionsStart(root, 0, failing, quick, copy)) == 1);
+	EXPECT(NOT EXISTS(fail));
+	EXPECT(EXISTS(slow));
+	EXPECT(NOT EXISTS(dependent));
+	RM(slow);
+
+	const char* delayed[] = { "sh", "-c", CONCAT("sleep 0.2; echo partial > ", fail, "; exit 1"), NULL };
+	const char* sleeping[] = { "sh", "-c", CONCAT("echo partial > ", slow, "; sleep 30 & echo $! > ", pidPath, "; wait"), NULL };
+	const long long started = _now();
+	EXPECT(_exitStatus(_actionsStart(root, 1, delayed, sleeping, NULL)) == 1);
+	EXPECT(_now() - started < 20 * 1000000000LL);
+	EXPECT(NOT EXISTS(fail));
+	EXPECT(NOT EXISTS(slow));
+	char* content = READ_FILE(pidPath);
+	EXPECT(content != NULL AND NOT _alive((pid_t)atoi(content)));
+	RM(pidPath);
+
+	const pid_t child = _actionsStart(root, 1, NULL, sleeping, NULL);
+
+	for (int attempt = 0; attempt < 200 AND NOT ISFILE(pidPath); ++attempt)
+	{
+		usleep(50 * 1000);
+		STAT_FORGET(pidPath);
+	}
+
+	usleep(100 * 1000);
+	content = READ_FILE(pidPath);
+	EXPECT(content != NULL);
+	EXPECT(kill(child, SIGINT) == 0);
+	EXPECT(_exitStatus(child) == 128 + SIGINT);
+	STAT_FORGET(slow);
+	EXPECT(NOT EXISTS(slow));
+	EXPECT(NOT EXISTS(CONCAT(slow, CBUILD_STAMP_EXTENSION)));
+	EXPECT(NOT _alive((pid_t)atoi(content)));
+
+	RM(root);
+}
+
+static pid_t _exitOwner = 0;
+static const char* _exitMarker = NULL;
+
+static void _exitMark(void)
+{
+	if (getpid() != _exitOwner)
+	{
+		WRITE_FILE(_exitMarker, "");
+	}
+}
+
+static void _testRebuild(void)
+{
+	const char* root = SCRATCH("rebuild");
+	const char* source = PATH(root, "tool.c");
+	const char* binary = PATH(root, "tool");
+	const char* old = PATH(root, "tool.old");
+	RM(root);
+	WRITE_FILE(source, "int main(void) { return }\n");
+	WRITE_FILE(binary, "working\n");
+
+	const time_t now = time(NULL);
+	_setTime(binary, now - 3600);
+
+	fflush(stdout);
+	fflush(stderr);
+	pid_t child = fork();
+
+	if (child == 0)
+	{
+		_rebuildMyself(source, binary);
+		exit(0);
+	}
+
+	EXPECT(_exitStatus(child) == 1);
+	char* content = READ_FILE(binary);
+	EXPECT(content != NULL AND STREQL(content, "working\n"));
+	EXPECT(NOT EXISTS(old));
+
+	fflush(stdout);
+	fflush(stderr);
+	child = fork();
+
+	if (child == 0)
+	{
+		_exitOwner = getpid();
+		_exitMarker = PATH(root, "marker");
+		atexit(_exitMark);
+		MV(binary, old);
+		WRITE_FILE(binary, "partial\n");
+		_cbuildRebuilding = binary;
+		_cbuildRebuildingOwner = getpid();
+		atexit(_rebuildRestore);
+
+		const char* missing[] = { "cbuild-missing-program", NULL };
+		EXPECT(_exitStatus(_spawn(missing)) == 127);
+		EXPECT(NOT EXISTS(_exitMarker));
+
+		fflush(stdout);
+		fflush(stderr);
+		const pid_t helper = fork();
+
+		if (helper == 0)
+		{
+			_exitOwner = getpid();
+			exit(0);
+		}
+
+		EXPECT(_exitStatus(helper) == 0);
+		content = READ_FILE(binary);
+		EXPECT(content != NULL AND STREQL(content, "partial\n"));
+		EXPECT(ISFILE(old));
+		exit(1);
+	}
+
+	EXPECT(_exitStatus(child) == 1);
+	content = READ_FILE(binary);
+	EXPECT(content != NULL AND STREQL(content, "working\n"));
+	EXPECT(NOT EXISTS(old));
+
+	RM(root);
+}
+
+static int _configureCalls = 0;
+
+static void _configureBuild(void* context)
+{
+	const int effect = *(const int*)context;
+	const char* root = SCRATCH("configure");
+	const char* input = PATH(root, "input.txt");
+	const char* output = ISFILE(PATH(root, "flag")) ? PATH(root, "flagged.txt") : PATH(root, "output.txt");
+	++_configureCalls;
+
+	if (effect == 1)
+	{
+		CMD("touch", PATH(root, "touched.txt"));
+	}
+	else if (effect == 2)
+	{
+		COPY(input, PATH(root, "copied.txt"));
+	}
+
+	const char* inputs[] = { input, NULL };
+	const char* copy[] = { "cp", input, output, NULL };
+	const struct _CBuild_Action action = { output, NULL, inputs, copy, CBUILD_ACTION_COMMAND };
+	SUBMIT_ACTION(&action);
+}
+
+static void _testConfigure(void)
+{
+	const char* root = SCRATCH("configure");
+	int effect = 0;
+	RM(root);
+	RM(CBUILD_CONFIGURE_DIRECTORY);
+	WRITE_FILE(PATH(root, "input.txt"), "one\n");
+
+	EXPECT(CONFIGURE(_program, _configureBuild, &effect) == 0);
+	EXPECT(_configureCalls == 1);
+	EXPECT(ISFILE(PATH(root, "output.txt")));
+	RM(PATH(root, "output.txt"));
+	EXPECT(CONFIGURE(_program, _configureBuild, &effect) == 1);
+	EXPECT(_configureCalls == 1);
+	EXPECT(ISFILE(PATH(root, "output.txt")));
+
+	WRITE_FILE(PATH(root, "flag"), "");
+	EXPECT(CONFIGURE(_program, _configureBuild, &effect) == 0);
+	EXPECT(_configureCalls == 2);
+	EXPECT(ISFILE(PATH(root, "flagged.txt")));
+	EXPECT(CONFIGURE(_program, _configureBuild, &effect) == 1);
+	EXPECT(_configureCalls == 2);
+	RM(PATH(root, "flag"));
+
+	for (effect = 1; effect <= 2; ++effect)
+	{
+		const int calls = _configureCalls;
+		EXPECT(CONFIGURE(_program, _configureBuild, &effect) == 0);
+		RM(PATH(root, "touched.txt"));
+		RM(PATH(root, "copied.txt"));
+		EXPECT(CONFIGURE(_program, _configureBuild, &effect) == 0);
+		EXPECT(_configureCalls == calls + 2);
+		EXPECT(ISFILE(PATH(root, effect == 1 ? "touched.txt" : "copied.txt")));
+	}
+
+	RM(root);
+}
+
+static int _pinnedCpu(const char* const path)
+{
+	char* content = READ_FILE(path);
+	const char* list = content != NULL ? strstr(content, "Cpus_allowed_list:") : NULL;
+	EXPECT(list != NULL);
+	list += strlen("Cpus_allowed_list:");
+	const int cpu = atoi(list);
+	const char* end = strchr(list, '\n');
+	EXPECT(end != NULL AND memchr(list, ',', end - list) == NULL AND memchr(list, '-', end - list) == NULL);
+	return cpu;
+}
+
+static void _testPin(void)
+{
+	const char* root = SCRATCH("pin");
+	const char* cgroup = getenv("CBUILD_TEST_CGROUP");
+	cpu_set_t allowed;
+	RM(root);
+	MKDIR(root);
+	EXPECT(sched_getaffinity(0, sizeof(allowed), &allowed) == 0);
+
+	_cbuildPin = 1;
+	_cbuildJobs = 2;
+	_cbuildCgroup = cgroup;
+
+	if (cgroup == NULL)
+	{
+		ECHO(stdout, " -- "CBUILD_INFO_LABEL" Skipping cgroup placement, CBUILD_TEST_CGROUP does not name a delegated cgroup.\n");
+	}
+
+	const char* outputs[] = { PATH(root, "first.txt"), PATH(root, "second.txt") };
+
+	for (unsigned long long index = 0; index < 2; ++index)
+	{
+		const char** argv = (const char**)calloc(4, sizeof(const char*));
+		argv[0] = "sh";
+		argv[1] = "-c";
+		argv[2] = CONCAT("sleep 0.3; grep Cpus_allowed_list /proc/self/status > ", outputs[index], "; cat /proc/self/cgroup >> ", outputs[index]);
+		const struct _CBuild_Action action = { outputs[index], NULL, NULL, argv, CBUILD_ACTION_COMMAND };
+		SUBMIT_ACTION(&action);
+	}
+
+	WAIT_ACTIONS();
+	const int first = _pinnedCpu(outputs[0]);
+	const int second = _pinnedCpu(outputs[1]);
+	EXPECT(CPU_ISSET(first, &allowed) AND CPU_ISSET(second, &allowed));
+	EXPECT(CPU_COUNT(&allowed) < 2 OR first != second);
+
+	if (cgroup != NULL)
+	{
+		EXPECT(strstr(READ_FILE(outputs[0]), "/slot") != NULL);
+		EXPECT(strstr(READ_FILE(outputs[1]), "/slot") != NULL);
+	}
+
+	_cbuildPin = 0;
+	_cbuildCgroup = NULL;
+	RM(root);
+}
+
+static void _progressBuild(const char* const root, const int terminal)
+{
+	EXPECT(chdir(root) == 0);
+	_cbuildJobs = 2;
+	_cbuildProgress = 1;
+
+	if (terminal)
+	{
+		const int slave = open(ptsname(terminal), O_RDWR);
+		EXPECT(slave >= 0);
+		dup2(slave, STDOUT_FILENO);
+		dup2(slave, STDERR_FILENO);
+		close(slave);
+		setenv("TERM", "xterm", 1);
+	}
+
+	const char* alpha[] = { "sh", "-c", "printf 'alpha one\\n'; sleep 0.3; printf 'alpha two\\n'; touch alpha.txt", NULL };
+	const char* beta[] = { "sh", "-c", "sleep 0.1; printf 'beta one\\n'; sleep 0.3; printf 'beta two\\n'; touch beta.txt", NULL };
+	const struct _CBuild_Action first = { "alpha.txt", NULL, NULL, alpha, CBUILD_ACTION_COMMAND };
+	const struct _CBuild_Action second = { "beta.txt", NULL, NULL, beta, CBUILD_ACTION_COMMAND };
+	SUBMIT_ACTION(&first);
+	SUBMIT_ACTION(&second);
+
+	if (NOT terminal)
+	{
+		EXPECT(_progressExpected("alpha.txt") == 7000 * 1000000LL);
+	}
+
+	WAIT_ACTIONS();
+	exit(0);
+}
+
+static void _testProgress(void)
+{
+	const char* root = SCRATCH("progress");
+	const char* durations = PATH(root, CBUILD_DURATIONS_PATH);
+	RM(root);
+	MKDIR(root);
+	WRITE_FILE(durations, "7000 alpha.txt\n");
+
+	fflush(stdout);
+	fflush(stderr);
+	pid_t child = fork();
+
+	if (child == 0)
+	{
+		_progressBuild(root, 0);
+	}
+
+	EXPECT(_exitStatus(child) == 0);
+	char* content = READ_FILE(durations);
+	EXPECT(content != NULL);
+	struct _CBuild_Map recorded = { 0 };
+	unsigned long long alpha = 0;
+	unsigned long long beta = 0;
+	_durationsLoad(durations, &recorded);
+	EXPECT(_mapGet(&recorded, "alpha.txt", &alpha) AND alpha - 1 >= 250 AND alpha - 1 < 7000);
+	EXPECT(_mapGet(&recorded, "beta.txt", &beta) AND beta - 1 >= 350);
+
+	RM(PATH(root, "alpha.txt"));
+	RM(PATH(root, "beta.txt"));
+	const int terminal = posix_openpt(O_RDWR | O_NOCTTY);
+	EXPECT(terminal >= 0 AND grantpt(terminal) == 0 AND unlockpt(terminal) == 0);
+	fflush(stdout);
+	fflush(stderr);
+	child = fork();
+
+	if (child == 0)
+	{
+		_progressBuild(root, terminal);
+	}
+
+	struct _CBuild_Buffer output = { 0 };
+	char chunk[4096];
+	ssize_t length = 0;
+
+	while ((length = read(terminal, chunk, sizeof(chunk))) > 0 OR (length < 0 AND errno == EINTR))
+	{
+		_bufferAppend(&output, chunk, length > 0 ? length : 0);
+	}
+
+	EXPECT(_exitStatus(child) == 0);
+	_bufferReserve(&output, 1);
+	output.data[output.length] = '\0';
+	EXPECT(strstr(output.data, "running") != NULL);
+	EXPECT(strstr(output.data, "alpha one\r\nalpha two\r\n") != NULL);
+	EXPECT(strstr(output.data, "beta one\r\nbeta two\r\n") != NULL);
+
+	close(terminal);
+	BUFFER_FREE(&output);
+	RM(root);
+}
+
+static void _testDepfile(void)
+{
+	const char** inputs = _depfileParse(
+		"build/main.o: src/main.c include/a\\ b.h \\\n"
+		"  include/c$$.h \\\r\n"
+		"  include/d.h\n"
+		"include/a\\ b.h:\n");
+
+	EXPECT(inputs[0] != NULL AND STREQL(inputs[0], "src/main.c"));
+	EXPECT(inputs[1] != NULL AND STREQL(inputs[1], "include/a b.h"));
+	EXPECT(inputs[2] != NULL AND STREQL(inputs[2], "include/c$.h"));
+	EXPECT(inputs[3] != NULL AND STREQL(inputs[3], "include/d.h"));
+	EXPECT(inputs[4] == NULL);
+
+	inputs = _depfileParse("C:/build/main.o: C:/src/main.c\n");
+	EXPECT(inputs[0] != NULL AND STREQL(inputs[0], "C:/src/main.c"));
+	EXPECT(inputs[1] == NULL);
+}
+
+static void _testStale(void)
+{
+	const char* root = SCRATCH("stale");
+	const char* input = PATH(root, "input.txt");
+	const char* header = PATH(root, "header.h");
+	const char* output = PATH(root, "output.txt");
+	const char* depfile = PATH(root, "output.d");
+	RM(root);
+	WRITE_FILE(input, "one\n");
+	WRITE_FILE(header, "");
+
+	const time_t now = time(NULL);
+	_setTime(input, now - 7200);
+	_setTime(header, now - 7200);
+
+	const char* inputs[] = { input, NULL };
+	const char* copy[] = { "cp", input, output, NULL };
+	struct _CBuild_Action action = { output, NULL, inputs, copy, CBUILD_ACTION_COMMAND };
+	EXPECT(strstr(_actionStale(&action), "does not exist") != NULL);
+	EXPECT(RUN_ACTION(&action) == 1);
+	EXPECT(_actionStale(&action) == NULL);
+	EXPECT(RUN_ACTION(&action) == 0);
+
+	const char* changed[] = { "cp", "--", input, output, NULL };
+	action.argv = changed;
+	EXPECT(strstr(_actionStale(&action), "changed") != NULL);
+	EXPECT(RUN_ACTION(&action) == 1);
+
+	_setTime(output, now - 3600);
+	_setTime(input, now - 1800);
+	EXPECT(strstr(_actionStale(&action), "is newer") != NULL);
+	EXPECT(RUN_ACTION(&action) == 1);
+
+	action.kind = CBUILD_ACTION_LINK;
+	_setTime(output, now - 3600);
+	EXPECT(RUN_ACTION(&action) == 1);
+	_setTime(output, now - 3600);
+	_setTime(input, now - 1800);
+	EXPECT(_actionStale(&action) == NULL);
+
+	struct stat info;
+	char recorded[64];
+	sprintf(recorded, " %lld ", (long long)(now - 1800) * 1000000000LL);
+	EXPECT(stat(output, &info) == 0 AND info.st_mtime == now - 3600);
+	EXPECT(strstr(READ_FILE(CONCAT(output, CBUILD_STAMP_EXTENSION)), recorded) != NULL);
+
+	WRITE_FILE(input, "two\n");
+	_setTime(input, now - 1200);
+	EXPECT(strstr(_actionStale(&action), "is newer") != NULL);
+
+	const char* compile[] = { "sh", "-c", CONCAT("cp ", input, " ", output, " && echo '", output, ": ", input, " ", header, "' > ", depfile), NULL };
+	action.argv = compile;
+	action.depfile = depfile;
+	action.kind = CBUILD_ACTION_COMMAND;
+	EXPECT(RUN_ACTION(&action) == 1);
+	EXPECT(_actionStale(&action) == NULL);
+	RM(depfile);
+	EXPECT(strstr(_actionStale(&action), "depfile") != NULL);
+	EXPECT(RUN_ACTION(&action) == 1);
+
+	_setTime(output, now - 3600);
+	_setTime(input, now - 7200);
+	_setTime(header, now - 1800);
+	EXPECT(strstr(_actionStale(&action), header) != NULL);
+
+	RM(root);
+}
+
+static void _testPrefetch(void)
+{
+	const char* root = SCRATCH("prefetch");
+	const char* side = PATH(root, "side.h");
+	const char* first = PATH(root, "first.txt");
+	const char* second = PATH(root, "second.txt");
+	RM(root);
+	WRITE_FILE(side, "old\n");
+	WRITE_FILE(PATH(root, "a.txt"), "");
+	WRITE_FILE(PATH(root, "b.txt"), "");
+
+	const char* secondInputs[] = { side, NULL };
+	const char* secondArgv[] = { "cp", side, second, NULL };
+	const struct _CBuild_Action secondAction = { second, NULL, secondInputs, secondArgv, CBUILD_ACTION_COMMAND };
+	EXPECT(RUN_ACTION(&secondAction) == 1);
+
+	const time_t now = time(NULL);
+	_setTime(side, now - 7200);
+	_setTime(second, now - 3600);
+
+	const char* firstInputs[] = { PATH(root, "a.txt"), PATH(root, "b.txt"), side, NULL };
+	const char* firstArgv[] = { "sh", "-c", CONCAT("echo new > ", side, " && touch ", first), NULL };
+	const struct _CBuild_Action firstAction = { first, NULL, firstInputs, firstArgv, CBUILD_ACTION_COMMAND };
+	EXPECT(RUN_ACTION(&firstAction) == 1);
+	EXPECT(RUN_ACTION(&secondAction) == 1);
+
+	char* content = READ_FILE(second);
+	EXPECT(content != NULL AND STREQL(content, "new\n"));
+
+	RM(root);
+}
+
+static void _testReadBatch(void)
+{
+	const char* root = SCRATCH("read-batch");
+	RM(root);
+	WRITE_FILE(PATH(root, "one.txt"), "one\n");
+	WRITE_FILE(PATH(root, "two.txt"), "two\n");
+	MKDIR(root, "directory");
+
+	const char* paths[] = { PATH(root, "one.txt"), PATH(root, "directory"), PATH(root, "missing.txt"), PATH(root, "two.txt") };
+	char* contents[4];
+	unsigned long long lengths[4];
+	_readBatch(paths, 4, contents, lengths);
+
+	EXPECT(contents[0] != NULL AND lengths[0] == 4 AND STREQL(contents[0], "one\n"));
+	EXPECT(contents[1] == NULL);
+	EXPECT(contents[2] == NULL);
+	EXPECT(contents[3] != NULL AND lengths[3] == 4 AND STREQL(contents[3], "two\n"));
+
+	RM(root);
 }
 
-int main()
+static void _testShard(void)
 {
-	tests();
-	return 0;
+	const char* names[] = { "g", "c", "e", "a", "f", "b", "d" };
+	struct _CBuild_Test* selected[8];
+
+	for (unsigned long long index = 0; index < 7; ++index)
+	{
+		ADD_TEST(names[index], "true");
+	}
+
+	_cbuildShards = 3;
+
+	for (_cbuildShard = 1; _cbuildShard <= 3; ++_cbuildShard)
+	{
+		const unsigned long long count = _testsShard(selected);
+		EXPECT(count == (_cbuildShard == 1 ? 3 : 2));
+
+		for (unsigned long long index = 0; index < count; ++index)
+		{
+			EXPECT(selected[index]->name[0] == "abcdefg"[_cbuildShard - 1 + 3 * index]);
+		}
+	}
+
+	fflush(stdout);
+	fflush(stderr);
+	const pid_t child = fork();
+
+	if (child == 0)
+	{
+		ADD_TEST("a b", "true");
+		ADD_TEST("a_b", "true");
+		exit(0);
+	}
+
+	int status = 0;
+	EXPECT(waitpid(child, &status, 0) == child AND WIFEXITED(status) AND WEXITSTATUS(status) == 1);
+}
+
+static const struct
+{
+	const char* name;
+	void (*run)(void);
+} _cases[] = {
+	{ "predicates", _testPredicates },
+	{ "make", _testMake },
+	{ "write-file", _testWriteFile },
+	{ "foreach", _testForeach },
+	{ "cmd", _testCmd },
+	{ "strings", _testStrings },
+	{ "objects", _testObjects },
+	{ "connect", _testConnect },
+	{ "executor", _testExecutor },
+	{ "store", _testStore },
+	{ "actions", _testActions },
+	{ "rebuild", _testRebuild },
+	{ "configure", _testConfigure },
+	{ "pin", _testPin },
+	{ "progress", _testProgress },
+	{ "depfile", _testDepfile },
+	{ "stale", _testStale },
+	{ "prefetch", _testPrefetch },
+	{ "read-batch", _testReadBatch },
+	{ "shard", _testShard },
+};
+
+int main(int argc, char** argv)
+{
+	const char* program = _shift(&argc, &argv);
+	OPTIONS(argc, argv);
+	_program = program;
+
+	FOREACH_ARG_IN_CMD_ARGS(flag, argc, argv,
+	{
+		if (STREQL(flag, "--help") OR STREQL(flag, "-h"))
+		{
+			_usage(stdout, program);
+			exit(0);
+		}
+		else if (STREQL(flag, "--case"))
+		{
+			const char* name = _shift(&argc, &argv);
+
+			for (unsigned long long index = 0; index < sizeof(_cases) / sizeof(_cases[0]); ++index)
+			{
+				if (STREQL(_cases[index].name, name))
+				{
+					_cases[index].run();
+					exit(0);
+				}
+			}
+
+			_usage(stderr, program);
+			exit(1);
+		}
+		else
+		{
+			_usage(stderr, program);
+			exit(1);
+		}
+	});
+
+	for (unsigned long long index = 0; index < sizeof(_cases) / sizeof(_cases[0]); ++index)
+	{
+		ADD_TEST(_cases[index].name, program, "--case", _cases[index].name);
+	}
+
+	return RUN_TESTS() > 0 ? 1 : 0;
 }